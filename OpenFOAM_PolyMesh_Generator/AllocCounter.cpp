@@ -0,0 +1,63 @@
+// 分配计数：替换全局 operator new / delete，把分配的字节数交给 Profiler（recordAllocation）。
+// 只链接进可执行文件（生成器与基准测试），不进 polymeshgen 库：嵌入库的程序保留自己的分配器，
+// 也能照常用 sanitizer。替换全部重载（普通 / 数组、nothrow、对齐），分配都经 malloc 系列，
+// 释放统一用 free，不会与未替换的重载配错对。
+
+#include "Profiler.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+
+void* allocate(std::size_t size, std::size_t alignment) noexcept
+{
+    recordAllocation(size);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t))
+    {
+        return std::malloc(size);
+    }
+    void* p = nullptr;
+    return posix_memalign(&p, alignment, size) == 0 ? p : nullptr;
+}
+
+void* allocateOrThrow(std::size_t size, std::size_t alignment)
+{
+    if (void* p = allocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+} // namespace
+
+void* operator new  (std::size_t size) { return allocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return allocateOrThrow(size, 0); }
+void* operator new  (std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return allocate(size, 0); }
+
+void* operator new  (std::size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return allocateOrThrow(size, static_cast<std::size_t>(al)); }
+void* operator new  (std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return allocate(size, static_cast<std::size_t>(al));
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept
+{
+    return allocate(size, static_cast<std::size_t>(al));
+}
+
+void operator delete  (void* p) noexcept                        { std::free(p); }
+void operator delete[](void* p) noexcept                        { std::free(p); }
+void operator delete  (void* p, std::size_t) noexcept           { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept           { std::free(p); }
+void operator delete  (void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+
+void operator delete  (void* p, std::align_val_t) noexcept                        { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept                        { std::free(p); }
+void operator delete  (void* p, std::size_t, std::align_val_t) noexcept           { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept           { std::free(p); }
+void operator delete  (void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
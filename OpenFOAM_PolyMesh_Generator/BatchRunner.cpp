@@ -0,0 +1,312 @@
+#include "BatchRunner.h"
+
+#include "Connectivity.h"
+#include "FieldWriter.h"
+#include "InitialFields.h"
+#include "MeshCache.h"
+#include "MeshChecker.h"
+#include "MeshCleaner.h"
+#include "Parallel.h"
+#include "PolyMeshReader.h"
+#include "PolyMeshWriter.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+#include "StructuredMeshGenerator.h"
+#include "TaskPool.h"
+#include "VTKWriter.h"
+#include "VolumeFraction.h"
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <tuple>
+
+namespace
+{
+
+using BackgroundKey = std::tuple<std::string, int, int, int, double, double, double>;
+
+BackgroundKey backgroundKey(const MeshCase& c)
+{
+    if (!c.background.empty())
+    {
+        return BackgroundKey(c.background, 0, 0, 0, 0.0, 0.0, 0.0);
+    }
+    return BackgroundKey("", c.Nx, c.Ny, c.Nz, c.Lx, c.Ly, c.Lz);
+}
+
+// 读入的背景网格以各文件的大小与修改时间作为内容标识
+std::uint64_t backgroundFilesKey(const std::string& dir)
+{
+    HashBuilder h;
+    h.add(dir);
+    for (const std::string& f : polyMeshFiles(dir))
+    {
+        std::error_code ec;
+        const auto size  = std::filesystem::file_size(f, ec);
+        const auto mtime = std::filesystem::last_write_time(f, ec);
+        h.add(static_cast<std::uint64_t>(ec ? 0 : size))
+         .add(static_cast<std::uint64_t>(mtime.time_since_epoch().count()));
+    }
+    return h.value();
+}
+
+// 同一背景网格的共享槽：第一个用到的 case 负责生成，最后一个用完后释放
+struct BackgroundSlot
+{
+    std::once_flag                  once;
+    std::shared_ptr<const MeshData> mesh;
+    std::atomic<int>                remaining{0};
+};
+
+} // namespace
+
+int runBatch(const std::vector<MeshCase>& cases, const BatchOptions& opts)
+{
+    ScopedStage stage("batch");
+
+    std::map<BackgroundKey, std::unique_ptr<BackgroundSlot>> slots;
+    for (const auto& c : cases)
+    {
+        auto& slot = slots[backgroundKey(c)];
+        if (!slot) slot = std::make_unique<BackgroundSlot>();
+        ++slot->remaining;
+    }
+
+    // 同背景的 case 相邻提交，减少同时存活的背景网格数量
+    std::vector<std::size_t> order(cases.size());
+    for (std::size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b)
+    {
+        return backgroundKey(cases[a]) < backgroundKey(cases[b]);
+    });
+
+    const unsigned nJobs = std::max<unsigned>(1, std::min<unsigned>(
+        opts.nJobs ? opts.nJobs : parallelThreadCount(), static_cast<unsigned>(cases.size())));
+
+    TaskPool pool(nJobs);
+    std::vector<MaskWorkspace> workspaces(pool.size());
+    std::atomic<int> nFailed{0};
+    std::mutex logMutex;
+
+    std::cout << "batch: " << cases.size() << " case(s), " << slots.size()
+              << " background grid(s), " << pool.size() << " worker(s)\n";
+
+    std::unique_ptr<MeshCache> cache;
+    if (!opts.cacheDir.empty())
+    {
+        cache = std::make_unique<MeshCache>(opts.cacheDir);
+    }
+
+    for (std::size_t idx : order)
+    {
+        pool.submit([&, idx](unsigned w)
+        {
+            const MeshCase& c = cases[idx];
+            BackgroundSlot& slot = *slots.at(backgroundKey(c));
+            MaskWorkspace& ws = workspaces[w];
+            threadScratch().reset();   // 上一个 case 的临时缓冲区整体作废
+
+            // 每个 case 恰好释放一次对背景网格的占用
+            bool released = false;
+            auto release = [&]()
+            {
+                if (released) return;
+                released = true;
+                if (--slot.remaining == 0)
+                {
+                    slot.mesh.reset();
+                }
+            };
+
+            // 各阶段输入的哈希：网格 -> 掩模 -> 拓扑（含 patch 规则）-> 写出
+            const std::uint64_t gridKey = c.background.empty()
+                ? HashBuilder().add(std::string("grid"))
+                      .add(c.Nx).add(c.Ny).add(c.Nz).add(c.Lx).add(c.Ly).add(c.Lz).value()
+                : HashBuilder().add(std::string("background"))
+                      .add(backgroundFilesKey(c.background)).add(c.Lx).add(c.Ly).add(c.Lz).value();
+            const std::uint64_t maskKey = HashBuilder().add(gridKey)
+                .add(c.mask.toString()).value();
+            HashBuilder topoHash;
+            topoHash.add(maskKey).add(c.islands).add(c.keepComponents)
+                    .add(static_cast<std::uint64_t>(c.patches.size()));
+            for (const PatchRule& r : c.patches)
+            {
+                topoHash.add(r.patch).add(r.name).add(r.type);
+            }
+            const std::uint64_t topoKey = topoHash.value();
+            const std::uint64_t writeKey = HashBuilder().add(topoKey)
+                .add(std::string(c.format == PolyMeshFormat::binary ? "polyMesh binary" : "polyMesh ascii"))
+                .add(std::string(c.compression == PolyMeshCompression::gzip ? "gzip" : "none")).add(c.output).add(c.vtk).add(c.alphaSamples).add(c.fields.toString()).value();
+
+            const bool withZones = c.mask.getWordOrDefault("type", "all") == "regions";
+            std::vector<std::string> outputs = polyMeshFiles(c.output, withZones, c.compression);
+            if (!c.vtk.empty()) outputs.push_back(c.vtk);
+            if (c.alphaSamples > 0) outputs.push_back(timeDirectory(c.output) + "/alpha");
+
+            std::vector<std::string> regionNames;
+            makeRegionMask(c.mask, c.Lx, c.Ly, c.Lz, regionNames);
+            const std::vector<InitialField> initialFields = makeInitialFields(c.fields, regionNames);
+            for (const InitialField& f : initialFields)
+            {
+                outputs.push_back(timeDirectory(c.output) + "/" + f.name);
+            }
+
+            if (cache && cache->outputsUpToDate(writeKey, outputs))
+            {
+                release();
+                std::lock_guard<std::mutex> lock(logMutex);
+                std::cout << "case " << c.name << ": up to date -> " << c.output << "\n";
+                return;
+            }
+
+            // 体积分数需要背景网格与 keep 位图，此时不直接取缓存的裁剪结果
+            MeshData masked;
+            std::vector<double> alpha;
+            if (!cache || c.alphaSamples > 0 || !cache->loadMesh(topoKey, masked))
+            {
+                std::call_once(slot.once, [&]()
+                {
+                    slot.mesh = std::make_shared<const MeshData>(c.background.empty()
+                        ? generateStructuredMesh(c.Nx, c.Ny, c.Nz, c.Lx, c.Ly, c.Lz)
+                        : readPolyMesh(c.background));
+                });
+                std::shared_ptr<const MeshData> bg = slot.mesh;
+
+                if (!c.background.empty())
+                {
+                    // 任意六面体背景：不走 i/j/k 的 keep 位图缓存
+                    masked = applyMaskPolyMesh(*bg, makeMask(c.mask, c.Lx, c.Ly, c.Lz));
+                }
+                else
+                {
+                    ScopedStage stage("applyMask");
+
+                    // 区域掩模：keep 图中是区域编号，同时写 cellZones / faceZones
+                    const std::size_t nCells = static_cast<std::size_t>(c.Nx) * c.Ny * c.Nz;
+                    if (!cache || !cache->loadKeep(maskKey, ws.keepCell) || ws.keepCell.size() != nCells)
+                    {
+                        std::vector<std::string> names;
+                        evaluateRegions(*bg, makeRegionMask(c.mask, c.Lx, c.Ly, c.Lz, names), ws.keepCell);
+                        if (cache) cache->storeKeep(maskKey, ws.keepCell);
+                    }
+
+                    if (!c.islands.empty())
+                    {
+                        ConnectivityOptions opts;
+                        opts.policy         = islandPolicyFromString(c.islands);
+                        opts.keepComponents = c.keepComponents;
+                        ConnectivityReport report = analyzeConnectivity(*bg, ws.keepCell, opts);
+
+                        std::lock_guard<std::mutex> lock(logMutex);
+                        std::cout << "case " << c.name << ": ";
+                        writeConnectivityReport(report, std::cout);
+                        if (!report.passed)
+                        {
+                            std::cerr << "case " << c.name << ": connectivity check failed, nothing written.\n";
+                            ++nFailed;
+                            bg.reset();
+                            release();
+                            return;
+                        }
+                    }
+
+                    masked = applyKeepMask(*bg, ws.keepCell, ws, regionNames);
+
+                    if (c.alphaSamples > 0)
+                    {
+                        alpha = computeVolumeFraction(*bg, ws.keepCell,
+                            makeMask(c.mask, c.Lx, c.Ly, c.Lz), c.alphaSamples);
+                    }
+
+                    stage.setCells(static_cast<std::uint64_t>(ws.cellCount));
+                    stage.setFaces(masked.faces.size());
+                }
+
+                bg.reset();
+                release();
+
+                removeUnusedPoints(masked);
+                try
+                {
+                    applyPatchRules(masked, c.patches);
+                }
+                catch (const MeshRequestError& e)
+                {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    std::cerr << "case " << c.name << ": " << e.what() << ", nothing written.\n";
+                    ++nFailed;
+                    return;
+                }
+
+                if (cache) cache->storeMesh(topoKey, masked);
+            }
+            release();
+
+            if (c.check)
+            {
+                MeshCheckReport report = checkMesh(masked);
+                if (!report.passed)
+                {
+                    std::lock_guard<std::mutex> lock(logMutex);
+                    std::cerr << "case " << c.name << ": mesh check failed, nothing written.\n";
+                    writeMeshCheckReport(report, std::cerr);
+                    ++nFailed;
+                    return;
+                }
+            }
+
+            // 0/ 下的场：体积分数 + 初始场（区域值取自裁剪时生成的 cellZones）
+            std::vector<VolField> fields;
+            if (!alpha.empty())
+            {
+                VolField f;
+                f.name   = "alpha";
+                f.values = std::move(alpha);
+                fields.push_back(std::move(f));
+            }
+            for (const InitialField& f : initialFields)
+            {
+                fields.push_back(evaluateInitialField(masked, f));
+            }
+            const std::string timeDir = timeDirectory(c.output);
+
+            if (cache)
+            {
+                // 内容未变的文件不改写，下游看到的时间戳保持不变
+                writePolyMeshIfChanged(masked, c.output, c.format, c.compression);
+                if (!c.vtk.empty())
+                {
+                    writeVTKSurfaceIfChanged(masked, c.vtk);
+                }
+                for (const VolField& f : fields)
+                {
+                    writeVolFieldIfChanged(masked, timeDir, f);
+                }
+                cache->recordOutputs(writeKey, outputs);
+            }
+            else
+            {
+                writePolyMesh(masked, c.output, c.format, c.compression);
+                if (!c.vtk.empty())
+                {
+                    writeVTKSurface(masked, c.vtk);
+                }
+                for (const VolField& f : fields)
+                {
+                    writeVolField(masked, timeDir, f);
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << "case " << c.name << ": done -> " << c.output << "\n";
+        });
+    }
+
+    pool.wait();
+    return nFailed.load();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "CaseConfig.h"
+
+struct BatchOptions
+{
+    unsigned    nJobs = 0;   // 并发 case 数，0 = 硬件线程数
+    std::string cacheDir;    // 非空时启用内容寻址缓存（见 MeshCache.h）
+};
+
+// 在一个进程内跑完所有 case：
+//   - 分辨率 / 尺寸相同的 case 共用同一个背景网格（只生成一次，最后一个用完即释放）
+//   - 每个工作线程持有一个 MaskWorkspace 与线程私有的 ScratchArena，在 case 之间复用临时缓冲区
+//     （arena 在每个 case 开始时 O(1) 重置）
+//   - 互不相关的 case 在 TaskPool 上并发执行
+//   - 启用缓存时只重算输入变化了的阶段，内容未变的输出文件不改写
+// 返回失败（网格检查不通过）的 case 数。
+int runBatch(const std::vector<MeshCase>& cases, const BatchOptions& opts = BatchOptions());
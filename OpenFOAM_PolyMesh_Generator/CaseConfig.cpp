@@ -0,0 +1,361 @@
+#include "CaseConfig.h"
+#include "Connectivity.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+
+namespace
+{
+
+MeshCase makeCase(const std::string& name, const Dictionary& d)
+{
+    MeshCase c;
+    c.name = name;
+
+    c.background = d.getWordOrDefault("background", "");
+
+    // 读入背景网格时 N 不起作用
+    const std::vector<double> N = c.background.empty() || d.found("N") ? d.getList("N")
+                                                                       : std::vector<double>{1, 1, 1};
+    const std::vector<double> L = d.getList("L");
+    if (N.size() != 3 || L.size() != 3)
+    {
+        std::cerr << "Case " << name << ": N and L need three components\n";
+        std::exit(1);
+    }
+    c.Nx = static_cast<int>(N[0]);
+    c.Ny = static_cast<int>(N[1]);
+    c.Nz = static_cast<int>(N[2]);
+    c.Lx = L[0];
+    c.Ly = L[1];
+    c.Lz = L[2];
+
+    if (c.Nx <= 0 || c.Ny <= 0 || c.Nz <= 0 || c.Lx <= 0 || c.Ly <= 0 || c.Lz <= 0)
+    {
+        std::cerr << "Case " << name << ": N and L must be positive\n";
+        std::exit(1);
+    }
+
+    if (d.isDict("mask"))
+    {
+        c.mask = d.subDict("mask");
+    }
+    else
+    {
+        c.mask = Dictionary::parse("type all;");
+    }
+
+    c.output = d.getWordOrDefault("output", name + "/constant/polyMesh");
+    c.vtk    = d.getWordOrDefault("vtk", "");
+    c.check  = d.getBoolOrDefault("check", false);
+    c.alphaSamples = static_cast<int>(d.getLabelOrDefault("alphaSamples", 0));
+    if (d.isDict("fields"))
+    {
+        c.fields = d.subDict("fields");
+    }
+
+    c.islands        = d.getWordOrDefault("islands", "");
+    c.keepComponents = static_cast<int>(d.getLabelOrDefault("keepComponents", 1));
+    if (!c.islands.empty())
+    {
+        islandPolicyFromString(c.islands);   // 尽早报告拼写错误
+        if (!c.background.empty())
+        {
+            std::cerr << "Case " << name << ": islands needs a structured background, not 'background'\n";
+            std::exit(1);
+        }
+    }
+    if (c.alphaSamples > 0 && !c.background.empty())
+    {
+        std::cerr << "Case " << name << ": alphaSamples needs a structured background, not 'background'\n";
+        std::exit(1);
+    }
+
+    if (d.isDict("patches"))
+    {
+        for (const auto& e : d.subDict("patches").entries())
+        {
+            if (!e.isDict())
+            {
+                std::cerr << "Case " << name << ": patches: '" << e.key << "' needs a { name ...; type ...; } sub-dictionary\n";
+                std::exit(1);
+            }
+            const Dictionary& r = e.dict.front();
+            c.patches.push_back({e.key, r.getWordOrDefault("name", ""), r.getWordOrDefault("type", "")});
+        }
+    }
+
+    const std::string fmt = d.getWordOrDefault("format", "ascii");
+    if (fmt == "binary")
+    {
+        c.format = PolyMeshFormat::binary;
+    }
+    else if (fmt != "ascii")
+    {
+        std::cerr << "Case " << name << ": unknown format '" << fmt << "'\n";
+        std::exit(1);
+    }
+
+    const std::string comp = d.getWordOrDefault("compression", "none");
+    if (comp == "gzip")
+    {
+        c.compression = PolyMeshCompression::gzip;
+    }
+    else if (comp != "none")
+    {
+        std::cerr << "Case " << name << ": unknown compression '" << comp << "'\n";
+        std::exit(1);
+    }
+    return c;
+}
+
+// 场值：单个标量或 (x y z)；返回分量数
+int fieldValue(const Dictionary& d, const std::string& key, InitialField::Value& v)
+{
+    const std::vector<std::string>& t = d.tokens(key);
+    if (t.size() == 1)
+    {
+        v = {d.getScalar(key), 0.0, 0.0};
+        return 1;
+    }
+    const std::vector<double> l = d.getList(key);
+    if (l.size() != 3)
+    {
+        std::cerr << "fields: '" << key << "' needs a scalar or three components\n";
+        std::exit(1);
+    }
+    v = {l[0], l[1], l[2]};
+    return 3;
+}
+
+std::vector<double> vec3(const Dictionary& d, const std::string& key)
+{
+    std::vector<double> v = d.getList(key);
+    if (v.size() != 3)
+    {
+        std::cerr << "mask: '" << key << "' needs three components\n";
+        std::exit(1);
+    }
+    return v;
+}
+
+} // namespace
+
+std::vector<MeshCase> readCaseFile(const std::string& filePath)
+{
+    const Dictionary top = Dictionary::readFile(filePath);
+
+    Dictionary defaults = top;
+    defaults.remove("cases");
+
+    std::vector<MeshCase> cases;
+    if (top.isDict("cases"))
+    {
+        for (const auto& e : top.subDict("cases").entries())
+        {
+            if (!e.isDict()) continue;
+            Dictionary d = defaults;
+            d.merge(e.dict.front());
+            cases.push_back(makeCase(e.key, d));
+        }
+    }
+    else
+    {
+        cases.push_back(makeCase(top.getWordOrDefault("name", "case"), defaults));
+    }
+
+    if (cases.empty())
+    {
+        std::cerr << "Case file " << filePath << " defines no cases\n";
+        std::exit(1);
+    }
+    return cases;
+}
+
+MaskFunc makeMask(const Dictionary& d, double Lx, double Ly, double /*Lz*/)
+{
+    const std::string type = d.getWordOrDefault("type", "all");
+    const bool invert = d.getBoolOrDefault("invert", false);
+
+    MaskFunc f;
+
+    if (type == "all")
+    {
+        f = [](const Point&) { return true; };
+    }
+    else if (type == "regions")
+    {
+        std::vector<std::string> names;
+        RegionFunc r = makeRegionMask(d, Lx, Ly, 0.0, names);
+        f = [r](const Point& c) { return r(c) != 0; };
+    }
+    else if (type == "tubeReflector")
+    {
+        const double tubeEnd = d.getScalarOrDefault("tubeEnd", 0.5) * Lx;
+        std::vector<double> ax = d.found("semiAxes") ? d.getList("semiAxes")
+                                                     : std::vector<double>{0.5, 0.5};
+        if (ax.size() != 2)
+        {
+            std::cerr << "mask: 'semiAxes' needs two components\n";
+            std::exit(1);
+        }
+        const double a = ax[0] * Lx;
+        const double b = ax[1] * Ly;
+        const double level = d.getScalarOrDefault("level", 1.0);
+
+        f = [tubeEnd, a, b, level, Ly](const Point& c) -> bool
+        {
+            if (c.x <= tubeEnd) return true;
+            double xc = (c.x - tubeEnd) / a;
+            double yc = (c.y - 0.5 * Ly) / b;
+            return xc*xc + yc*yc <= level;
+        };
+    }
+    else if (type == "box")
+    {
+        const std::vector<double> lo = vec3(d, "min");
+        const std::vector<double> hi = vec3(d, "max");
+        f = [lo, hi](const Point& c) -> bool
+        {
+            return c.x >= lo[0] && c.x <= hi[0]
+                && c.y >= lo[1] && c.y <= hi[1]
+                && c.z >= lo[2] && c.z <= hi[2];
+        };
+    }
+    else if (type == "ellipsoid")
+    {
+        const std::vector<double> o = vec3(d, "centre");
+        const std::vector<double> r = vec3(d, "radii");
+        f = [o, r](const Point& c) -> bool
+        {
+            double x = (c.x - o[0]) / r[0];
+            double y = (c.y - o[1]) / r[1];
+            double z = (c.z - o[2]) / r[2];
+            return x*x + y*y + z*z <= 1.0;
+        };
+    }
+    else
+    {
+        std::cerr << "mask: unknown type '" << type << "'\n";
+        std::exit(1);
+    }
+
+    if (invert)
+    {
+        return [f](const Point& c) { return !f(c); };
+    }
+    return f;
+}
+
+RegionFunc makeRegionMask(const Dictionary& d, double Lx, double Ly, double Lz,
+                          std::vector<std::string>& regionNames)
+{
+    regionNames.clear();
+
+    if (d.getWordOrDefault("type", "all") != "regions")
+    {
+        MaskFunc f = makeMask(d, Lx, Ly, Lz);
+        return [f](const Point& c) { return f(c) ? 1 : 0; };
+    }
+
+    if (d.getBoolOrDefault("invert", false))
+    {
+        std::cerr << "mask: 'invert' is not supported for 'regions'\n";
+        std::exit(1);
+    }
+
+    std::vector<MaskFunc> regions;
+    for (const auto& e : d.entries())
+    {
+        if (!e.isDict()) continue;
+        regionNames.push_back(e.key);
+        regions.push_back(makeMask(e.dict.front(), Lx, Ly, Lz));
+    }
+
+    if (regions.empty() || regions.size() > 127)
+    {
+        std::cerr << "mask: 'regions' needs 1..127 region sub-dictionaries\n";
+        std::exit(1);
+    }
+
+    return [regions](const Point& c) -> int
+    {
+        for (std::size_t r = 0; r < regions.size(); ++r)
+        {
+            if (regions[r](c)) return static_cast<int>(r) + 1;
+        }
+        return 0;
+    };
+}
+
+std::vector<InitialField> makeInitialFields(const Dictionary& fieldsDict,
+                                            const std::vector<std::string>& regionNames)
+{
+    static const std::map<std::string, std::string> defaultDimensions =
+    {
+        {"p", "[1 -1 -2 0 0 0 0]"},
+        {"T", "[0 0 0 1 0 0 0]"},
+        {"U", "[0 1 -1 0 0 0 0]"}
+    };
+
+    std::vector<InitialField> fields;
+    for (const auto& e : fieldsDict.entries())
+    {
+        if (!e.isDict()) continue;
+        const Dictionary& d = e.dict.front();
+
+        InitialField f;
+        f.name = e.key;
+
+        auto dim = defaultDimensions.find(f.name);
+        if (d.found("dimensions"))
+        {
+            f.dimensions.clear();
+            for (const auto& t : d.tokens("dimensions"))
+            {
+                f.dimensions += (f.dimensions.empty() ? "" : " ") + t;
+            }
+        }
+        else if (dim != defaultDimensions.end())
+        {
+            f.dimensions = dim->second;
+        }
+
+        f.nComponents = fieldValue(d, "value", f.value);
+
+        for (const auto& r : d.entries())
+        {
+            if (r.key == "dimensions" || r.key == "value" || r.key == "boundary") continue;
+
+            auto it = std::find(regionNames.begin(), regionNames.end(), r.key);
+            if (it == regionNames.end() || r.isDict())
+            {
+                std::cerr << "fields: " << f.name << ": '" << r.key << "' is not a region of the mask\n";
+                std::exit(1);
+            }
+
+            InitialField::Value v;
+            if (fieldValue(d, r.key, v) != f.nComponents)
+            {
+                std::cerr << "fields: " << f.name << ": '" << r.key << "' has the wrong number of components\n";
+                std::exit(1);
+            }
+            f.regionValues.emplace_back(static_cast<int>(it - regionNames.begin()) + 1, v);
+        }
+
+        if (d.isDict("boundary"))
+        {
+            const Dictionary& b = d.subDict("boundary");
+            f.defaultBoundary = b.getWordOrDefault("type", f.defaultBoundary);
+            for (const auto& p : b.entries())
+            {
+                if (p.key != "type" && !p.isDict()) f.patchBoundary[p.key] = b.getWord(p.key);
+            }
+        }
+
+        fields.push_back(f);
+    }
+    return fields;
+}
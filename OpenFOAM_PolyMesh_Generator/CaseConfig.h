@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "Dictionary.h"
+#include "DomainMask.h"
+#include "InitialFields.h"
+#include "PolyMeshGen.h"
+#include "PolyMeshWriter.h"
+
+// 一个网格 case：背景网格分辨率 / 尺寸 + 掩模定义 + 输出位置
+struct MeshCase
+{
+    std::string name;
+
+    int    Nx = 0, Ny = 0, Nz = 1;
+    double Lx = 1.0, Ly = 1.0, Lz = 1.0;
+
+    std::string background;    // 可选：已有 polyMesh 目录作背景网格（此时 N 不需要）
+
+    Dictionary  mask;          // 掩模定义：type + 参数，见 makeMask()
+    std::string output;        // polyMesh 输出目录
+    PolyMeshFormat format = PolyMeshFormat::ascii;   // format ascii | binary;
+    PolyMeshCompression compression = PolyMeshCompression::none;   // compression none | gzip;
+    std::string vtk;           // 可选：VTK 表面文件（以 .gz 结尾时压缩）
+    bool        check = false; // 写出前做网格质量检查
+    int         alphaSamples = 0;  // > 0 时写 <case>/0/alpha 体积分数，每方向的采样数
+    Dictionary  fields;        // 可选：初始场定义，见 makeInitialFields()
+    std::string islands;       // 可选：report | largest | fail，裁剪后的连通性分析
+    int         keepComponents = 1;   // largest / fail 时允许保留的连通块数
+    std::vector<PatchRule> patches;   // 可选：默认 patch 的改名 / 改类型，见 applyPatchRules()
+};
+
+// 读取 case 文件。顶层条目是所有 case 的默认值；
+// 若有 cases { name { ... } } 子字典，则每个子字典是一个 case（覆盖默认值），
+// 否则顶层本身就是唯一的 case。
+//
+//   N      (1000 500 1);
+//   L      (1.0 0.5 0.01);
+//   mask   { type tubeReflector; tubeEnd 0.5; }
+//   cases
+//   {
+//       base    { output "base/constant/polyMesh"; }
+//       shorter { mask { type tubeReflector; tubeEnd 0.4; } }
+//   }
+//
+// 给出 background "blockMeshCase/constant/polyMesh"; 时改为读入该任意六面体网格
+// 并用 applyMaskPolyMesh 裁剪；L 仍作为掩模参数的尺度。
+//
+// patches 子字典按默认 patch 名给出新名字 / 类型（都可省略），同名的 patch 合并：
+//   patches { back { name frontAndBack; type empty; } front { name frontAndBack; type empty; } }
+std::vector<MeshCase> readCaseFile(const std::string& filePath);
+
+// 由掩模字典构造 MaskFunc。支持的 type：
+//   all                              保留全部
+//   tubeReflector  tubeEnd 0.5; semiAxes (0.5 0.5); level 1;
+//                  x <= tubeEnd*Lx 的直管 + 以 (tubeEnd*Lx, Ly/2) 为中心的半椭圆反射器
+//   box            min (x y z); max (x y z);
+//   ellipsoid      centre (x y z); radii (a b c);
+//   regions        每个子字典是一个区域（其中为上述任一类型），按出现顺序编号 1, 2, ...；
+//                  单元属于第一个包含它的区域，都不包含则删除：
+//                  mask { type regions; driver { type box; ... } driven { ... } reflector { ... } }
+// 除 regions 外任何类型都可加 invert true; 取反。对 regions，makeMask 返回“属于任一区域”。
+MaskFunc makeMask(const Dictionary& maskDict, double Lx, double Ly, double Lz);
+
+// 由掩模字典构造区域函数；regionNames 按编号返回各区域名（非 regions 类型时为空，
+// 区域函数只返回 0 / 1）
+RegionFunc makeRegionMask(const Dictionary& maskDict, double Lx, double Ly, double Lz,
+                          std::vector<std::string>& regionNames);
+
+// 由 fields 字典构造初始场。每个子字典是一个场：
+//   p { dimensions [1 -1 -2 0 0 0 0]; value 1e5; driver 1e6; boundary { type zeroGradient; } }
+//   U { value (0 0 0); boundary { type slip; left zeroGradient; } }
+// value 为默认值（标量或 (x y z)）；以区域名为键的条目给该区域的值；
+// boundary 中 type 为默认边界条件，其余键为 patch 名。p / T / U 有默认的 dimensions。
+std::vector<InitialField> makeInitialFields(const Dictionary& fieldsDict,
+                                            const std::vector<std::string>& regionNames);
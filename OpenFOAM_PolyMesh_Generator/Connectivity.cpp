@@ -0,0 +1,277 @@
+#include "Connectivity.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+namespace
+{
+
+// 无锁并查集：根总是链接到编号更小的根，路径减半用 CAS
+class ConcurrentUnionFind
+{
+public:
+    explicit ConcurrentUnionFind(std::size_t n)
+        : parent_(new std::atomic<label>[n])
+    {
+        parallelFor(n, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t i = b; i < e; ++i)
+            {
+                parent_[i].store(static_cast<label>(i), std::memory_order_relaxed);
+            }
+        });
+    }
+
+    label find(label x) const
+    {
+        while (true)
+        {
+            label p = parent_[x].load(std::memory_order_relaxed);
+            if (p == x) return x;
+            label gp = parent_[p].load(std::memory_order_relaxed);
+            if (gp != p)
+            {
+                parent_[x].compare_exchange_weak(p, gp, std::memory_order_relaxed);
+            }
+            x = gp;
+        }
+    }
+
+    void unite(label a, label b)
+    {
+        while (true)
+        {
+            a = find(a);
+            b = find(b);
+            if (a == b) return;
+            if (a < b) std::swap(a, b);
+            label expected = a;
+            if (parent_[a].compare_exchange_strong(expected, b, std::memory_order_relaxed)) return;
+        }
+    }
+
+private:
+    std::unique_ptr<std::atomic<label>[]> parent_;
+};
+
+// 2x2x2 块内（位 b = dx + 2*dy + 4*dz）给定 cell 子集的面连通分量数
+std::array<unsigned char, 256> makeBlockComponentTable()
+{
+    std::array<unsigned char, 256> table{};
+    for (int mask = 0; mask < 256; ++mask)
+    {
+        int seen = 0;
+        int nComp = 0;
+        for (int s = 0; s < 8; ++s)
+        {
+            if (!(mask >> s & 1) || (seen >> s & 1)) continue;
+            ++nComp;
+            int stack[8];
+            int top = 0;
+            stack[top++] = s;
+            seen |= 1 << s;
+            while (top)
+            {
+                const int c = stack[--top];
+                for (int bit = 1; bit < 8; bit <<= 1)
+                {
+                    const int n = c ^ bit;   // 只差一个方向：共面
+                    if ((mask >> n & 1) && !(seen >> n & 1))
+                    {
+                        seen |= 1 << n;
+                        stack[top++] = n;
+                    }
+                }
+            }
+        }
+        table[mask] = static_cast<unsigned char>(nComp);
+    }
+    return table;
+}
+
+} // namespace
+
+IslandPolicy islandPolicyFromString(const std::string& s)
+{
+    if (s == "report")  return IslandPolicy::report;
+    if (s == "largest") return IslandPolicy::keepLargest;
+    if (s == "fail")    return IslandPolicy::fail;
+    std::cerr << "Unknown island policy '" << s << "' (report | largest | fail)\n";
+    std::exit(1);
+}
+
+ConnectivityReport analyzeConnectivity(const MeshData& bgMesh, std::vector<char>& keepCell,
+                                       const ConnectivityOptions& opts)
+{
+    ScopedStage stage("connectivity");
+
+    const int Nx = bgMesh.Nx;
+    const int Ny = bgMesh.Ny;
+    const int Nz = bgMesh.Nz;
+    const std::size_t nCells = static_cast<std::size_t>(Nx) * Ny * Nz;
+    stage.setCells(nCells);
+
+    if (keepCell.size() != nCells)
+    {
+        std::cerr << "analyzeConnectivity: keep mask size " << keepCell.size()
+                  << " does not match background cells " << nCells << "\n";
+        std::exit(1);
+    }
+
+    ConnectivityReport r;
+
+    ScratchFrame scratch;
+
+    // 1) 面邻接并查集：每个保留 cell 与 +x / +y / +z 方向的保留邻居合并
+    ConcurrentUnionFind uf(nCells);
+    const std::size_t sliceXY = static_cast<std::size_t>(Nx) * Ny;
+
+    parallelFor(nCells, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t c = b; c < e; ++c)
+        {
+            if (!keepCell[c]) continue;
+            const int i = static_cast<int>(c % Nx);
+            const int j = static_cast<int>(c / Nx % Ny);
+            const int k = static_cast<int>(c / sliceXY);
+            const label ci = static_cast<label>(c);
+
+            if (i + 1 < Nx && keepCell[c + 1])       uf.unite(ci, ci + 1);
+            if (j + 1 < Ny && keepCell[c + Nx])      uf.unite(ci, ci + Nx);
+            if (k + 1 < Nz && keepCell[c + sliceXY]) uf.unite(ci, static_cast<label>(c + sliceXY));
+        }
+    });
+
+    // 2) 各连通块大小（以根的 cell 编号为块标识）
+    ScratchVector<label> root(nCells, -1);
+    parallelFor(nCells, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t c = b; c < e; ++c)
+        {
+            if (keepCell[c]) root[c] = uf.find(static_cast<label>(c));
+        }
+    });
+
+    ScratchVector<std::size_t> size(nCells, 0);
+    for (std::size_t c = 0; c < nCells; ++c)
+    {
+        if (root[c] >= 0) ++size[root[c]];
+    }
+
+    ScratchVector<label> roots;
+    for (std::size_t c = 0; c < nCells; ++c)
+    {
+        if (size[c] > 0) roots.push_back(static_cast<label>(c));
+    }
+    std::stable_sort(roots.begin(), roots.end(), [&](label a, label b) { return size[a] > size[b]; });
+
+    for (label rt : roots) r.componentSizes.push_back(size[rt]);
+
+    const std::size_t nKeepComp = static_cast<std::size_t>(std::max(opts.keepComponents, 1));
+    const bool tooMany = roots.size() > nKeepComp;
+
+    // 3) keepLargest：清掉排在 keepComponents 之后的连通块
+    if (tooMany && opts.policy == IslandPolicy::keepLargest)
+    {
+        ScratchVector<char> keepRoot(nCells, 0);
+        for (std::size_t n = 0; n < nKeepComp; ++n) keepRoot[roots[n]] = 1;
+
+        std::vector<std::size_t> dropped(parallelChunkCount(nCells), 0);
+        parallelFor(nCells, [&](std::size_t b, std::size_t e, unsigned chunk)
+        {
+            for (std::size_t c = b; c < e; ++c)
+            {
+                if (root[c] >= 0 && !keepRoot[root[c]])
+                {
+                    keepCell[c] = 0;
+                    ++dropped[chunk];
+                }
+            }
+        });
+        for (std::size_t d : dropped) r.nDroppedCells += d;
+    }
+
+    // 4) 非流形点：每个网格点周围 2x2x2 个 cell（越出背景网格的视为删去），
+    //    保留与删去的 cell 各自在块内必须面连通
+    static const std::array<unsigned char, 256> blockComponents = makeBlockComponentTable();
+
+    const std::size_t nPoints = static_cast<std::size_t>(Nx + 1) * (Ny + 1) * (Nz + 1);
+    const unsigned nChunks = parallelChunkCount(nPoints);
+    std::vector<std::size_t> nBad(nChunks, 0);
+    std::vector<long long>   firstBad(nChunks, -1);
+
+    parallelFor(nPoints, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        for (std::size_t p = b; p < e; ++p)
+        {
+            const int i = static_cast<int>(p % (Nx + 1));
+            const int j = static_cast<int>(p / (Nx + 1) % (Ny + 1));
+            const int k = static_cast<int>(p / (static_cast<std::size_t>(Nx + 1) * (Ny + 1)));
+
+            int mask = 0;
+            for (int s = 0; s < 8; ++s)
+            {
+                const int ci = i - 1 + (s & 1);
+                const int cj = j - 1 + (s >> 1 & 1);
+                const int ck = k - 1 + (s >> 2 & 1);
+                if (ci < 0 || cj < 0 || ck < 0 || ci >= Nx || cj >= Ny || ck >= Nz) continue;
+                if (keepCell[static_cast<std::size_t>(ck) * sliceXY + static_cast<std::size_t>(cj) * Nx + ci])
+                {
+                    mask |= 1 << s;
+                }
+            }
+
+            if (mask == 0 || mask == 0xFF) continue;
+            if (blockComponents[mask] > 1 || blockComponents[~mask & 0xFF] > 1)
+            {
+                if (nBad[chunk]++ == 0) firstBad[chunk] = static_cast<long long>(p);
+            }
+        }
+    });
+
+    for (unsigned ch = 0; ch < nChunks; ++ch)
+    {
+        if (nBad[ch] && r.firstNonManifoldPoint < 0) r.firstNonManifoldPoint = firstBad[ch];
+        r.nNonManifoldPoints += nBad[ch];
+    }
+
+    if (opts.policy == IslandPolicy::fail && (tooMany || r.nNonManifoldPoints > 0))
+    {
+        r.passed = false;
+    }
+    return r;
+}
+
+void writeConnectivityReport(const ConnectivityReport& r, std::ostream& out)
+{
+    out << "connectivity: " << r.componentSizes.size() << " component(s)";
+    if (!r.componentSizes.empty())
+    {
+        out << ", sizes";
+        const std::size_t nShow = std::min<std::size_t>(r.componentSizes.size(), 8);
+        for (std::size_t n = 0; n < nShow; ++n) out << " " << r.componentSizes[n];
+        if (nShow < r.componentSizes.size()) out << " ...";
+    }
+    out << "\n";
+    if (r.nDroppedCells)
+    {
+        out << "connectivity: dropped " << r.nDroppedCells << " cell(s) outside the largest component(s)\n";
+    }
+    if (r.nNonManifoldPoints)
+    {
+        out << "connectivity: " << r.nNonManifoldPoints
+            << " non-manifold point(s) (cells touching only at edges / corners), first at background point "
+            << r.firstNonManifoldPoint << "\n";
+    }
+    if (!r.passed)
+    {
+        out << "connectivity: FAILED\n";
+    }
+}
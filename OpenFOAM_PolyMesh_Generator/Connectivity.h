@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+
+// 裁剪后的连通性分析，在背景结构网格的 keep 图上进行（applyKeepMask 之前）：
+// - 按面邻接对保留 cell 做并行并查集，统计各连通块大小
+// - 只在棱 / 角上相接的 cell 会在 OpenFOAM 中形成非流形点：对每个网格点检查
+//   周围 2x2x2 个 cell，保留的（或删去的）cell 在块内按面连通分成多组即为非流形点
+
+enum class IslandPolicy
+{
+    report,        // 只报告
+    keepLargest,   // 只保留最大的 keepComponents 个连通块
+    fail           // 多于 keepComponents 个连通块或存在非流形点即失败
+};
+
+struct ConnectivityOptions
+{
+    IslandPolicy policy         = IslandPolicy::report;
+    int          keepComponents = 1;
+};
+
+struct ConnectivityReport
+{
+    std::vector<std::size_t> componentSizes;   // 从大到小
+    std::size_t nDroppedCells      = 0;        // keepLargest 删去的 cell 数
+    std::size_t nNonManifoldPoints = 0;        // 处理之后仍存在的非流形点
+    long long   firstNonManifoldPoint = -1;    // 背景网格中的点编号
+    bool        passed = true;
+};
+
+// keepCell 的非零项为保留（可为区域编号）；keepLargest 时就地清掉小连通块
+ConnectivityReport analyzeConnectivity(const MeshData& bgMesh, std::vector<char>& keepCell,
+                                       const ConnectivityOptions& opts = ConnectivityOptions());
+
+void writeConnectivityReport(const ConnectivityReport& report, std::ostream& out);
+
+// "report" / "largest" / "fail"；无法识别时打印错误并退出
+IslandPolicy islandPolicyFromString(const std::string& s);
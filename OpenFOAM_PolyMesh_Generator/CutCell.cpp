@@ -0,0 +1,631 @@
+#include "CutCell.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+
+// 边界面的 patch 编号，顺序与 applyKeepMask 相同
+constexpr int patchBack      = 0;
+constexpr int patchFront     = 1;
+constexpr int patchBottom    = 2;
+constexpr int patchTop       = 3;
+constexpr int patchReflector = 4;
+constexpr int patchLeft      = 5;
+constexpr int patchCut       = 6;   // 切割面：写出时并入 reflector，合并碎片时用来求表面法向
+
+const char* const patchNames[6] = {"back", "front", "bottom", "top", "reflector", "left"};
+
+// cell 的六个面（xmin, xmax, ymin, ymax, zmin, zmax）所在的盒子边界 patch
+constexpr int sidePatch[6] = {patchLeft, patchReflector, patchBottom, patchTop, patchBack, patchFront};
+
+// 裁剪后的一个面：多边形（相邻重复顶点已合并）与其上的切割线段（出点 -> 入点，沿面的顶点顺序）
+struct ClippedFace
+{
+    std::array<label, 8>                    poly{};
+    int                                     nPoly = 0;
+    std::array<std::pair<label, label>, 2>  cuts{};
+    int                                     nCuts = 0;
+};
+
+// 一组连续背景行的输出；owner / neighbour 为背景 cell 编号
+struct CutChunk
+{
+    FaceList           faces;
+    std::vector<label> owner;
+    std::vector<label> neighbour;   // 边界面为 -1
+    std::vector<char>  patch;       // 边界面的 patch，内部面为 -1
+    std::vector<label> cutCells;    // 本块中被切的 cell
+};
+
+Point sub(const Point& a, const Point& b) { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+
+// 多边形面心与面积矢量（绕面心的三角扇形分解）
+void faceGeometry(std::span<const label> f, const std::vector<Point>& pts, Point& centre, Point& area)
+{
+    const double w = 1.0 / static_cast<double>(f.size());
+    Point c{0.0, 0.0, 0.0};
+    for (label v : f)
+    {
+        c.x += w * pts[v].x;
+        c.y += w * pts[v].y;
+        c.z += w * pts[v].z;
+    }
+
+    Point s{0.0, 0.0, 0.0};
+    for (std::size_t k = 0; k < f.size(); ++k)
+    {
+        const Point a = sub(pts[f[k]], c);
+        const Point b = sub(pts[f[(k + 1) % f.size()]], c);
+        s.x += 0.5 * (a.y * b.z - a.z * b.y);
+        s.y += 0.5 * (a.z * b.x - a.x * b.z);
+        s.z += 0.5 * (a.x * b.y - a.y * b.x);
+    }
+    centre = c;
+    area   = s;
+}
+
+label findRoot(ScratchVector<label>& parent, label c)
+{
+    while (parent[c] != c)
+    {
+        parent[c] = parent[parent[c]];
+        c = parent[c];
+    }
+    return c;
+}
+
+} // namespace
+
+MeshData applyCutCells(const MeshData& bgMesh, const SignedDistanceFunc& distance,
+                       const CutCellOptions& opts, CutCellReport* report)
+{
+    ScopedStage stage("applyCutCells");
+
+    const int Nx = bgMesh.Nx;
+    const int Ny = bgMesh.Ny;
+    const int Nz = bgMesh.Nz;
+    const std::size_t nPointsBg = bgMesh.points.size();
+    const label nCellsBg = static_cast<label>(Nx) * Ny * Nz;
+
+    if (Nx <= 0 || Ny <= 0 || Nz <= 0 ||
+        nPointsBg != static_cast<std::size_t>(Nx + 1) * (Ny + 1) * (Nz + 1))
+    {
+        std::cerr << "applyCutCells: background mesh is not a structured " << Nx << "x" << Ny << "x" << Nz
+                  << " grid\n";
+        std::exit(1);
+    }
+    if (!(opts.snapFraction >= 0.0 && opts.snapFraction < 0.5) || !(opts.mergeFraction >= 0.0))
+    {
+        std::cerr << "applyCutCells: snapFraction must be in [0, 0.5) and mergeFraction >= 0\n";
+        std::exit(1);
+    }
+
+    const std::vector<Point>& bgPts = bgMesh.points;
+    const label stride[3] = {1, static_cast<label>(Nx) + 1, (static_cast<label>(Nx) + 1) * (Ny + 1)};
+
+    auto pointIndex = [&](int i, int j, int k) -> label
+    {
+        return label(k) * stride[2] + label(j) * stride[1] + i;
+    };
+    auto cellIndex = [Nx, Ny](int i, int j, int k) -> label
+    {
+        return label(k) * Ny * Nx + label(j) * Nx + i;
+    };
+
+    ScratchFrame scratch;
+
+    // 1) 背景点上的符号距离
+    ScratchVector<double> phi(nPointsBg);
+    {
+        ScopedStage phiStage("signedDistance");
+        phiStage.setCells(static_cast<std::uint64_t>(nCellsBg));
+        parallelFor(nPointsBg, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t p = b; p < e; ++p) phi[p] = distance(bgPts[p]);
+        }, 1024);
+    }
+    auto inside = [&](label p) { return phi[p] <= 0.0; };
+
+    // 2) 棱上的交点：edgePoint[d][p] 为从点 p 沿方向 d 的棱上的交点编号，-1 为不变号；
+    //    并到端点时为端点编号，否则为追加在背景点之后的新点
+    std::array<ScratchVector<label>, 3> edgePoint = {ScratchVector<label>(nPointsBg, -1),
+                                                     ScratchVector<label>(nPointsBg, -1),
+                                                     ScratchVector<label>(nPointsBg, -1)};
+    auto edgeParam = [&](label p, label q) { return phi[p] / (phi[p] - phi[q]); };
+
+    parallelFor(nPointsBg, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t p = b; p < e; ++p)
+        {
+            const int i = static_cast<int>(p % stride[1]);
+            const int j = static_cast<int>(p / stride[1] % (Ny + 1));
+            const int k = static_cast<int>(p / stride[2]);
+            const bool has[3] = {i < Nx, j < Ny, k < Nz};
+            for (int d = 0; d < 3; ++d)
+            {
+                const label a = static_cast<label>(p);
+                const label q = a + stride[d];
+                if (!has[d] || inside(a) == inside(q)) continue;
+
+                const double t = edgeParam(a, q);
+                edgePoint[d][p] = t <= opts.snapFraction ? a : t >= 1.0 - opts.snapFraction ? q : -2;
+            }
+        }
+    });
+
+    MeshData out;
+    out.Nx = Nx;
+    out.Ny = Ny;
+    out.Nz = Nz;
+    out.points = bgPts;   // 先保留所有点（unused points 可以以后再清）
+    {
+        label next = static_cast<label>(nPointsBg);
+        for (std::size_t p = 0; p < nPointsBg; ++p)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                if (edgePoint[d][p] == -2) edgePoint[d][p] = next++;
+            }
+        }
+        out.points.resize(static_cast<std::size_t>(next));
+    }
+    parallelFor(nPointsBg, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t p = b; p < e; ++p)
+        {
+            for (int d = 0; d < 3; ++d)
+            {
+                const label x = edgePoint[d][p];
+                if (x < static_cast<label>(nPointsBg)) continue;
+
+                const label q = static_cast<label>(p) + stride[d];
+                const double t = edgeParam(static_cast<label>(p), q);
+                const Point& a = bgPts[p];
+                const Point& c = bgPts[q];
+                out.points[x] = {a.x + t * (c.x - a.x), a.y + t * (c.y - a.y), a.z + t * (c.z - a.z)};
+            }
+        }
+    });
+
+    // 相邻两点之间的棱上的交点
+    auto edgeCut = [&](label a, label b) -> label
+    {
+        const label lo = std::min(a, b);
+        const label diff = std::max(a, b) - lo;
+        const int d = diff == stride[0] ? 0 : diff == stride[1] ? 1 : 2;
+        return edgePoint[d][lo];
+    };
+
+    // 按 φ <= 0 裁剪一个四边形面（Sutherland–Hodgman，按顶点顺序走一圈）
+    auto clipFace = [&](const std::array<label, 4>& v, ClippedFace& cf)
+    {
+        cf.nPoly = 0;
+        cf.nCuts = 0;
+        auto push = [&](label p)
+        {
+            if (cf.nPoly == 0 || cf.poly[cf.nPoly - 1] != p) cf.poly[cf.nPoly++] = p;
+        };
+
+        label crossing[4];
+        bool  isExit[4];
+        int   nCross = 0;
+        for (int k = 0; k < 4; ++k)
+        {
+            const label a = v[k];
+            const label b = v[(k + 1) & 3];
+            const bool inA = inside(a);
+            if (inA) push(a);
+            if (inA != inside(b))
+            {
+                const label x = edgeCut(a, b);
+                push(x);
+                crossing[nCross] = x;
+                isExit[nCross]   = inA;
+                ++nCross;
+            }
+        }
+        if (cf.nPoly > 1 && cf.poly[cf.nPoly - 1] == cf.poly[0]) --cf.nPoly;
+
+        // 出点到其后的入点之间是表面在该面上的切割线段
+        for (int c = 0; c < nCross; ++c)
+        {
+            if (!isExit[c]) continue;
+            const label y = crossing[(c + 1) % nCross];
+            if (crossing[c] != y) cf.cuts[cf.nCuts++] = {crossing[c], y};
+        }
+    };
+
+    // 3) 逐 cell 裁剪各面、拼切割面；按背景行分块并行，块内按 cell 编号顺序输出
+    const std::size_t nRows = static_cast<std::size_t>(Ny) * Nz;
+    std::vector<CutChunk> chunks(parallelChunkCount(nRows, 16));
+    {
+        ScopedStage emitStage("faceEmission");
+
+        parallelFor(nRows, [&](std::size_t rb, std::size_t re, unsigned chunk)
+        {
+            CutChunk& out = chunks[chunk];
+            ClippedFace cf;
+            std::vector<std::pair<label, label>> segs;
+            std::vector<char>  used;
+            std::vector<label> loop;
+
+            auto emit = [&](std::span<const label> f, label own, label nei, int patch)
+            {
+                out.faces.push_back(f);
+                out.owner.push_back(own);
+                out.neighbour.push_back(nei);
+                out.patch.push_back(static_cast<char>(patch));
+            };
+
+            for (std::size_t r = rb; r < re; ++r)
+            {
+                const int j = static_cast<int>(r % Ny);
+                const int k = static_cast<int>(r / Ny);
+                for (int i = 0; i < Nx; ++i)
+                {
+                    const label p000 = pointIndex(i    , j    , k    );
+                    const label p100 = pointIndex(i + 1, j    , k    );
+                    const label p010 = pointIndex(i    , j + 1, k    );
+                    const label p110 = pointIndex(i + 1, j + 1, k    );
+                    const label p001 = pointIndex(i    , j    , k + 1);
+                    const label p101 = pointIndex(i + 1, j    , k + 1);
+                    const label p011 = pointIndex(i    , j + 1, k + 1);
+                    const label p111 = pointIndex(i + 1, j + 1, k + 1);
+                    const label corners[8] = {p000, p100, p010, p110, p001, p101, p011, p111};
+
+                    int nInside = 0;
+                    for (label p : corners) nInside += inside(p) ? 1 : 0;
+                    if (nInside == 0) continue;
+
+                    const label c = cellIndex(i, j, k);
+
+                    // 对该 cell 朝外的顶点顺序，与 applyKeepMask 相同
+                    const std::array<label, 4> sides[6] = {
+                        {p000, p001, p011, p010},   // xmin
+                        {p100, p110, p111, p101},   // xmax
+                        {p000, p100, p101, p001},   // ymin
+                        {p010, p011, p111, p110},   // ymax
+                        {p000, p010, p110, p100},   // zmin
+                        {p001, p101, p111, p011},   // zmax
+                    };
+                    const bool   atLower[3] = {i == 0, j == 0, k == 0};
+                    const bool   atUpper[3] = {i == Nx - 1, j == Ny - 1, k == Nz - 1};
+                    const label  upper[3]   = {c + 1, c + Nx, c + static_cast<label>(Nx) * Ny};
+
+                    segs.clear();
+                    for (int s = 0; s < 6; ++s)
+                    {
+                        clipFace(sides[s], cf);
+                        for (int q = 0; q < cf.nCuts; ++q)
+                        {
+                            // 切割面沿反方向经过同一线段
+                            segs.emplace_back(cf.cuts[q].second, cf.cuts[q].first);
+                        }
+                        if (cf.nPoly < 3) continue;
+
+                        const std::span<const label> poly(cf.poly.data(), static_cast<std::size_t>(cf.nPoly));
+                        const int d = s / 2;
+                        const bool isUpperSide = s % 2 == 1;
+                        if (isUpperSide ? atUpper[d] : atLower[d])
+                        {
+                            emit(poly, c, -1, sidePatch[s]);
+                        }
+                        else if (isUpperSide)
+                        {
+                            // 内部面只由低编号一侧输出；非空的面两侧 cell 都有域内顶点，都保留
+                            emit(poly, c, upper[d], -1);
+                        }
+                    }
+
+                    if (nInside == 8) continue;
+                    out.cutCells.push_back(c);
+
+                    // 切割线段首尾相接成环；接不上的（退化情形）丢弃
+                    used.assign(segs.size(), 0);
+                    for (std::size_t s0 = 0; s0 < segs.size(); ++s0)
+                    {
+                        if (used[s0]) continue;
+                        used[s0] = 1;
+                        loop.assign(1, segs[s0].first);
+                        label cur = segs[s0].second;
+                        bool closed = true;
+                        while (cur != loop.front())
+                        {
+                            std::size_t s1 = 0;
+                            while (s1 < segs.size() && (used[s1] || segs[s1].first != cur)) ++s1;
+                            if (s1 == segs.size())
+                            {
+                                closed = false;
+                                break;
+                            }
+                            used[s1] = 1;
+                            loop.push_back(cur);
+                            cur = segs[s1].second;
+                        }
+                        if (closed && loop.size() >= 3)
+                        {
+                            emit(loop, c, -1, patchCut);
+                        }
+                    }
+                }
+            }
+        }, 16);
+
+        std::size_t nFacesEmitted = 0;
+        for (const CutChunk& ch : chunks) nFacesEmitted += ch.owner.size();
+        emitStage.setFaces(nFacesEmitted);
+    }
+
+    // 拼成一个面表（仍为背景 cell 编号）
+    FaceList           faces;
+    std::vector<label> owner, neighbour;
+    std::vector<char>  patch;
+    ScratchVector<char> isCut(static_cast<std::size_t>(nCellsBg), 0);
+    label nCut = 0;
+    {
+        std::size_t nf = 0, nv = 0;
+        for (const CutChunk& ch : chunks)
+        {
+            nf += ch.owner.size();
+            nv += ch.faces.verts.size();
+        }
+        faces.reserve(nf, nv);
+        owner.reserve(nf);
+        neighbour.reserve(nf);
+        patch.reserve(nf);
+        for (CutChunk& ch : chunks)
+        {
+            for (std::size_t f = 0; f < ch.faces.size(); ++f) faces.push_back(ch.faces[f]);
+            owner.insert(owner.end(), ch.owner.begin(), ch.owner.end());
+            neighbour.insert(neighbour.end(), ch.neighbour.begin(), ch.neighbour.end());
+            patch.insert(patch.end(), ch.patch.begin(), ch.patch.end());
+            for (label c : ch.cutCells) isCut[c] = 1;
+            nCut += static_cast<label>(ch.cutCells.size());
+            ch = CutChunk();
+        }
+    }
+    const std::size_t nFacesAll = owner.size();
+
+    // 4) 碎片合并：被切 cell 的体积（散度定理，以 cell 的 p000 为参考点），
+    //    小于 mergeFraction 倍背景 cell 体积的碎片按壁面法向朝内的投影面积选相邻 cell 并入
+    ScratchVector<label> finalCell(static_cast<std::size_t>(nCellsBg));
+    label nMerged = 0, nDropped = 0;
+    {
+        ScopedStage mergeStage("mergeFragments");
+        mergeStage.setCells(static_cast<std::uint64_t>(nCut));
+
+        auto corner = [&](label c) -> const Point&
+        {
+            const int i = static_cast<int>(c % Nx);
+            const int j = static_cast<int>(c / Nx % Ny);
+            const int k = static_cast<int>(c / (static_cast<label>(Nx) * Ny));
+            return bgPts[pointIndex(i, j, k)];
+        };
+
+        // 体积，以及切割面面积矢量之和（表面朝外的法向）
+        ScratchVector<double> volume(static_cast<std::size_t>(nCellsBg), 0.0);
+        ScratchVector<Point>  wallNormal(static_cast<std::size_t>(nCellsBg), Point{0.0, 0.0, 0.0});
+        ScratchVector<Point>  faceArea(nFacesAll, Point{0.0, 0.0, 0.0});
+        ScratchVector<char>   hasFaces(static_cast<std::size_t>(nCellsBg), 0);   // 所有面都退化的 cell 不算
+        for (std::size_t f = 0; f < nFacesAll; ++f)
+        {
+            const label o = owner[f];
+            const label n = neighbour[f];
+            if (!isCut[o] && (n < 0 || !isCut[n])) continue;
+
+            Point cf, sf;
+            faceGeometry(faces[f], out.points, cf, sf);
+            faceArea[f] = sf;
+            auto addVolume = [&](label c, double sign)
+            {
+                const Point d = sub(cf, corner(c));
+                volume[c] += sign * (sf.x * d.x + sf.y * d.y + sf.z * d.z) / 3.0;
+            };
+            if (isCut[o]) addVolume(o, 1.0);
+            if (n >= 0 && isCut[n]) addVolume(n, -1.0);
+            hasFaces[o] = 1;
+            if (n >= 0) hasFaces[n] = 1;
+            if (patch[f] == patchCut)
+            {
+                wallNormal[o].x += sf.x;
+                wallNormal[o].y += sf.y;
+                wallNormal[o].z += sf.z;
+            }
+        }
+
+        auto isFragment = [&](label c)
+        {
+            if (!isCut[c] || !hasFaces[c]) return false;
+            const int i = static_cast<int>(c % Nx);
+            const int j = static_cast<int>(c / Nx % Ny);
+            const int k = static_cast<int>(c / (static_cast<label>(Nx) * Ny));
+            const Point& a = bgPts[pointIndex(i, j, k)];
+            const Point& b = bgPts[pointIndex(i + 1, j + 1, k + 1)];
+            return volume[c] < opts.mergeFraction * (b.x - a.x) * (b.y - a.y) * (b.z - a.z);
+        };
+
+        // 每个碎片的合并目标：沿表面法向朝域内的相邻 cell（共享面在 -n 上的投影面积最大），
+        // 相邻的碎片因此朝同一方向并、合并后的 cell 不会交错；都不朝内时取共享面积最大的
+        ScratchVector<label>  target(static_cast<std::size_t>(nCellsBg), -1);
+        ScratchVector<double> bestInward(static_cast<std::size_t>(nCellsBg), 0.0);
+        ScratchVector<double> bestArea(static_cast<std::size_t>(nCellsBg), 0.0);
+        ScratchVector<char>   fragment(static_cast<std::size_t>(nCellsBg), 0);
+        for (label c = 0; c < nCellsBg; ++c) fragment[c] = isFragment(c) ? 1 : 0;
+
+        auto offer = [&](label frag, label other, const Point& outward)
+        {
+            const Point& nw = wallNormal[frag];
+            const double magN = std::sqrt(nw.x * nw.x + nw.y * nw.y + nw.z * nw.z);
+            const double area = std::sqrt(outward.x * outward.x + outward.y * outward.y + outward.z * outward.z);
+            const double inward = magN > 0.0
+                ? -(nw.x * outward.x + nw.y * outward.y + nw.z * outward.z) / magN : 0.0;
+            // 先比朝内的投影面积，都不朝内时再比共享面积
+            const double proj = std::max(inward, 0.0);
+            if (target[frag] < 0 || proj > bestInward[frag] ||
+                (proj == bestInward[frag] && area > bestArea[frag]))
+            {
+                bestInward[frag] = proj;
+                bestArea[frag]   = area;
+                target[frag]     = other;
+            }
+        };
+        for (std::size_t f = 0; f < nFacesAll; ++f)
+        {
+            const label o = owner[f];
+            const label n = neighbour[f];
+            if (n < 0) continue;
+            const Point& sf = faceArea[f];
+            if (fragment[o]) offer(o, n, sf);
+            if (fragment[n]) offer(n, o, Point{-sf.x, -sf.y, -sf.z});
+        }
+
+        // 并查集：每组至多一个非碎片（每个碎片只有一条出边），它就是组的代表；
+        // 全是碎片的组（互相指向）取最小编号
+        ScratchVector<label> parent(static_cast<std::size_t>(nCellsBg));
+        for (label c = 0; c < nCellsBg; ++c) parent[c] = c;
+        for (label c = 0; c < nCellsBg; ++c)
+        {
+            if (target[c] >= 0) parent[findRoot(parent, c)] = findRoot(parent, target[c]);
+        }
+        ScratchVector<label> groupRep(static_cast<std::size_t>(nCellsBg), -1);
+        for (label c = 0; c < nCellsBg; ++c)
+        {
+            const label root = findRoot(parent, c);
+            if (!fragment[c] || groupRep[root] < 0) groupRep[root] = c;
+        }
+        for (label c = 0; c < nCellsBg; ++c)
+        {
+            finalCell[c] = groupRep[findRoot(parent, c)];
+            if (!fragment[c]) continue;
+            if (target[c] < 0)
+            {
+                finalCell[c] = -1;   // 孤立碎片：删除
+                ++nDropped;
+            }
+            else if (finalCell[c] != c)
+            {
+                ++nMerged;
+            }
+        }
+    }
+
+    // 5) 新 cell 编号：保留的代表 cell 按背景编号顺序压缩
+    ScratchVector<label> newIndex(static_cast<std::size_t>(nCellsBg), -1);
+    label nCellsNew = 0;
+    {
+        ScratchVector<char> alive(static_cast<std::size_t>(nCellsBg), 0);
+        for (std::size_t f = 0; f < nFacesAll; ++f)
+        {
+            if (finalCell[owner[f]] >= 0) alive[finalCell[owner[f]]] = 1;
+            if (neighbour[f] >= 0 && finalCell[neighbour[f]] >= 0) alive[finalCell[neighbour[f]]] = 1;
+        }
+        for (label c = 0; c < nCellsBg; ++c)
+        {
+            if (alive[c]) newIndex[c] = nCellsNew++;
+        }
+    }
+    if (nCellsNew == 0)
+    {
+        std::cerr << "applyCutCells: no cells left after cutting!\n";
+        std::exit(1);
+    }
+    auto mapCell = [&](label c) { return c < 0 || finalCell[c] < 0 ? label(-1) : newIndex[finalCell[c]]; };
+
+    // 6) 重新编号：合并后同一 cell 两侧的面删去；一侧被删的内部面成为 reflector 上的边界面；
+    //    owner > neighbour 时交换并把顶点反序（首顶点不动）
+    struct FaceRef
+    {
+        std::size_t f;
+        label owner;
+        label neighbour;
+        bool  flip;
+    };
+    std::vector<FaceRef> internal;
+    std::array<std::vector<FaceRef>, 6> boundary;
+    for (std::size_t f = 0; f < nFacesAll; ++f)
+    {
+        label o = mapCell(owner[f]);
+        label n = mapCell(neighbour[f]);
+        if (patch[f] >= 0)
+        {
+            if (o >= 0) boundary[patch[f] == patchCut ? patchReflector : patch[f]].push_back({f, o, -1, false});
+            continue;
+        }
+        if (o == n) continue;
+        if (o < 0 || n < 0)
+        {
+            if (o >= 0) boundary[patchReflector].push_back({f, o, -1, false});
+            else        boundary[patchReflector].push_back({f, n, -1, true});
+            continue;
+        }
+        internal.push_back(o < n ? FaceRef{f, o, n, false} : FaceRef{f, n, o, true});
+    }
+    std::stable_sort(internal.begin(), internal.end(), [](const FaceRef& a, const FaceRef& b)
+    {
+        return a.owner != b.owner ? a.owner < b.owner : a.neighbour < b.neighbour;
+    });
+
+    out.faces.clear();
+    out.faces.reserve(nFacesAll, faces.verts.size());
+    std::vector<label> flipped;
+    auto put = [&](const FaceRef& r)
+    {
+        const auto v = faces[r.f];
+        if (r.flip)
+        {
+            flipped.assign(1, v[0]);
+            flipped.insert(flipped.end(), v.rbegin(), v.rend() - 1);
+            out.faces.push_back(flipped);
+        }
+        else
+        {
+            out.faces.push_back(v);
+        }
+        out.owner.push_back(r.owner);
+    };
+
+    for (const FaceRef& r : internal)
+    {
+        put(r);
+        out.neighbour.push_back(r.neighbour);
+    }
+    label faceStart = static_cast<label>(internal.size());
+    for (int p = 0; p < 6; ++p)
+    {
+        PatchInfo info;
+        info.name      = patchNames[p];
+        info.startFace = faceStart;
+        info.nFaces    = static_cast<label>(boundary[p].size());
+        for (const FaceRef& r : boundary[p]) put(r);
+        faceStart += info.nFaces;
+        out.patches.push_back(info);
+    }
+
+    stage.setCells(static_cast<std::uint64_t>(nCellsNew));
+    stage.setFaces(out.faces.size());
+
+    if (report)
+    {
+        report->nCells   = nCellsNew;
+        report->nCut     = nCut;
+        report->nMerged  = nMerged;
+        report->nDropped = nDropped;
+    }
+
+    std::cout << "applyCutCells: old cells = " << nCellsBg << ", new cells = " << nCellsNew
+              << " (" << nCut << " cut, " << nMerged << " fragments merged, " << nDropped << " dropped)\n";
+    std::cout << "applyCutCells: internal faces new = " << out.neighbour.size()
+              << ", boundary faces = " << (out.faces.size() - out.neighbour.size())
+              << ", new points = " << out.points.size() - nPointsBg << "\n";
+
+    return out;
+}
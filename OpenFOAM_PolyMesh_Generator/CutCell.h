@@ -0,0 +1,35 @@
+#pragma once
+
+#include <functional>
+#include "MeshTypes.h"
+
+// 几何表面的符号距离：<= 0 为计算域内，> 0 为域外。只需在表面附近近似为距离
+// （交点按棱两端的值线性插值），远处只用到符号。会被多线程同时调用。
+using SignedDistanceFunc = std::function<double(const Point&)>;
+
+struct CutCellOptions
+{
+    double snapFraction  = 0.05;   // 交点离棱端点不足该比例棱长时并到端点，避免极短的边
+    double mergeFraction = 0.25;   // 体积小于背景 cell 该比例的切割碎片并入相邻 cell
+};
+
+struct CutCellReport
+{
+    label nCells   = 0;   // 输出的 cell 数
+    label nCut     = 0;   // 被表面穿过、切成多面体的背景 cell 数
+    label nMerged  = 0;   // 并入相邻 cell 的碎片数
+    label nDropped = 0;   // 没有相邻 cell 可并、直接删除的碎片数
+};
+
+// cut-cell 裁剪：背景结构网格中被表面穿过的 cell 切成多面体，表面成为贴体边界。
+// - φ 在背景点上求值一次；每条变号的棱上一个交点（按棱编号共享，相邻 cell 的面完全一致）
+// - 每个面按 φ <= 0 裁剪成多边形，cell 的切割面由各面上的切割线段首尾相接而成，
+//   一个 cell 可有多个切割面（表面在 cell 内不连通时）
+// - 体积小于 mergeFraction 的碎片并入相邻 cell：取共享面在壁面法向上朝域内的投影面积
+//   （-n̂·Sf）最大的一个，投影相同（含都不朝内）时取共享面积大的；不区分相邻 cell 是否也是
+//   碎片，碎片链一起并入链末的非碎片。二者之间的面删去；没有相邻 cell 的碎片删除
+// 切割面进入 reflector patch，背景盒子上的面按位置分到 back / front / bottom / top /
+// reflector / left（与 applyKeepMask 相同）。内部面按 (owner, neighbour) 排序。
+// 与 applyMask 一样先保留全部点（含新交点），由调用方 removeUnusedPoints 清理。
+MeshData applyCutCells(const MeshData& bgMesh, const SignedDistanceFunc& distance,
+                       const CutCellOptions& opts = CutCellOptions(), CutCellReport* report = nullptr);
@@ -0,0 +1,327 @@
+#include "Dictionary.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// ---- 词法 + 递归下降解析 ----
+class DictionaryParser
+{
+public:
+    DictionaryParser(const std::string& text, const std::string& source)
+        : s_(text), source_(source) {}
+
+    Dictionary parseTop()
+    {
+        Dictionary d = parseBody(false);
+        return d;
+    }
+
+private:
+    const std::string& s_;
+    std::string        source_;
+    std::size_t        pos_  = 0;
+    int                line_ = 1;
+
+    [[noreturn]] void fail(const std::string& msg)
+    {
+        std::cerr << "Dictionary " << source_ << ", line " << line_ << ": " << msg << "\n";
+        std::exit(1);
+    }
+
+    void skipSpace()
+    {
+        while (pos_ < s_.size())
+        {
+            char c = s_[pos_];
+            if (c == '\n') { ++line_; ++pos_; }
+            else if (std::isspace(static_cast<unsigned char>(c))) { ++pos_; }
+            else if (c == '/' && pos_ + 1 < s_.size() && s_[pos_ + 1] == '/')
+            {
+                while (pos_ < s_.size() && s_[pos_] != '\n') ++pos_;
+            }
+            else if (c == '/' && pos_ + 1 < s_.size() && s_[pos_ + 1] == '*')
+            {
+                pos_ += 2;
+                while (pos_ + 1 < s_.size() && !(s_[pos_] == '*' && s_[pos_ + 1] == '/'))
+                {
+                    if (s_[pos_] == '\n') ++line_;
+                    ++pos_;
+                }
+                if (pos_ + 1 >= s_.size()) fail("unterminated comment");
+                pos_ += 2;
+            }
+            else break;
+        }
+    }
+
+    // 读一个 token；标点单字符，字符串去掉引号
+    bool next(std::string& tok)
+    {
+        skipSpace();
+        if (pos_ >= s_.size()) return false;
+
+        char c = s_[pos_];
+        if (c == '{' || c == '}' || c == '(' || c == ')' || c == ';')
+        {
+            tok.assign(1, c);
+            ++pos_;
+            return true;
+        }
+        if (c == '"')
+        {
+            std::size_t end = s_.find('"', pos_ + 1);
+            if (end == std::string::npos) fail("unterminated string");
+            tok = s_.substr(pos_ + 1, end - pos_ - 1);
+            pos_ = end + 1;
+            return true;
+        }
+
+        std::size_t b = pos_;
+        while (pos_ < s_.size())
+        {
+            char d = s_[pos_];
+            if (std::isspace(static_cast<unsigned char>(d)) || d == '{' || d == '}' ||
+                d == '(' || d == ')' || d == ';' || d == '"')
+            {
+                break;
+            }
+            if (d == '/' && pos_ + 1 < s_.size() && (s_[pos_ + 1] == '/' || s_[pos_ + 1] == '*'))
+            {
+                break;
+            }
+            ++pos_;
+        }
+        tok = s_.substr(b, pos_ - b);
+        return true;
+    }
+
+    Dictionary parseBody(bool nested)
+    {
+        Dictionary d;
+        d.name_ = source_;
+
+        std::string key;
+        while (next(key))
+        {
+            if (key == "}")
+            {
+                if (!nested) fail("unexpected '}'");
+                return d;
+            }
+            if (key == "{" || key == "(" || key == ")" || key == ";")
+            {
+                fail("unexpected '" + key + "'");
+            }
+            // OpenFOAM 文件头 FoamFile { ... } 直接忽略
+            Dictionary::Entry e;
+            e.key = key;
+
+            std::string tok;
+            if (!next(tok)) fail("missing value for '" + key + "'");
+
+            if (tok == "{")
+            {
+                e.dict.push_back(parseBody(true));
+            }
+            else
+            {
+                int depth = 0;
+                while (true)
+                {
+                    if (tok == "(") ++depth;
+                    if (tok == ")") --depth;
+                    if (depth < 0) fail("unbalanced ')' in '" + key + "'");
+                    if (tok == ";" && depth == 0) break;
+                    if (tok == "{" || tok == "}") fail("unexpected brace in '" + key + "'");
+                    e.tokens.push_back(tok);
+                    if (!next(tok)) fail("missing ';' after '" + key + "'");
+                }
+            }
+
+            if (key != "FoamFile")
+            {
+                d.remove(key);
+                d.entries_.push_back(std::move(e));
+            }
+        }
+
+        if (nested) fail("missing '}'");
+        return d;
+    }
+};
+
+Dictionary Dictionary::readFile(const std::string& filePath)
+{
+    std::ifstream in(filePath);
+    if (!in)
+    {
+        std::cerr << "Cannot open dictionary file " << filePath << "\n";
+        std::exit(1);
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return parse(ss.str(), filePath);
+}
+
+Dictionary Dictionary::parse(const std::string& text, const std::string& sourceName)
+{
+    DictionaryParser p(text, sourceName);
+    return p.parseTop();
+}
+
+const Dictionary::Entry* Dictionary::lookup(const std::string& key) const
+{
+    for (const auto& e : entries_)
+    {
+        if (e.key == key) return &e;
+    }
+    return nullptr;
+}
+
+void Dictionary::fatal(const std::string& key, const std::string& msg) const
+{
+    std::cerr << "Dictionary " << name_ << ": entry '" << key << "' " << msg << "\n";
+    std::exit(1);
+}
+
+bool Dictionary::found(const std::string& key) const
+{
+    return lookup(key) != nullptr;
+}
+
+bool Dictionary::isDict(const std::string& key) const
+{
+    const Entry* e = lookup(key);
+    return e && e->isDict();
+}
+
+const Dictionary& Dictionary::subDict(const std::string& key) const
+{
+    const Entry* e = lookup(key);
+    if (!e) fatal(key, "not found");
+    if (!e->isDict()) fatal(key, "is not a sub-dictionary");
+    return e->dict.front();
+}
+
+const std::vector<std::string>& Dictionary::tokens(const std::string& key) const
+{
+    const Entry* e = lookup(key);
+    if (!e) fatal(key, "not found");
+    if (e->isDict()) fatal(key, "is a sub-dictionary, expected a value");
+    return e->tokens;
+}
+
+std::string Dictionary::getWord(const std::string& key) const
+{
+    const auto& t = tokens(key);
+    if (t.size() != 1) fatal(key, "expected a single word");
+    return t.front();
+}
+
+double Dictionary::getScalar(const std::string& key) const
+{
+    const std::string w = getWord(key);
+    char* end = nullptr;
+    double v = std::strtod(w.c_str(), &end);
+    if (end == w.c_str() || *end != '\0') fatal(key, "is not a number: " + w);
+    return v;
+}
+
+label Dictionary::getLabel(const std::string& key) const
+{
+    const std::string w = getWord(key);
+    char* end = nullptr;
+    long long v = std::strtoll(w.c_str(), &end, 10);
+    if (end == w.c_str() || *end != '\0') fatal(key, "is not an integer: " + w);
+    return static_cast<label>(v);
+}
+
+bool Dictionary::getBool(const std::string& key) const
+{
+    const std::string w = getWord(key);
+    if (w == "true" || w == "on" || w == "yes" || w == "1")  return true;
+    if (w == "false" || w == "off" || w == "no" || w == "0") return false;
+    fatal(key, "is not a switch: " + w);
+}
+
+std::vector<double> Dictionary::getList(const std::string& key) const
+{
+    const auto& t = tokens(key);
+    if (t.size() < 2 || t.front() != "(" || t.back() != ")")
+    {
+        fatal(key, "expected a list (a b c)");
+    }
+    std::vector<double> v;
+    for (std::size_t i = 1; i + 1 < t.size(); ++i)
+    {
+        char* end = nullptr;
+        double x = std::strtod(t[i].c_str(), &end);
+        if (end == t[i].c_str() || *end != '\0') fatal(key, "contains a non-number: " + t[i]);
+        v.push_back(x);
+    }
+    return v;
+}
+
+std::string Dictionary::getWordOrDefault(const std::string& key, const std::string& def) const
+{
+    return found(key) ? getWord(key) : def;
+}
+
+double Dictionary::getScalarOrDefault(const std::string& key, double def) const
+{
+    return found(key) ? getScalar(key) : def;
+}
+
+label Dictionary::getLabelOrDefault(const std::string& key, label def) const
+{
+    return found(key) ? getLabel(key) : def;
+}
+
+bool Dictionary::getBoolOrDefault(const std::string& key, bool def) const
+{
+    return found(key) ? getBool(key) : def;
+}
+
+void Dictionary::merge(const Dictionary& other)
+{
+    for (const auto& e : other.entries_)
+    {
+        remove(e.key);
+        entries_.push_back(e);
+    }
+}
+
+void Dictionary::remove(const std::string& key)
+{
+    for (auto it = entries_.begin(); it != entries_.end(); ++it)
+    {
+        if (it->key == key)
+        {
+            entries_.erase(it);
+            return;
+        }
+    }
+}
+
+std::string Dictionary::toString() const
+{
+    std::string s;
+    for (const auto& e : entries_)
+    {
+        s += e.key;
+        if (e.isDict())
+        {
+            s += " { " + e.dict.front().toString() + "}";
+        }
+        else
+        {
+            for (const auto& t : e.tokens) s += " " + t;
+            s += ";";
+        }
+        s += " ";
+    }
+    return s;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "MeshTypes.h"
+
+// OpenFOAM 风格字典的最小实现，用于 case 文件：
+//
+//   N     (1000 500 1);
+//   mask  { type tubeReflector; tubeEnd 0.5; }
+//
+// 支持 // 与 /* */ 注释、带引号字符串、嵌套子字典。
+// 条目保持文件中的顺序；同名条目后者覆盖前者。
+class Dictionary
+{
+public:
+    struct Entry
+    {
+        std::string              key;
+        std::vector<std::string> tokens;   // 普通条目：';' 之前的全部 token（含括号）
+        std::vector<Dictionary>  dict;     // 子字典条目：恰好一个元素
+        bool isDict() const { return !dict.empty(); }
+    };
+
+    // 读取 / 解析失败时打印错误并退出
+    static Dictionary readFile(const std::string& filePath);
+    static Dictionary parse(const std::string& text, const std::string& sourceName = "string");
+
+    bool found(const std::string& key) const;
+    bool isDict(const std::string& key) const;
+
+    const Dictionary& subDict(const std::string& key) const;
+    const std::vector<std::string>& tokens(const std::string& key) const;
+
+    std::string         getWord  (const std::string& key) const;
+    double              getScalar(const std::string& key) const;
+    label               getLabel (const std::string& key) const;
+    bool                getBool  (const std::string& key) const;
+    std::vector<double> getList  (const std::string& key) const;   // (a b c)
+
+    std::string getWordOrDefault  (const std::string& key, const std::string& def) const;
+    double      getScalarOrDefault(const std::string& key, double def) const;
+    label       getLabelOrDefault (const std::string& key, label def) const;
+    bool        getBoolOrDefault  (const std::string& key, bool def) const;
+
+    // 用 other 的条目覆盖 / 追加到本字典（子字典整体替换）
+    void merge(const Dictionary& other);
+    void remove(const std::string& key);
+
+    const std::vector<Entry>& entries() const { return entries_; }
+
+    // 规范化文本（固定格式），可用来比较或哈希两个字典的内容
+    std::string toString() const;
+
+private:
+    const Entry* lookup(const std::string& key) const;
+    [[noreturn]] void fatal(const std::string& key, const std::string& msg) const;
+
+    std::string        name_;
+    std::vector<Entry> entries_;
+
+    friend class DictionaryParser;
+};
@@ -1,111 +1,219 @@
 
 #include "DomainMask.h"
+#include "MeshGeometry.h"
 #include "StructuredMeshGenerator.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
 
 #include <vector>
 #include <array>
-#include <map>
 #include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <cmath>
+#include <utility>
 
 MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
+{
+    MaskWorkspace ws;
+    return applyMask(bgMesh, std::move(inDomain), ws);
+}
+
+label evaluateRegions(const MeshData& bgMesh, const RegionFunc& region, std::vector<char>& keepCell)
 {
     const int Nx = bgMesh.Nx;
     const int Ny = bgMesh.Ny;
     const int Nz = bgMesh.Nz;
-    const int nCellsOld = Nx * Ny * Nz;
+    const label nCellsOld = label(Nx) * Ny * Nz;
 
-    auto cellIndex = [Nx, Ny](int i, int j, int k) -> int
+    auto cellIndex = [Nx, Ny](int i, int j, int k) -> label
     {
-        return k * (Ny * Nx) + j * Nx + i;
+        return label(k) * Ny * Nx + label(j) * Nx + i;
     };
 
-    auto pointIndex = [Nx, Ny](int i, int j, int k) -> int
+    auto pointIndex = [Nx, Ny](int i, int j, int k) -> label
     {
-        return k * (Ny + 1) * (Nx + 1) + j * (Nx + 1) + i;
+        return label(k) * (Ny + 1) * (Nx + 1) + label(j) * (Nx + 1) + i;
     };
 
     const auto& pts = bgMesh.points;
 
     // 1) 先根据单元中心决定哪些 cell 保留
-    std::vector<char> keepCell(nCellsOld, 0);
-    int newCellCount = 0;
+    keepCell.assign(nCellsOld, 0);
+    label newCellCount = 0;
 
-    for (int k = 0; k < Nz; ++k)
     {
-        for (int j = 0; j < Ny; ++j)
+        ScopedStage maskStage("maskEval");
+        maskStage.setCells(static_cast<std::uint64_t>(nCellsOld));
+
+        for (int k = 0; k < Nz; ++k)
         {
-            for (int i = 0; i < Nx; ++i)
+            for (int j = 0; j < Ny; ++j)
             {
-                int cIdx = cellIndex(i, j, k);
-
-                int p000 = pointIndex(i    , j    , k    );
-                int p100 = pointIndex(i + 1, j    , k    );
-                int p010 = pointIndex(i    , j + 1, k    );
-                int p110 = pointIndex(i + 1, j + 1, k    );
-                int p001 = pointIndex(i    , j    , k + 1);
-                int p101 = pointIndex(i + 1, j    , k + 1);
-                int p011 = pointIndex(i    , j + 1, k + 1);
-                int p111 = pointIndex(i + 1, j + 1, k + 1);
-
-                const Point& a  = pts[p000];
-                const Point& b  = pts[p100];
-                const Point& c1 = pts[p010];
-                const Point& d  = pts[p110];
-                const Point& e  = pts[p001];
-                const Point& f  = pts[p101];
-                const Point& g  = pts[p011];
-                const Point& h  = pts[p111];
-
-                Point c{};
-                c.x = (a.x + b.x + c1.x + d.x + e.x + f.x + g.x + h.x) / 8.0;
-                c.y = (a.y + b.y + c1.y + d.y + e.y + f.y + g.y + h.y) / 8.0;
-                c.z = (a.z + b.z + c1.z + d.z + e.z + f.z + g.z + h.z) / 8.0;
-
-                if (inDomain(c))
+                for (int i = 0; i < Nx; ++i)
                 {
-                    keepCell[cIdx] = 1;
-                    ++newCellCount;
+                    label cIdx = cellIndex(i, j, k);
+
+                    label p000 = pointIndex(i    , j    , k    );
+                    label p100 = pointIndex(i + 1, j    , k    );
+                    label p010 = pointIndex(i    , j + 1, k    );
+                    label p110 = pointIndex(i + 1, j + 1, k    );
+                    label p001 = pointIndex(i    , j    , k + 1);
+                    label p101 = pointIndex(i + 1, j    , k + 1);
+                    label p011 = pointIndex(i    , j + 1, k + 1);
+                    label p111 = pointIndex(i + 1, j + 1, k + 1);
+
+                    const Point& a  = pts[p000];
+                    const Point& b  = pts[p100];
+                    const Point& c1 = pts[p010];
+                    const Point& d  = pts[p110];
+                    const Point& e  = pts[p001];
+                    const Point& f  = pts[p101];
+                    const Point& g  = pts[p011];
+                    const Point& h  = pts[p111];
+
+                    Point c{};
+                    c.x = (a.x + b.x + c1.x + d.x + e.x + f.x + g.x + h.x) / 8.0;
+                    c.y = (a.y + b.y + c1.y + d.y + e.y + f.y + g.y + h.y) / 8.0;
+                    c.z = (a.z + b.z + c1.z + d.z + e.z + f.z + g.z + h.z) / 8.0;
+
+                    const int r = region(c);
+                    if (r < 0 || r > 127)
+                    {
+                        std::cerr << "applyMask: region label " << r << " out of range 0..127\n";
+                        std::exit(1);
+                    }
+                    if (r != 0)
+                    {
+                        keepCell[cIdx] = static_cast<char>(r);
+                        ++newCellCount;
+                    }
                 }
             }
         }
     }
 
+    return newCellCount;
+}
+
+label evaluateMask(const MeshData& bgMesh, const MaskFunc& inDomain, std::vector<char>& keepCell)
+{
+    return evaluateRegions(bgMesh, [&inDomain](const Point& c) { return inDomain(c) ? 1 : 0; }, keepCell);
+}
+
+MeshData applyRegionMask(const MeshData& bgMesh, const RegionFunc& region,
+                         const std::vector<std::string>& regionNames, MaskWorkspace& ws)
+{
+    ScopedStage stage("applyMask");
+
+    evaluateRegions(bgMesh, region, ws.keepCell);
+    MeshData out = applyKeepMask(bgMesh, ws.keepCell, ws, regionNames);
+
+    stage.setCells(static_cast<std::uint64_t>(ws.cellCount));
+    stage.setFaces(out.faces.size());
+    return out;
+}
+
+MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain, MaskWorkspace& ws)
+{
+    ScopedStage stage("applyMask");
+
+    evaluateMask(bgMesh, inDomain, ws.keepCell);
+    MeshData out = applyKeepMask(bgMesh, ws.keepCell, ws);
+
+    stage.setCells(static_cast<std::uint64_t>(ws.cellCount));
+    stage.setFaces(out.faces.size());
+    return out;
+}
+
+MeshData applyKeepMask(const MeshData& bgMesh, const std::vector<char>& keepCell, MaskWorkspace& ws,
+                       const std::vector<std::string>& regionNames)
+{
+    ScratchFrame scratch;   // faceMap 的结点等本函数内的临时结构
+
+    const int Nx = bgMesh.Nx;
+    const int Ny = bgMesh.Ny;
+    const int Nz = bgMesh.Nz;
+    const label nCellsOld = label(Nx) * Ny * Nz;
+
+    auto cellIndex = [Nx, Ny](int i, int j, int k) -> label
+    {
+        return label(k) * Ny * Nx + label(j) * Nx + i;
+    };
+
+    auto pointIndex = [Nx, Ny](int i, int j, int k) -> label
+    {
+        return label(k) * (Ny + 1) * (Nx + 1) + label(j) * (Nx + 1) + i;
+    };
+
+    const auto& pts = bgMesh.points;
+
+    if (static_cast<label>(keepCell.size()) != nCellsOld)
+    {
+        std::cerr << "applyKeepMask: keep mask size " << keepCell.size()
+                  << " does not match background cells " << nCellsOld << "\n";
+        std::exit(1);
+    }
+
+    label newCellCount = 0;
+    for (char k : keepCell)
+    {
+        if (k) ++newCellCount;
+    }
+    ws.cellCount = newCellCount;
+
     if (newCellCount == 0)
     {
         std::cerr << "applyMask: no cells left after masking!\n";
         std::exit(1);
     }
 
+    // 区域掩模：每个区域一个 cellZone，在建立映射时顺带填充
+    const bool withZones = !regionNames.empty();
+    std::vector<CellZone> cellZones(regionNames.size());
+    for (std::size_t r = 0; r < regionNames.size(); ++r)
+    {
+        cellZones[r].name = regionNames[r];
+    }
+    ws.cellRegion.clear();
+
     // 旧 cell -> 新 cell 的映射（压缩编号）
-    std::vector<int> cellMap(nCellsOld, -1);
+    std::vector<label>& cellMap = ws.cellMap;
+    cellMap.assign(nCellsOld, -1);
     {
-        int curIdx = 0;
-        for (int c = 0; c < nCellsOld; ++c)
+        label curIdx = 0;
+        for (label c = 0; c < nCellsOld; ++c)
         {
             if (keepCell[c])
             {
+                if (withZones)
+                {
+                    const int r = keepCell[c];
+                    if (r > static_cast<int>(regionNames.size()))
+                    {
+                        std::cerr << "applyMask: region label " << r << " has no name ("
+                                  << regionNames.size() << " regions)\n";
+                        std::exit(1);
+                    }
+                    cellZones[r - 1].cells.push_back(curIdx);
+                    ws.cellRegion.push_back(keepCell[c]);
+                }
                 cellMap[c] = curIdx++;
             }
         }
     }
 
     // 2) 用保留下来的 cell 重建 faces / owner / neighbour
-    using FaceKey = std::array<int,4>;
+    using FaceKey = Face;
 
-    struct TmpFace
-    {
-        std::array<int,4> verts;
-        int owner = -1;
-        int neighbour = -1;  // -1 表示 boundary face
-    };
+    using TmpFace = MaskWorkspace::TmpFace;
 
-    std::vector<TmpFace> tmpFaces;
-    std::map<FaceKey, int> faceMap;  // key: 排序后的 4 点索引 -> face index
+    std::vector<TmpFace>& tmpFaces = ws.tmpFaces;
+    tmpFaces.clear();
+    ScratchMap<FaceKey, label> faceMap;  // key: 排序后的 4 点索引 -> face index
 
-    auto addFace = [&](int v0, int v1, int v2, int v3, int cellNew)
+    auto addFace = [&](label v0, label v1, label v2, label v3, label cellNew)
     {
         // 按“owner 的朝外法向”顺序保存几何
         TmpFace f;
@@ -119,7 +227,7 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
         if (it == faceMap.end())
         {
             // 第一次见到：作为 owner face
-            int idx = static_cast<int>(tmpFaces.size());
+            label idx = static_cast<label>(tmpFaces.size());
             faceMap[key] = idx;
             f.owner = cellNew;
             f.neighbour = -1;
@@ -128,7 +236,7 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
         else
         {
             // 第二次见到：作为 neighbour
-            int idx = it->second;
+            label idx = it->second;
             if (tmpFaces[idx].neighbour != -1)
             {
                 std::cerr << "applyMask: non-manifold face detected (more than 2 cells share one face)\n";
@@ -139,54 +247,61 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
     };
 
     // 2.1 扫描所有保留的 cell，生成 6 个面
-    for (int k = 0; k < Nz; ++k)
     {
-        for (int j = 0; j < Ny; ++j)
+        ScopedStage emitStage("faceEmission");
+        emitStage.setCells(static_cast<std::uint64_t>(newCellCount));
+
+        for (int k = 0; k < Nz; ++k)
         {
-            for (int i = 0; i < Nx; ++i)
+            for (int j = 0; j < Ny; ++j)
             {
-                int cOld = cellIndex(i, j, k);
-                if (!keepCell[cOld]) continue;
-
-                int cNew = cellMap[cOld];
-
-                int p000 = pointIndex(i    , j    , k    );
-                int p100 = pointIndex(i + 1, j    , k    );
-                int p010 = pointIndex(i    , j + 1, k    );
-                int p110 = pointIndex(i + 1, j + 1, k    );
-                int p001 = pointIndex(i    , j    , k + 1);
-                int p101 = pointIndex(i + 1, j    , k + 1);
-                int p011 = pointIndex(i    , j + 1, k + 1);
-                int p111 = pointIndex(i + 1, j + 1, k + 1);
-
-                // 统一使用“对于该 cell，法向指向外侧”的顶点顺序
-                // 以 cell 盒子 [x0,x1]x[y0,y1]x[z0,z1] 为例：
-                //  xmin: normal 指向 -x
-                //  xmax: normal 指向 +x
-                //  ymin: normal 指向 -y
-                //  ymax: normal 指向 +y
-                //  zmin: normal 指向 -z
-                //  zmax: normal 指向 +z
-
-                // xmin 面 (x = x0)：[p000, p001, p011, p010]
-                addFace(p000, p001, p011, p010, cNew);
-
-                // xmax 面 (x = x1)：[p100, p110, p111, p101]
-                addFace(p100, p110, p111, p101, cNew);
-
-                // ymin 面 (y = y0)：[p000, p100, p101, p001]
-                addFace(p000, p100, p101, p001, cNew);
-
-                // ymax 面 (y = y1)：[p010, p011, p111, p110]
-                addFace(p010, p011, p111, p110, cNew);
-
-                // zmin 面 (z = z0)：[p000, p010, p110, p100]
-                addFace(p000, p010, p110, p100, cNew);
-
-                // zmax 面 (z = z1)：[p001, p101, p111, p011]
-                addFace(p001, p101, p111, p011, cNew);
+                for (int i = 0; i < Nx; ++i)
+                {
+                    label cOld = cellIndex(i, j, k);
+                    if (!keepCell[cOld]) continue;
+
+                    label cNew = cellMap[cOld];
+
+                    label p000 = pointIndex(i    , j    , k    );
+                    label p100 = pointIndex(i + 1, j    , k    );
+                    label p010 = pointIndex(i    , j + 1, k    );
+                    label p110 = pointIndex(i + 1, j + 1, k    );
+                    label p001 = pointIndex(i    , j    , k + 1);
+                    label p101 = pointIndex(i + 1, j    , k + 1);
+                    label p011 = pointIndex(i    , j + 1, k + 1);
+                    label p111 = pointIndex(i + 1, j + 1, k + 1);
+
+                    // 统一使用“对于该 cell，法向指向外侧”的顶点顺序
+                    // 以 cell 盒子 [x0,x1]x[y0,y1]x[z0,z1] 为例：
+                    //  xmin: normal 指向 -x
+                    //  xmax: normal 指向 +x
+                    //  ymin: normal 指向 -y
+                    //  ymax: normal 指向 +y
+                    //  zmin: normal 指向 -z
+                    //  zmax: normal 指向 +z
+
+                    // xmin 面 (x = x0)：[p000, p001, p011, p010]
+                    addFace(p000, p001, p011, p010, cNew);
+
+                    // xmax 面 (x = x1)：[p100, p110, p111, p101]
+                    addFace(p100, p110, p111, p101, cNew);
+
+                    // ymin 面 (y = y0)：[p000, p100, p101, p001]
+                    addFace(p000, p100, p101, p001, cNew);
+
+                    // ymax 面 (y = y1)：[p010, p011, p111, p110]
+                    addFace(p010, p011, p111, p110, cNew);
+
+                    // zmin 面 (z = z0)：[p000, p010, p110, p100]
+                    addFace(p000, p010, p110, p100, cNew);
+
+                    // zmax 面 (z = z1)：[p001, p101, p111, p011]
+                    addFace(p001, p101, p111, p011, cNew);
+                }
             }
         }
+
+        emitStage.setFaces(tmpFaces.size());
     }
 
     // 3) 把 tmpFaces 拆成 internal + boundary
@@ -200,36 +315,49 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
     out.owner.clear();
     out.neighbour.clear();
 
-    out.faces.reserve(tmpFaces.size());
+    out.faces.reserve(tmpFaces.size(), 4 * tmpFaces.size());
     out.owner.reserve(tmpFaces.size());
 
-    // 3.1 先写 internal faces（neighbour != -1）
+    // 3.1 先写 internal faces（neighbour != -1）；区域交界面同时记入 faceZone
+    ScratchMap<std::pair<int,int>, std::size_t> faceZoneOf;
     for (const auto& f : tmpFaces)
     {
         if (f.neighbour != -1)
         {
+            if (withZones)
+            {
+                const int ro = ws.cellRegion[f.owner];
+                const int rn = ws.cellRegion[f.neighbour];
+                if (ro != rn)
+                {
+                    const auto key = std::make_pair(std::min(ro, rn), std::max(ro, rn));
+                    auto it = faceZoneOf.find(key);
+                    if (it == faceZoneOf.end())
+                    {
+                        it = faceZoneOf.emplace(key, out.faceZones.size()).first;
+                        out.faceZones.push_back(FaceZone{
+                            regionNames[key.first - 1] + "_" + regionNames[key.second - 1], {}, {}});
+                    }
+                    FaceZone& z = out.faceZones[it->second];
+                    z.faces.push_back(static_cast<label>(out.faces.size()));
+                    z.flipMap.push_back(ro > rn ? 1 : 0);
+                }
+            }
+
             out.faces.push_back(f.verts);
             out.owner.push_back(f.owner);
             out.neighbour.push_back(f.neighbour);
         }
     }
+    out.cellZones = std::move(cellZones);
 
-    const int nInternalFacesNew = static_cast<int>(out.faces.size());
+    const label nInternalFacesNew = static_cast<label>(out.faces.size());
 
     // 4) boundary faces：neighbour == -1 → 按坐标划分 patch
-    double xmin =  1e30, xmax = -1e30;
-    double ymin =  1e30, ymax = -1e30;
-    double zmin =  1e30, zmax = -1e30;
-
-    for (const auto& p : out.points)
-    {
-        if (p.x < xmin) xmin = p.x;
-        if (p.x > xmax) xmax = p.x;
-        if (p.y < ymin) ymin = p.y;
-        if (p.y > ymax) ymax = p.y;
-        if (p.z < zmin) zmin = p.z;
-        if (p.z > zmax) zmax = p.z;
-    }
+    //    背景是结构网格：包围盒即第一个点 (0,0,0) 与最后一个点 (Nx,Ny,Nz)，不必扫描所有点
+    const double xmin = pts.front().x, xmax = pts.back().x;
+    const double ymin = pts.front().y, ymax = pts.back().y;
+    const double zmin = pts.front().z, zmax = pts.back().z;
 
     double Lx = xmax - xmin;
     double Ly = ymax - ymin;
@@ -238,10 +366,17 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
     if (L <= 0.0) L = 1.0;
     double tol = 1e-8 * L;
 
-    std::vector<std::array<int,4>> facesBack, facesFront, facesBottom, facesTop, facesReflector, facesLeft;
-    std::vector<int> ownerBack, ownerFront, ownerBottom, ownerTop, ownerReflector, ownerLeft;
+    for (auto& v : ws.patchFaces) v.clear();
+    for (auto& v : ws.patchOwner) v.clear();
 
-    auto classifyFace = [&](const std::array<int,4>& fPts, int own)
+    auto& facesBack      = ws.patchFaces[0];  auto& ownerBack      = ws.patchOwner[0];
+    auto& facesFront     = ws.patchFaces[1];  auto& ownerFront     = ws.patchOwner[1];
+    auto& facesBottom    = ws.patchFaces[2];  auto& ownerBottom    = ws.patchOwner[2];
+    auto& facesTop       = ws.patchFaces[3];  auto& ownerTop       = ws.patchOwner[3];
+    auto& facesReflector = ws.patchFaces[4];  auto& ownerReflector = ws.patchOwner[4];
+    auto& facesLeft      = ws.patchFaces[5];  auto& ownerLeft      = ws.patchOwner[5];
+
+    auto classifyFace = [&](const Face& fPts, label own)
     {
         Point fc{};
         for (int k = 0; k < 4; ++k)
@@ -293,95 +428,327 @@ MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain)
         }
     };
 
-    for (const auto& f : tmpFaces)
     {
-        if (f.neighbour == -1)
+        ScopedStage classifyStage("patchClassification");
+        classifyStage.setFaces(tmpFaces.size() - nInternalFacesNew);
+
+        for (const auto& f : tmpFaces)
         {
-            classifyFace(f.verts, f.owner);
+            if (f.neighbour == -1)
+            {
+                classifyFace(f.verts, f.owner);
+            }
         }
     }
 
     // 5) 追加 boundary faces（顺序：back -> front -> bottom -> top -> reflector -> left）
-    int faceStart = nInternalFacesNew;
+    static const char* const patchNames[6] = {"back", "front", "bottom", "top", "reflector", "left"};
 
-    // back
-    out.startFaceBack = faceStart;
-    out.nFacesBack    = static_cast<int>(facesBack.size());
-    for (size_t i = 0; i < facesBack.size(); ++i)
+    label faceStart = nInternalFacesNew;
+    out.patches.clear();
+    for (int p = 0; p < 6; ++p)
     {
-        out.faces.push_back(facesBack[i]);
-        out.owner.push_back(ownerBack[i]);
+        const auto& pFaces = ws.patchFaces[p];
+        const auto& pOwner = ws.patchOwner[p];
+
+        PatchInfo patch;
+        patch.name      = patchNames[p];
+        patch.startFace = faceStart;
+        patch.nFaces    = static_cast<label>(pFaces.size());
+        for (size_t i = 0; i < pFaces.size(); ++i)
+        {
+            out.faces.push_back(pFaces[i]);
+            out.owner.push_back(pOwner[i]);
+        }
+        faceStart += patch.nFaces;
+        out.patches.push_back(patch);
     }
-    faceStart += out.nFacesBack;
 
-    // front
-    out.startFaceFront = faceStart;
-    out.nFacesFront    = static_cast<int>(facesFront.size());
-    for (size_t i = 0; i < facesFront.size(); ++i)
+    // neighbour 只对应 internal faces
+    if (static_cast<label>(out.neighbour.size()) != nInternalFacesNew)
     {
-        out.faces.push_back(facesFront[i]);
-        out.owner.push_back(ownerFront[i]);
+        std::cerr << "applyMask: neighbour size mismatch\n";
+        std::exit(1);
     }
-    faceStart += out.nFacesFront;
 
-    // bottom
-    out.startFaceBottom = faceStart;
-    out.nFacesBottom    = static_cast<int>(facesBottom.size());
-    for (size_t i = 0; i < facesBottom.size(); ++i)
+    if (out.faces.size() != out.owner.size())
     {
-        out.faces.push_back(facesBottom[i]);
-        out.owner.push_back(ownerBottom[i]);
+        std::cerr << "applyMask: faces/owner size mismatch\n";
+        std::exit(1);
     }
-    faceStart += out.nFacesBottom;
 
-    // top
-    out.startFaceTop = faceStart;
-    out.nFacesTop    = static_cast<int>(facesTop.size());
-    for (size_t i = 0; i < facesTop.size(); ++i)
+    std::cout << "applyMask: old cells = " << nCellsOld
+              << ", new cells = " << newCellCount << "\n";
+    std::cout << "applyMask: internal faces new = " << nInternalFacesNew
+              << ", boundary faces = "
+              << (out.faces.size() - nInternalFacesNew) << "\n";
+
+    return out;
+}
+
+MeshData applyMaskPolyMesh(const MeshData& mesh, const MaskFunc& inDomain, const std::string& cutPatch)
+{
+    ScopedStage stage("applyMaskPolyMesh");
+
+    const std::size_t nFaces    = mesh.faces.size();
+    const std::size_t nInternal = mesh.neighbour.size();
+    const auto& pts = mesh.points;
+
+    if (mesh.owner.size() != nFaces || nInternal > nFaces)
     {
-        out.faces.push_back(facesTop[i]);
-        out.owner.push_back(ownerTop[i]);
+        std::cerr << "applyMaskPolyMesh: owner / neighbour sizes do not match faces\n";
+        std::exit(1);
     }
-    faceStart += out.nFacesTop;
 
-    // reflector -> 用 Right 字段
-    out.startFaceRight = faceStart;
-    out.nFacesRight    = static_cast<int>(facesReflector.size());
-    for (size_t i = 0; i < facesReflector.size(); ++i)
+    // 边界面必须被 patch 连续、按顺序覆盖；facePatch 为每个边界面所在 patch
+    const int nPatches = static_cast<int>(mesh.patches.size());
     {
-        out.faces.push_back(facesReflector[i]);
-        out.owner.push_back(ownerReflector[i]);
+        std::size_t next = nInternal;
+        for (const PatchInfo& p : mesh.patches)
+        {
+            if (static_cast<std::size_t>(p.startFace) != next)
+            {
+                std::cerr << "applyMaskPolyMesh: patch " << p.name << " starts at face "
+                          << p.startFace << ", expected " << next << "\n";
+                std::exit(1);
+            }
+            next += static_cast<std::size_t>(p.nFaces);
+        }
+        if (next != nFaces)
+        {
+            std::cerr << "applyMaskPolyMesh: patches cover " << next - nInternal
+                      << " of " << nFaces - nInternal << " boundary faces\n";
+            std::exit(1);
+        }
     }
-    faceStart += out.nFacesRight;
 
-    // left
-    out.startFaceLeft = faceStart;
-    out.nFacesLeft    = static_cast<int>(facesLeft.size());
-    for (size_t i = 0; i < facesLeft.size(); ++i)
+    // cell 数取 owner 与 neighbour 中的最大编号 + 1：只作为 neighbour 出现的内部 cell
+    // （如重新编号后）同样要计入
+    label nCellsOld = 0;
+    label minCell   = 0;
+    for (label c : mesh.owner)     { nCellsOld = std::max(nCellsOld, c + 1); minCell = std::min(minCell, c); }
+    for (label c : mesh.neighbour) { nCellsOld = std::max(nCellsOld, c + 1); minCell = std::min(minCell, c); }
+    if (minCell < 0)
     {
-        out.faces.push_back(facesLeft[i]);
-        out.owner.push_back(ownerLeft[i]);
+        std::cerr << "applyMaskPolyMesh: negative cell index " << minCell << " in owner / neighbour\n";
+        std::exit(1);
     }
-    faceStart += out.nFacesLeft;
 
-    // neighbour 只对应 internal faces
-    if (static_cast<int>(out.neighbour.size()) != nInternalFacesNew)
+    // 1) cell -> face CSR，随后逐单元求中心并求值掩模
+    ScratchFrame scratch;
+    ScratchVector<std::size_t> cellStart;
+    ScratchVector<label>       cellFaces;
+    ScratchVector<char>        keepCell(nCellsOld, 0);
     {
-        std::cerr << "applyMask: neighbour size mismatch\n";
-        std::exit(1);
+        ScopedStage maskStage("maskEval");
+        maskStage.setCells(static_cast<std::uint64_t>(nCellsOld));
+
+        buildCellFaces(mesh, static_cast<std::size_t>(nCellsOld), cellStart, cellFaces);
+
+        // 单元中心 = 各面顶点的平均（六面体上等于 8 个顶点的平均）
+        parallelFor(static_cast<std::size_t>(nCellsOld), [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t c = b; c < e; ++c)
+            {
+                const label* fb = cellFaces.data() + cellStart[c];
+                const label* fe = cellFaces.data() + cellStart[c + 1];
+                if (fb == fe) continue;
+
+                Point cc{};
+                std::size_t nv = 0;
+                for (const label* f = fb; f != fe; ++f)
+                {
+                    for (label v : mesh.faces[*f])
+                    {
+                        cc.x += pts[v].x;
+                        cc.y += pts[v].y;
+                        cc.z += pts[v].z;
+                    }
+                    nv += mesh.faces.faceSize(static_cast<std::size_t>(*f));
+                }
+                const double w = 1.0 / static_cast<double>(nv);
+                cc.x *= w;
+                cc.y *= w;
+                cc.z *= w;
+
+                keepCell[c] = inDomain(cc) ? 1 : 0;
+            }
+        }, 1024);
     }
 
-    if (out.faces.size() != out.owner.size())
+    // 2) 旧 cell -> 新 cell 的映射（压缩编号）
+    ScratchVector<label> cellMap(nCellsOld, -1);
+    label newCellCount = 0;
+    for (label c = 0; c < nCellsOld; ++c)
     {
-        std::cerr << "applyMask: faces/owner size mismatch\n";
+        if (keepCell[c]) cellMap[c] = newCellCount++;
+    }
+
+    if (newCellCount == 0)
+    {
+        std::cerr << "applyMaskPolyMesh: no cells left after masking!\n";
         std::exit(1);
     }
 
-    std::cout << "applyMask: old cells = " << nCellsOld
+    // 3) 每个面归入一个输出桶：0 = internal，其后依次为各 patch；
+    //    cut 面的桶紧跟在同名 patch 之后（无同名 patch 时排在最后），-1 表示丢弃
+    int cutAfter = nPatches;
+    for (int p = 0; p < nPatches; ++p)
+    {
+        if (mesh.patches[p].name == cutPatch) cutAfter = p;
+    }
+    const int nBuckets = nPatches + 2;
+    const int cutBucket = cutAfter + 2 - (cutAfter == nPatches ? 1 : 0);
+    auto patchBucket = [cutAfter](int p) { return 1 + p + (p > cutAfter ? 1 : 0); };
+
+    ScratchVector<int>  faceBucket(nFaces);
+    ScratchVector<char> faceFlip(nFaces, 0);
+    {
+        ScratchVector<int> facePatch(nFaces - nInternal);
+        for (int p = 0; p < nPatches; ++p)
+        {
+            const PatchInfo& pi = mesh.patches[p];
+            std::fill_n(facePatch.begin() + (pi.startFace - nInternal), pi.nFaces, p);
+        }
+
+        parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t f = b; f < e; ++f)
+            {
+                const bool own = keepCell[mesh.owner[f]] != 0;
+                if (f >= nInternal)
+                {
+                    faceBucket[f] = own ? patchBucket(facePatch[f - nInternal]) : -1;
+                    continue;
+                }
+
+                const bool nei = keepCell[mesh.neighbour[f]] != 0;
+                if (own && nei)       faceBucket[f] = 0;
+                else if (own || nei)  faceBucket[f] = cutBucket;
+                else                  faceBucket[f] = -1;
+                faceFlip[f] = !own && nei;
+            }
+        });
+    }
+
+    // 4) 计数 + 前缀和：每块、每桶的写入起点，稳定且线性
+    const unsigned nChunks = parallelChunkCount(nFaces);
+    ScratchVector<std::size_t> chunkCount(static_cast<std::size_t>(nChunks) * nBuckets, 0);
+    parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::size_t* cnt = chunkCount.data() + static_cast<std::size_t>(chunk) * nBuckets;
+        for (std::size_t f = b; f < e; ++f)
+        {
+            if (faceBucket[f] >= 0) ++cnt[faceBucket[f]];
+        }
+    });
+
+    ScratchVector<std::size_t> bucketStart(nBuckets + 1, 0);
+    ScratchVector<std::size_t> chunkStart(chunkCount.size());
+    for (int k = 0; k < nBuckets; ++k)
+    {
+        std::size_t pos = bucketStart[k];
+        for (unsigned ch = 0; ch < nChunks; ++ch)
+        {
+            chunkStart[static_cast<std::size_t>(ch) * nBuckets + k] = pos;
+            pos += chunkCount[static_cast<std::size_t>(ch) * nBuckets + k];
+        }
+        bucketStart[k + 1] = pos;
+    }
+
+    const std::size_t nFacesNew    = bucketStart[nBuckets];
+    const std::size_t nInternalNew = bucketStart[1];
+
+    MeshData out;
+    out.Nx = out.Ny = out.Nz = 0;
+    out.points = mesh.points;  // 先保留所有点（unused points 可以以后再清）
+    out.faces.offsets.assign(nFacesNew + 1, 0);
+    out.owner.resize(nFacesNew);
+    out.neighbour.resize(nInternalNew);
+
+    {
+        ScopedStage emitStage("faceEmission");
+        emitStage.setFaces(nFacesNew);
+
+        // 先定每个面的新位置并记下顶点数，偏移表前缀和之后再拷贝顶点
+        ScratchVector<std::size_t> faceDest(nFaces);
+        parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned chunk)
+        {
+            std::size_t* pos = chunkStart.data() + static_cast<std::size_t>(chunk) * nBuckets;
+            for (std::size_t f = b; f < e; ++f)
+            {
+                const int k = faceBucket[f];
+                if (k < 0) continue;
+
+                const std::size_t i = pos[k]++;
+                faceDest[f] = i;
+                out.faces.offsets[i + 1] = static_cast<label>(mesh.faces.faceSize(f));
+                // owner 被删：原 neighbour 成为 owner
+                out.owner[i] = cellMap[faceFlip[f] ? mesh.neighbour[f] : mesh.owner[f]];
+                if (k == 0)
+                {
+                    out.neighbour[i] = cellMap[mesh.neighbour[f]];
+                }
+            }
+        });
+
+        for (std::size_t i = 0; i < nFacesNew; ++i)
+        {
+            out.faces.offsets[i + 1] += out.faces.offsets[i];
+        }
+        out.faces.verts.resize(static_cast<std::size_t>(out.faces.offsets[nFacesNew]));
+
+        parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t f = b; f < e; ++f)
+            {
+                if (faceBucket[f] < 0) continue;
+
+                const auto v = mesh.faces[f];
+                const auto d = out.faces[faceDest[f]];
+                if (faceFlip[f])
+                {
+                    // 顶点反序（首顶点不动）使法向朝外
+                    d[0] = v[0];
+                    std::reverse_copy(v.begin() + 1, v.end(), d.begin() + 1);
+                }
+                else
+                {
+                    std::copy(v.begin(), v.end(), d.begin());
+                }
+            }
+        });
+    }
+
+    // 5) patch 表：原 patch 依次保留，cut 面并入同名 patch 或追加新 patch
+    for (int p = 0; p < nPatches; ++p)
+    {
+        PatchInfo patch = mesh.patches[p];
+        const int k = patchBucket(p);
+        patch.startFace = static_cast<label>(bucketStart[k]);
+        patch.nFaces    = static_cast<label>(bucketStart[k + 1] - bucketStart[k]);
+        if (p == cutAfter)
+        {
+            patch.nFaces += static_cast<label>(bucketStart[cutBucket + 1] - bucketStart[cutBucket]);
+        }
+        out.patches.push_back(patch);
+    }
+    if (cutAfter == nPatches)
+    {
+        PatchInfo patch;
+        patch.name      = cutPatch;
+        patch.startFace = static_cast<label>(bucketStart[cutBucket]);
+        patch.nFaces    = static_cast<label>(bucketStart[cutBucket + 1] - bucketStart[cutBucket]);
+        out.patches.push_back(patch);
+    }
+
+    stage.setCells(static_cast<std::uint64_t>(newCellCount));
+    stage.setFaces(nFacesNew);
+
+    std::cout << "applyMaskPolyMesh: old cells = " << nCellsOld
               << ", new cells = " << newCellCount << "\n";
-    std::cout << "applyMask: internal faces new = " << nInternalFacesNew
-              << ", boundary faces = "
-              << (out.faces.size() - nInternalFacesNew) << "\n";
+    std::cout << "applyMaskPolyMesh: internal faces new = " << nInternalNew
+              << ", boundary faces = " << (nFacesNew - nInternalNew) << "\n";
 
     return out;
 }
@@ -1,13 +1,70 @@
 
 #pragma once
 
+#include <array>
 #include <functional>
+#include <string>
+#include <vector>
 #include "MeshTypes.h"
 
 // 掩模函数：给单元中心点，返回是否在计算域中
 using MaskFunc = std::function<bool(const Point& cellCenter)>;
 
+// 区域掩模：返回 0 表示删除，1..127 为区域编号（如 driver / driven / reflector）
+using RegionFunc = std::function<int(const Point& cellCenter)>;
+
 // 对背景规则网格应用掩模，返回裁剪后的非结构网格
 // - bgMesh: 由 StructuredMeshGenerator 生成的完整盒子网格
 // - inDomain: 掩模函数，true 表示该单元被保留
 MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain);
+
+// applyMask 的临时缓冲区。批量运行时每个工作线程持有一个并在多个 case 间复用，
+// 每次调用只清空内容、保留容量，避免反复分配大数组。
+struct MaskWorkspace
+{
+    struct TmpFace
+    {
+        Face  verts;
+        label owner = -1;
+        label neighbour = -1;  // -1 表示 boundary face
+    };
+
+    std::vector<char>    keepCell;        // 0 = 删除，否则为区域编号（普通掩模为 1）
+    label                cellCount = 0;   // 最近一次裁剪保留的 cell 数
+    std::vector<label>   cellMap;
+    std::vector<char>    cellRegion;      // 新 cell 的区域编号（只在写 zone 时使用）
+    std::vector<TmpFace> tmpFaces;
+
+    // 各 patch 的边界面（back, front, bottom, top, reflector, left）
+    std::array<std::vector<Face>, 6> patchFaces;
+    std::array<std::vector<label>, 6>             patchOwner;
+};
+
+MeshData applyMask(const MeshData& bgMesh, MaskFunc inDomain, MaskWorkspace& ws);
+
+// applyMask 拆成的两步，便于缓存 / 复用中间结果：
+// - evaluateMask: 只在单元中心求值掩模，keepCell[c] = 1 表示保留，返回保留数
+// - applyKeepMask: 按已有的 keepCell 位图重建 faces / owner / neighbour / patch
+//   regionNames 非空时 keepCell 为区域编号，区域 r 的 cell 组成名为 regionNames[r-1] 的
+//   cellZone，两侧区域不同的内部面组成 faceZone "<低编号区域>_<高编号区域>"
+//   （flipMap 使 zone 法向从低编号指向高编号）；zone 在同一遍扫描中顺带生成
+label evaluateMask(const MeshData& bgMesh, const MaskFunc& inDomain, std::vector<char>& keepCell);
+MeshData applyKeepMask(const MeshData& bgMesh, const std::vector<char>& keepCell, MaskWorkspace& ws,
+                       const std::vector<std::string>& regionNames = {});
+
+// evaluateMask 的区域版本：keepCell[c] 为区域编号，返回保留数
+label evaluateRegions(const MeshData& bgMesh, const RegionFunc& region, std::vector<char>& keepCell);
+
+// evaluateRegions + applyKeepMask(regionNames)
+MeshData applyRegionMask(const MeshData& bgMesh, const RegionFunc& region,
+                         const std::vector<std::string>& regionNames, MaskWorkspace& ws);
+
+// 对任意六面体 polyMesh（blockMesh 输出、多块或弯曲网格，可由 readPolyMesh 读入）应用掩模，
+// 不依赖 Nx/Ny/Nz 的 i/j/k 排布：
+// - 一次并行遍历建立 cell -> face CSR，并由面心平均得到单元中心（inDomain 会被多线程调用）
+// - 两侧都保留的内部面仍为内部面；只保留一侧的成为 cutPatch 上的新边界面（owner 被删时翻转）
+// - 原有 patch 保留 owner 仍在的面；cutPatch 与已有 patch 同名时并入该 patch，否则追加在最后
+// 单元与面按计数 + 前缀和线性压缩，相对顺序不变（上三角排序得以保持）。
+// 与 applyMask 一样先保留全部点，由调用方 removeUnusedPoints 清理。
+MeshData applyMaskPolyMesh(const MeshData& mesh, const MaskFunc& inDomain,
+                           const std::string& cutPatch = "reflector");
@@ -0,0 +1,119 @@
+#include "FieldWriter.h"
+#include "FoamHeader.h"
+#include "Profiler.h"
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+
+// uniform 值：标量写 v，矢量写 (x y z)
+void writeUniform(std::ostream& out, const double* v, int nComponents)
+{
+    if (nComponents == 1)
+    {
+        out << v[0];
+        return;
+    }
+    out << "(";
+    for (int i = 0; i < nComponents; ++i)
+    {
+        out << (i ? " " : "") << v[i];
+    }
+    out << ")";
+}
+
+} // namespace
+
+std::string timeDirectory(const std::string& polyMeshDir, const std::string& time)
+{
+    std::filesystem::path p(polyMeshDir);
+    if (p.filename().empty()) p = p.parent_path();   // 末尾的 '/'
+
+    std::filesystem::path caseDir = p.parent_path();
+    if (caseDir.filename() == "constant")
+    {
+        caseDir = caseDir.parent_path();
+    }
+    return (caseDir / time).string();
+}
+
+void writeVolField(const MeshData& mesh, const std::string& timeDir, const VolField& field)
+{
+    ScopedStage stage("writeField");
+
+    const int nc = field.nComponents;
+    if ((nc != 1 && nc != 3) || field.values.empty() || field.values.size() % nc != 0)
+    {
+        std::cerr << "writeVolField: field " << field.name << " has " << field.values.size()
+                  << " values for " << nc << " component(s)\n";
+        std::exit(1);
+    }
+    const bool uniform = field.values.size() == static_cast<std::size_t>(nc);
+    stage.setCells(uniform ? 0 : field.values.size() / nc);
+
+    std::filesystem::create_directories(timeDir);
+
+    const std::string path = timeDir + "/" + field.name;
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Cannot open " << path << " for writing.\n";
+        std::exit(1);
+    }
+    out.precision(17);
+
+    out << foamHeader(nc == 1 ? "volScalarField" : "volVectorField",
+                      std::filesystem::path(timeDir).filename().string(), field.name, true);
+    out << "dimensions      " << field.dimensions << ";\n\n";
+
+    if (uniform)
+    {
+        out << "internalField   uniform ";
+        writeUniform(out, field.values.data(), nc);
+        out << ";\n\n";
+    }
+    else
+    {
+        out << "internalField   nonuniform List<" << (nc == 1 ? "scalar" : "vector") << "> "
+            << field.values.size() / nc << "\n(";
+        out.write(reinterpret_cast<const char*>(field.values.data()),
+                  static_cast<std::streamsize>(field.values.size() * sizeof(double)));
+        out << ")\n;\n\n";
+    }
+
+    out << "boundaryField\n{\n";
+    for (const PatchInfo& p : mesh.patches)
+    {
+        auto it = field.patchBoundary.find(p.name);
+        const std::string& type = it != field.patchBoundary.end() ? it->second : field.defaultBoundary;
+
+        out << "    " << p.name << "\n    {\n"
+            << "        type            " << type << ";\n";
+        if (type == "fixedValue" || type == "calculated")
+        {
+            out << "        value           uniform ";
+            writeUniform(out, field.boundaryValue.data(), nc);
+            out << ";\n";
+        }
+        out << "    }\n";
+    }
+    out << "}\n\n";
+
+    stage.setBytes(static_cast<std::uint64_t>(out.tellp()));
+}
+
+void writeVolScalarField(const MeshData& mesh, const std::string& timeDir,
+                         const std::string& name, std::span<const double> values,
+                         const std::string& dimensions, const std::string& boundaryType)
+{
+    VolField f;
+    f.name            = name;
+    f.dimensions      = dimensions;
+    f.values.assign(values.begin(), values.end());
+    f.defaultBoundary = boundaryType;
+    writeVolField(mesh, timeDir, f);
+}
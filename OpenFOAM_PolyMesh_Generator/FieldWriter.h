@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+
+// polyMesh 目录所在 case 的时间目录：<case>/constant/polyMesh -> <case>/<time>；
+// 不在 constant/ 下时取 polyMesh 目录的上一级
+std::string timeDirectory(const std::string& polyMeshDir, const std::string& time = "0");
+
+// 一个待写出的体场（volScalarField / volVectorField）
+struct VolField
+{
+    std::string name;
+    std::string dimensions  = "[0 0 0 0 0 0 0]";
+    int         nComponents = 1;          // 1: scalar，3: vector
+
+    // 恰好 nComponents 个值时写成 uniform，否则为每 cell nComponents 个值（nonuniform）
+    std::vector<double> values;
+
+    // 边界条件存根：每个 patch 一个 type；fixedValue / calculated 附 value uniform boundaryValue
+    std::string                        defaultBoundary = "zeroGradient";
+    std::map<std::string, std::string> patchBoundary;   // patch 名 -> type，覆盖默认
+    std::array<double,3>               boundaryValue{};
+};
+
+// 写二进制体场到 timeDir/field.name
+void writeVolField(const MeshData& mesh, const std::string& timeDir, const VolField& field);
+
+// 写二进制 volScalarField：internalField 为每个 cell 一个值，
+// 所有 patch 的边界条件为 boundaryType（如 zeroGradient）
+void writeVolScalarField(const MeshData& mesh, const std::string& timeDir,
+                         const std::string& name, std::span<const double> values,
+                         const std::string& dimensions = "[0 0 0 0 0 0 0]",
+                         const std::string& boundaryType = "zeroGradient");
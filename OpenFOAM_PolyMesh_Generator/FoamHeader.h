@@ -0,0 +1,31 @@
+#pragma once
+
+#include <string>
+#include "MeshTypes.h"
+
+// OpenFOAM 文件头（FoamFile 字典 + 分隔线）。
+// 二进制格式额外写 arch，标明字节序与 label / scalar 位宽。
+inline std::string foamHeader(const std::string& cls,
+                              const std::string& location,
+                              const std::string& object,
+                              bool binary)
+{
+    std::string h =
+"FoamFile\n"
+"{\n"
+"    version     2.0;\n";
+    h += binary ? "    format      binary;\n" : "    format      ascii;\n";
+    if (binary)
+    {
+        h += "    arch        \"LSB;label=" + std::to_string(8 * sizeof(label)) + ";scalar=64\";\n";
+    }
+    h += "    class       " + cls + ";\n";
+    h += "    location    \"" + location + "\";\n";
+    h += "    object      " + object + ";\n";
+    h +=
+"}\n"
+"\n"
+"// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * //\n"
+"\n";
+    return h;
+}
@@ -0,0 +1,313 @@
+#include "GzipStream.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <zlib.h>
+
+namespace
+{
+
+constexpr std::size_t kBlockSize  = 1u << 20;   // 每块 1 MiB 未压缩数据
+constexpr std::size_t kDictSize   = 32768;      // deflate 窗口大小
+
+// raw deflate 一块（前面拼上 dict 作为窗口），以 Z_SYNC_FLUSH 字节对齐结束
+void deflateBlock(const char* data, std::size_t n, const char* dict, std::size_t dictLen,
+                  int level, int flush, std::vector<unsigned char>& out)
+{
+    z_stream zs{};
+    deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (dictLen > 0)
+    {
+        deflateSetDictionary(&zs, reinterpret_cast<const Bytef*>(dict), static_cast<uInt>(dictLen));
+    }
+
+    out.resize(deflateBound(&zs, static_cast<uLong>(n)) + 16);
+    zs.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs.avail_in  = static_cast<uInt>(n);
+    zs.next_out  = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    for (;;)
+    {
+        deflate(&zs, flush);
+        if (zs.avail_out != 0) break;
+        const std::size_t done = zs.total_out;
+        out.resize(out.size() * 2);
+        zs.next_out  = out.data() + done;
+        zs.avail_out = static_cast<uInt>(out.size() - done);
+    }
+    out.resize(zs.total_out);
+    deflateEnd(&zs);
+}
+
+void putLE32(unsigned char* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) p[i] = static_cast<unsigned char>(v >> (8 * i));
+}
+
+} // namespace
+
+GzipStreamBuf::GzipStreamBuf(const std::string& path, int level)
+    : level_(level)
+{
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_)
+    {
+        return;
+    }
+
+    // gzip member header：deflate、无文件名、mtime 0（输出可复现）、OS = Unix
+    static const unsigned char header[10] = {0x1f, 0x8b, 8, 0, 0, 0, 0, 0, 0, 3};
+    writeFailed_ = std::fwrite(header, 1, sizeof header, file_) != sizeof header;
+    compressedBytes_ = sizeof header;
+
+    current_.resize(kBlockSize);
+    setp(current_.data(), current_.data() + current_.size());
+}
+
+GzipStreamBuf::~GzipStreamBuf()
+{
+    close();
+}
+
+GzipStreamBuf::int_type GzipStreamBuf::overflow(int_type ch)
+{
+    if (!file_)
+    {
+        return traits_type::eof();
+    }
+    finishBlock();
+    if (!traits_type::eq_int_type(ch, traits_type::eof()))
+    {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize GzipStreamBuf::xsputn(const char* s, std::streamsize n)
+{
+    if (!file_)
+    {
+        return 0;
+    }
+    std::streamsize done = 0;
+    while (done < n)
+    {
+        if (pptr() == epptr())
+        {
+            finishBlock();
+        }
+        const std::streamsize chunk = std::min<std::streamsize>(n - done, epptr() - pptr());
+        std::memcpy(pptr(), s + done, static_cast<std::size_t>(chunk));
+        pbump(static_cast<int>(chunk));
+        done += chunk;
+    }
+    return done;
+}
+
+GzipStreamBuf::pos_type GzipStreamBuf::seekoff(off_type off, std::ios_base::seekdir dir,
+                                               std::ios_base::openmode which)
+{
+    // 只支持 tellp：返回已写入的未压缩字节数
+    if (off != 0 || dir != std::ios_base::cur || !(which & std::ios_base::out))
+    {
+        return pos_type(off_type(-1));
+    }
+    std::uint64_t queued = 0;
+    for (const Block& b : pending_) queued += b.data.size();
+    return pos_type(static_cast<off_type>(totalQueued_ + queued + (pptr() - pbase())));
+}
+
+void GzipStreamBuf::finishBlock()
+{
+    const std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+    if (n > 0)
+    {
+        Block b;
+        b.data = std::move(current_);
+        b.data.resize(n);
+        pending_.push_back(std::move(b));
+
+        current_.assign(kBlockSize, 0);
+    }
+    setp(current_.data(), current_.data() + current_.size());
+
+    if (pending_.size() >= std::max(2u, parallelThreadCount()))
+    {
+        launchBatch();
+    }
+}
+
+void GzipStreamBuf::launchBatch()
+{
+    joinBatch();
+    if (pending_.empty())
+    {
+        return;
+    }
+
+    for (const Block& b : pending_) totalQueued_ += b.data.size();
+
+    inFlight_ = std::move(pending_);
+    pending_.clear();
+
+    // 本批第一块的字典来自上一批最后一块；先取出再更新，后台线程只读自己的副本
+    std::vector<char> firstDict = std::move(dictionary_);
+    const std::vector<char>& last = inFlight_.back().data;
+    const std::size_t tail = std::min(kDictSize, last.size());
+    dictionary_.assign(last.end() - static_cast<std::ptrdiff_t>(tail), last.end());
+
+    worker_ = std::thread([this, firstDict = std::move(firstDict)]()
+    {
+        parallelFor(inFlight_.size(), [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t i = b; i < e; ++i)
+            {
+                Block& blk = inFlight_[i];
+                const char* dict = firstDict.data();
+                std::size_t dictLen = firstDict.size();
+                if (i > 0)
+                {
+                    const std::vector<char>& prev = inFlight_[i - 1].data;
+                    dictLen = std::min(kDictSize, prev.size());
+                    dict    = prev.data() + prev.size() - dictLen;
+                }
+                deflateBlock(blk.data.data(), blk.data.size(), dict, dictLen, level_, Z_SYNC_FLUSH, blk.out);
+                blk.crc = static_cast<std::uint32_t>(
+                    crc32(0, reinterpret_cast<const Bytef*>(blk.data.data()), static_cast<uInt>(blk.data.size())));
+            }
+        }, 1);
+
+        for (const Block& blk : inFlight_)
+        {
+            if (std::fwrite(blk.out.data(), 1, blk.out.size(), file_) != blk.out.size())
+            {
+                writeFailed_ = true;
+            }
+            compressedBytes_ += blk.out.size();
+            crc_ = static_cast<std::uint32_t>(
+                crc32_combine(crc_, blk.crc, static_cast<z_off_t>(blk.data.size())));
+            totalIn_ += blk.data.size();
+        }
+        inFlight_.clear();
+    });
+}
+
+void GzipStreamBuf::joinBatch()
+{
+    if (worker_.joinable())
+    {
+        worker_.join();
+    }
+}
+
+bool GzipStreamBuf::close()
+{
+    if (!file_)
+    {
+        return false;
+    }
+
+    // 剩余数据
+    const std::size_t n = static_cast<std::size_t>(pptr() - pbase());
+    if (n > 0)
+    {
+        Block b;
+        b.data.assign(pbase(), pptr());
+        pending_.push_back(std::move(b));
+    }
+    setp(nullptr, nullptr);
+    launchBatch();
+    joinBatch();
+
+    // 空的终结块 + trailer（CRC32、长度 mod 2^32）
+    std::vector<unsigned char> last;
+    deflateBlock(nullptr, 0, nullptr, 0, level_, Z_FINISH, last);
+    unsigned char trailer[8];
+    putLE32(trailer,     crc_);
+    putLE32(trailer + 4, static_cast<std::uint32_t>(totalIn_));
+
+    bool ok = !writeFailed_;
+    ok = ok && std::fwrite(last.data(), 1, last.size(), file_) == last.size();
+    ok = ok && std::fwrite(trailer, 1, sizeof trailer, file_) == sizeof trailer;
+    compressedBytes_ += last.size() + sizeof trailer;
+
+    ok = std::fclose(file_) == 0 && ok;
+    file_ = nullptr;
+    return ok;
+}
+
+GzipOStream::GzipOStream(const std::string& path, int level)
+    : std::ostream(nullptr), buf_(path, level)
+{
+    rdbuf(&buf_);
+    if (!buf_.isOpen())
+    {
+        setstate(std::ios::badbit);
+    }
+}
+
+void GzipOStream::close()
+{
+    if (buf_.isOpen() && !buf_.close())
+    {
+        setstate(std::ios::badbit);
+    }
+}
+
+std::unique_ptr<std::ostream> openOutputFile(const std::string& path, bool gzip,
+                                             std::ios::openmode mode)
+{
+    if (gzip)
+    {
+        return std::make_unique<GzipOStream>(path);
+    }
+    return std::make_unique<std::ofstream>(path, mode);
+}
+
+bool closeOutputFile(std::ostream& out)
+{
+    if (auto* gz = dynamic_cast<GzipOStream*>(&out))
+    {
+        gz->close();
+    }
+    else if (auto* f = dynamic_cast<std::ofstream*>(&out))
+    {
+        f->close();
+    }
+    return !out.fail();
+}
+
+std::vector<char> readGzipFile(const std::string& path)
+{
+    gzFile gz = gzopen(path.c_str(), "rb");
+    if (!gz)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        std::exit(1);
+    }
+    gzbuffer(gz, 1u << 20);
+
+    std::vector<char> data;
+    std::size_t used = 0;
+    for (;;)
+    {
+        if (data.size() - used < kBlockSize) data.resize(std::max(2 * data.size(), used + kBlockSize));
+        const int n = gzread(gz, data.data() + used, static_cast<unsigned>(data.size() - used));
+        if (n < 0)
+        {
+            int err = 0;
+            std::cerr << "Cannot read " << path << ": " << gzerror(gz, &err) << "\n";
+            std::exit(1);
+        }
+        if (n == 0) break;
+        used += static_cast<std::size_t>(n);
+    }
+    gzclose(gz);
+    data.resize(used);
+    return data;
+}
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 并行 gzip 输出（pigz 方式）：
+// - 格式化后的字节流切成固定大小的块，攒满一批（每线程一块）后交给后台线程并行压缩，
+//   格式化线程同时继续填下一批
+// - 每块单独做 raw deflate，以前一块末尾 32 KiB 作字典，以 Z_SYNC_FLUSH 结束（字节对齐），
+//   按顺序拼接；最后补一个空的终结块、用 crc32_combine 合成的 CRC 与长度写 trailer，
+//   整个文件是一个标准 gzip member
+// 块大小、字典都不依赖线程数，同样的输入在任何机器上得到逐字节相同的 .gz。
+
+class GzipStreamBuf : public std::streambuf
+{
+public:
+    GzipStreamBuf(const std::string& path, int level);
+    ~GzipStreamBuf() override;
+
+    GzipStreamBuf(const GzipStreamBuf&) = delete;
+    GzipStreamBuf& operator=(const GzipStreamBuf&) = delete;
+
+    bool isOpen() const { return file_ != nullptr; }
+
+    // 压缩剩余数据、写 trailer 并关闭文件；返回是否成功
+    bool close();
+
+    // 已写入文件的压缩字节数（close 之后为文件大小）
+    std::uint64_t compressedBytes() const { return compressedBytes_; }
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char* s, std::streamsize n) override;
+    pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+
+private:
+    struct Block
+    {
+        std::vector<char> data;
+        std::vector<unsigned char> out;
+        std::uint32_t crc = 0;
+    };
+
+    void finishBlock();
+    void launchBatch();
+    void joinBatch();
+
+    std::FILE*          file_ = nullptr;
+    int                 level_;
+    std::vector<char>   current_;
+    std::vector<Block>  pending_;
+    std::vector<Block>  inFlight_;
+    std::vector<char>   dictionary_;   // 上一批最后一块的末尾 32 KiB
+    std::thread         worker_;
+    bool                writeFailed_ = false;
+
+    std::uint64_t totalQueued_ = 0;    // 已交给后台线程的未压缩字节（格式化线程）
+    std::uint32_t crc_         = 0;    // 以下三项只由后台线程更新
+    std::uint64_t totalIn_     = 0;
+    std::uint64_t compressedBytes_ = 0;
+};
+
+class GzipOStream : public std::ostream
+{
+public:
+    explicit GzipOStream(const std::string& path, int level = 6);
+
+    // 关闭失败时置 badbit
+    void close();
+
+    std::uint64_t compressedBytes() const { return buf_.compressedBytes(); }
+
+private:
+    GzipStreamBuf buf_;
+};
+
+// 打开输出文件：gzip 时写成 gzip 流（文件名由调用方决定），否则为普通 std::ofstream。
+// 打不开时返回的流处于失败状态（!out 为真）。
+std::unique_ptr<std::ostream> openOutputFile(const std::string& path, bool gzip,
+                                             std::ios::openmode mode = std::ios::out);
+
+// 关闭 openOutputFile 打开的流（gzip 时写 trailer），返回是否成功
+bool closeOutputFile(std::ostream& out);
+
+// 读入整个 gzip 文件（可为多个 member 拼接）并解压；失败时打印错误并退出
+std::vector<char> readGzipFile(const std::string& path);
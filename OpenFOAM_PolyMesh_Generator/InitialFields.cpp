@@ -0,0 +1,131 @@
+#include "InitialFields.h"
+#include "MeshGeometry.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+
+// cellZone 中的 cell 编号须在 [0, nCells) 内
+void checkZoneCell(const MeshData& mesh, std::size_t z, label c, label nCells)
+{
+    if (c < 0 || c >= nCells)
+    {
+        std::cerr << "initial field: cellZone " << mesh.cellZones[z].name << " has cell " << c
+                  << " outside 0.." << nCells - 1 << "\n";
+        std::exit(1);
+    }
+}
+
+// 每个 cell 的区域编号（0 = 不在任何 zone 中）
+std::vector<int> cellRegions(const MeshData& mesh, label nCells)
+{
+    std::vector<int> region(static_cast<std::size_t>(nCells), 0);
+    for (std::size_t z = 0; z < mesh.cellZones.size(); ++z)
+    {
+        for (label c : mesh.cellZones[z].cells)
+        {
+            checkZoneCell(mesh, z, c, nCells);
+            region[static_cast<std::size_t>(c)] = static_cast<int>(z) + 1;
+        }
+    }
+    return region;
+}
+
+} // namespace
+
+VolField evaluateInitialField(const MeshData& mesh, const InitialField& field)
+{
+    ScopedStage stage("initialField");
+
+    const int nc = field.nComponents;
+    if (nc != 1 && nc != 3)
+    {
+        std::cerr << "initial field " << field.name << ": need 1 or 3 components\n";
+        std::exit(1);
+    }
+
+    VolField out;
+    out.name            = field.name;
+    out.dimensions      = field.dimensions;
+    out.nComponents     = nc;
+    out.defaultBoundary = field.defaultBoundary;
+    out.patchBoundary   = field.patchBoundary;
+    out.boundaryValue   = field.value;
+
+    auto uniformOf = [nc](const InitialField::Value& v)
+    {
+        return std::vector<double>(v.begin(), v.begin() + nc);
+    };
+
+    // 只作为 neighbour 出现的 cell（重新编号后的内部 cell）也要计入
+    label nCells = 0;
+    for (label c : mesh.owner)     nCells = std::max(nCells, c + 1);
+    for (label c : mesh.neighbour) nCells = std::max(nCells, c + 1);
+
+    // 只在实际存在的区域中查看给值：全部与默认值相同则直接 uniform
+    bool uniform = !field.cellValue;
+    for (const auto& rv : field.regionValues)
+    {
+        const bool present = rv.first >= 1 && rv.first <= static_cast<int>(mesh.cellZones.size())
+                          && !mesh.cellZones[rv.first - 1].cells.empty();
+        if (present && rv.second != field.value) uniform = false;
+    }
+    if (uniform)
+    {
+        out.values = uniformOf(field.value);
+        return out;
+    }
+
+    stage.setCells(static_cast<std::uint64_t>(nCells));
+
+    std::vector<double>& values = out.values;
+    values.resize(static_cast<std::size_t>(nCells) * nc);
+
+    if (field.cellValue)
+    {
+        const std::vector<int>   region = cellRegions(mesh, nCells);
+        const MeshGeometry&    geo    = meshGeometry(mesh);   // 体心，与 checkMesh 共用缓存
+
+        parallelFor(static_cast<std::size_t>(nCells), [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t c = b; c < e; ++c)
+            {
+                const InitialField::Value v = field.cellValue(geo.cellCentre(c), region[c]);
+                std::copy(v.begin(), v.begin() + nc, values.begin() + c * nc);
+            }
+        });
+    }
+    else
+    {
+        for (label c = 0; c < nCells; ++c)
+        {
+            std::copy(field.value.begin(), field.value.begin() + nc, values.begin() + static_cast<std::size_t>(c) * nc);
+        }
+        for (const auto& rv : field.regionValues)
+        {
+            if (rv.first < 1 || rv.first > static_cast<int>(mesh.cellZones.size())) continue;
+            for (label c : mesh.cellZones[rv.first - 1].cells)
+            {
+                checkZoneCell(mesh, static_cast<std::size_t>(rv.first - 1), c, nCells);
+                std::copy(rv.second.begin(), rv.second.begin() + nc, values.begin() + static_cast<std::size_t>(c) * nc);
+            }
+        }
+    }
+
+    // 回调给出的场也可能处处相同
+    bool constant = true;
+    for (std::size_t i = nc; i < values.size() && constant; ++i)
+    {
+        constant = values[i] == values[i % nc];
+    }
+    if (constant)
+    {
+        values.resize(nc);
+    }
+    return out;
+}
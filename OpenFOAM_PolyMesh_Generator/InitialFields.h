@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FieldWriter.h"
+
+// 初始场（代替 setFields）：按区域给值，或用逐 cell 回调。
+// 区域 r 的 cell 取自 mesh.cellZones[r-1]（由区域掩模在裁剪时生成），
+// 不属于任何区域的 cell 取 value。
+struct InitialField
+{
+    using Value = std::array<double,3>;
+
+    std::string name;                                 // p, T, U, ...
+    std::string dimensions  = "[0 0 0 0 0 0 0]";
+    int         nComponents = 1;                      // 1: scalar，3: vector
+
+    Value                            value{};         // 默认值
+    std::vector<std::pair<int, Value>> regionValues;  // 区域编号（1 起）-> 值
+
+    // 非空时逐 cell 求值（cellCentre 为体心，取自 meshGeometry 缓存），覆盖 value / regionValues
+    std::function<Value(const Point& cellCentre, int region)> cellValue;
+
+    std::string                        defaultBoundary = "zeroGradient";
+    std::map<std::string, std::string> patchBoundary;    // patch 名 -> 边界条件 type
+};
+
+// 在 mesh 上求值。整个场为同一个值时返回 uniform 形式（values 只有 nComponents 个），
+// 纯区域给值且各区域值相同时不触碰逐 cell 数据。
+VolField evaluateInitialField(const MeshData& mesh, const InitialField& field);
@@ -0,0 +1,90 @@
+#include "MappedFile.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path, Mode mode, std::size_t size)
+    : path_(path), mode_(mode), size_(size)
+{
+    if (mode_ == readOnly)
+    {
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) fail("open");
+
+        struct stat st{};
+        if (::fstat(fd_, &st) != 0) fail("fstat");
+        size_ = static_cast<std::size_t>(st.st_size);
+        if (size_ == 0) return;
+
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) fail("mmap");
+        data_ = static_cast<char*>(p);
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+    }
+    else
+    {
+        fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) fail("open");
+        if (size_ == 0) return;
+        reserve();
+
+        void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) fail("mmap");
+        data_ = static_cast<char*>(p);
+    }
+}
+
+void MappedFile::reserve()
+{
+    // 先真正分配磁盘块：只 ftruncate 得到的是稀疏文件，空间不足时要到写映射时才以 SIGBUS
+    // 失败，进程无提示地中途退出。文件系统不支持预分配时才退回 ftruncate。
+#if defined(__APPLE__)
+    fstore_t store{};
+    store.fst_flags   = F_ALLOCATEALL;
+    store.fst_posmode = F_PEOFPOSMODE;
+    store.fst_length  = static_cast<off_t>(size_);
+    if (::fcntl(fd_, F_PREALLOCATE, &store) != 0 && errno != ENOTSUP && errno != EINVAL)
+    {
+        fail("preallocate");
+    }
+#else
+    const int err = ::posix_fallocate(fd_, 0, static_cast<off_t>(size_));
+    if (err == 0) return;
+    if (err != EOPNOTSUPP && err != EINVAL && err != ENOSYS)
+    {
+        errno = err;
+        fail("posix_fallocate");
+    }
+#endif
+    if (::ftruncate(fd_, static_cast<off_t>(size_)) != 0) fail("ftruncate");
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+    {
+        if (mode_ == writeNew && ::msync(data_, size_, MS_SYNC) != 0)
+        {
+            std::cerr << "msync failed for " << path_ << ": " << std::strerror(errno) << "\n";
+        }
+        ::munmap(data_, size_);
+    }
+    if (fd_ >= 0)
+    {
+        ::close(fd_);
+    }
+}
+
+void MappedFile::fail(const char* what) const
+{
+    std::cerr << "Cannot map " << path_ << " (" << what << "): "
+              << std::strerror(errno) << "\n";
+    std::exit(1);
+}
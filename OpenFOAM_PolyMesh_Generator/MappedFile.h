@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 整个文件的内存映射（POSIX mmap）。
+// - readOnly: 映射已有文件，只读
+// - writeNew: 新建 / 截断文件，预分配到给定大小（posix_fallocate，不支持时 ftruncate）后可写映射；
+//   析构时 msync 落盘
+// 打开、预分配（含磁盘空间不足）或映射失败时打印错误并退出。
+class MappedFile
+{
+public:
+    enum Mode
+    {
+        readOnly,
+        writeNew
+    };
+
+    MappedFile(const std::string& path, Mode mode, std::size_t size = 0);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    char*       data()       { return data_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+private:
+    void reserve();
+    [[noreturn]] void fail(const char* what) const;
+
+    std::string path_;
+    Mode        mode_;
+    std::size_t size_ = 0;
+    int         fd_   = -1;
+    char*       data_ = nullptr;
+};
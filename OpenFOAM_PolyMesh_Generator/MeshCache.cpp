@@ -0,0 +1,377 @@
+#include "MeshCache.h"
+#include "FieldWriter.h"
+#include "PolyMeshWriter.h"
+#include "Profiler.h"
+#include "VTKWriter.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+const char kMeshMagic[8] = {'P','M','G','M','E','S','H','5'};
+const char kKeepMagic[8] = {'P','M','G','K','E','E','P','2'};
+
+// 同一进程内多个 case 可能同时写缓存，临时文件名带序号
+std::string uniqueTmp(const std::string& path)
+{
+    static std::atomic<unsigned long> counter{0};
+    std::ostringstream ss;
+    ss << path << ".tmp" << counter.fetch_add(1);
+    return ss.str();
+}
+
+template <class T>
+void writeVec(std::ofstream& out, const std::vector<T>& v)
+{
+    std::uint64_t n = v.size();
+    out.write(reinterpret_cast<const char*>(&n), sizeof n);
+    out.write(reinterpret_cast<const char*>(v.data()), static_cast<std::streamsize>(n * sizeof(T)));
+}
+
+template <class T>
+bool readVec(std::ifstream& in, std::vector<T>& v)
+{
+    std::uint64_t n = 0;
+    if (!in.read(reinterpret_cast<char*>(&n), sizeof n)) return false;
+    v.resize(n);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()),
+                                     static_cast<std::streamsize>(n * sizeof(T))));
+}
+
+bool sameContents(const std::string& a, const std::string& b)
+{
+    std::error_code ec;
+    if (!fs::exists(b, ec)) return false;
+    if (fs::file_size(a, ec) != fs::file_size(b, ec) || ec) return false;
+
+    std::ifstream fa(a, std::ios::binary), fb(b, std::ios::binary);
+    if (!fa || !fb) return false;
+
+    std::vector<char> ba(1 << 20), bb(1 << 20);
+    while (fa && fb)
+    {
+        fa.read(ba.data(), static_cast<std::streamsize>(ba.size()));
+        fb.read(bb.data(), static_cast<std::streamsize>(bb.size()));
+        if (fa.gcount() != fb.gcount()) return false;
+        if (std::memcmp(ba.data(), bb.data(), static_cast<std::size_t>(fa.gcount())) != 0) return false;
+    }
+    return true;
+}
+
+std::int64_t mtimeOf(const std::string& p)
+{
+    std::error_code ec;
+    auto t = fs::last_write_time(p, ec);
+    if (ec) return -1;
+    return static_cast<std::int64_t>(t.time_since_epoch().count());
+}
+
+} // namespace
+
+// ---- HashBuilder ----
+
+HashBuilder& HashBuilder::add(const void* data, std::size_t n)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        h_ ^= p[i];
+        h_ *= 1099511628211ull;
+    }
+    return *this;
+}
+
+HashBuilder& HashBuilder::add(const std::string& s)
+{
+    add(static_cast<std::uint64_t>(s.size()));
+    return add(s.data(), s.size());
+}
+
+std::string HashBuilder::hex() const
+{
+    char buf[17];
+    std::snprintf(buf, sizeof buf, "%016llx", static_cast<unsigned long long>(h_));
+    return buf;
+}
+
+// ---- MeshCache ----
+
+MeshCache::MeshCache(std::string directory)
+    : dir_(std::move(directory))
+{
+    fs::create_directories(dir_);
+}
+
+std::string MeshCache::path(std::uint64_t key, const char* ext) const
+{
+    return dir_ + "/" + HashBuilder().add(key).hex() + ext;
+}
+
+bool MeshCache::loadKeep(std::uint64_t key, std::vector<char>& keepCell) const
+{
+    std::ifstream in(path(key, ".keep"), std::ios::binary);
+    if (!in) return false;
+
+    char magic[8];
+    std::vector<unsigned char> bits;
+    std::uint64_t n = 0;
+    char packed = 1;
+    if (!in.read(magic, 8) || std::memcmp(magic, kKeepMagic, 8) != 0) return false;
+    if (!in.read(reinterpret_cast<char*>(&n), sizeof n)) return false;
+    if (!in.read(&packed, 1)) return false;
+
+    if (!packed)
+    {
+        return readVec(in, keepCell) && keepCell.size() == n;
+    }
+
+    if (!readVec(in, bits) || bits.size() != (n + 7) / 8) return false;
+
+    keepCell.assign(n, 0);
+    for (std::uint64_t c = 0; c < n; ++c)
+    {
+        keepCell[c] = (bits[c >> 3] >> (c & 7)) & 1;
+    }
+    return true;
+}
+
+void MeshCache::storeKeep(std::uint64_t key, const std::vector<char>& keepCell) const
+{
+    // 纯 0/1 位图按位打包；区域编号 > 1 时原样存字节
+    const std::uint64_t n = keepCell.size();
+    bool packed = true;
+    std::vector<unsigned char> bits((n + 7) / 8, 0);
+    for (std::uint64_t c = 0; c < n; ++c)
+    {
+        if (keepCell[c] > 1) packed = false;
+        if (keepCell[c]) bits[c >> 3] |= static_cast<unsigned char>(1u << (c & 7));
+    }
+
+    const std::string final = path(key, ".keep");
+    const std::string tmp   = uniqueTmp(final);
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(kKeepMagic, 8);
+        out.write(reinterpret_cast<const char*>(&n), sizeof n);
+        const char flag = packed ? 1 : 0;
+        out.write(&flag, 1);
+        if (packed) writeVec(out, bits);
+        else        writeVec(out, keepCell);
+    }
+    fs::rename(tmp, final);
+}
+
+bool MeshCache::loadMesh(std::uint64_t key, MeshData& mesh) const
+{
+    std::ifstream in(path(key, ".mesh"), std::ios::binary);
+    if (!in) return false;
+
+    char magic[8];
+    if (!in.read(magic, 8) || std::memcmp(magic, kMeshMagic, 8) != 0) return false;
+
+    MeshData m;
+    int hdr[5];
+    if (!in.read(reinterpret_cast<char*>(hdr), sizeof hdr)) return false;
+    if (hdr[4] != static_cast<int>(sizeof(label))) return false;   // 另一种 label 位宽的构建写的缓存
+    m.Nx = hdr[0]; m.Ny = hdr[1]; m.Nz = hdr[2];
+
+    m.patches.resize(hdr[3]);
+    for (PatchInfo& p : m.patches)
+    {
+        label range[2];
+        if (!std::getline(in, p.name, '\0') || !std::getline(in, p.type, '\0')) return false;
+        if (!in.read(reinterpret_cast<char*>(range), sizeof range)) return false;
+        p.startFace = range[0];
+        p.nFaces    = range[1];
+    }
+
+    if (!readVec(in, m.points) || !readVec(in, m.faces.offsets) || !readVec(in, m.faces.verts) ||
+        !readVec(in, m.owner)  || !readVec(in, m.neighbour) || m.faces.offsets.empty())
+    {
+        return false;
+    }
+
+    int nZones[2];
+    if (!in.read(reinterpret_cast<char*>(nZones), sizeof nZones)) return false;
+    m.cellZones.resize(nZones[0]);
+    m.faceZones.resize(nZones[1]);
+    for (CellZone& z : m.cellZones)
+    {
+        if (!std::getline(in, z.name, '\0') || !readVec(in, z.cells)) return false;
+    }
+    for (FaceZone& z : m.faceZones)
+    {
+        if (!std::getline(in, z.name, '\0') || !readVec(in, z.faces) || !readVec(in, z.flipMap)) return false;
+    }
+
+    mesh = std::move(m);
+    return true;
+}
+
+void MeshCache::storeMesh(std::uint64_t key, const MeshData& m) const
+{
+    const std::string final = path(key, ".mesh");
+    const std::string tmp   = uniqueTmp(final);
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        out.write(kMeshMagic, 8);
+        const int hdr[5] = {m.Nx, m.Ny, m.Nz, static_cast<int>(m.patches.size()), static_cast<int>(sizeof(label))};
+        out.write(reinterpret_cast<const char*>(hdr), sizeof hdr);
+        for (const PatchInfo& p : m.patches)
+        {
+            const label range[2] = {p.startFace, p.nFaces};
+            out.write(p.name.c_str(), static_cast<std::streamsize>(p.name.size() + 1));
+            out.write(p.type.c_str(), static_cast<std::streamsize>(p.type.size() + 1));
+            out.write(reinterpret_cast<const char*>(range), sizeof range);
+        }
+        writeVec(out, m.points);
+        writeVec(out, m.faces.offsets);
+        writeVec(out, m.faces.verts);
+        writeVec(out, m.owner);
+        writeVec(out, m.neighbour);
+
+        const int nZones[2] = {static_cast<int>(m.cellZones.size()), static_cast<int>(m.faceZones.size())};
+        out.write(reinterpret_cast<const char*>(nZones), sizeof nZones);
+        for (const CellZone& z : m.cellZones)
+        {
+            out.write(z.name.c_str(), static_cast<std::streamsize>(z.name.size() + 1));
+            writeVec(out, z.cells);
+        }
+        for (const FaceZone& z : m.faceZones)
+        {
+            out.write(z.name.c_str(), static_cast<std::streamsize>(z.name.size() + 1));
+            writeVec(out, z.faces);
+            writeVec(out, z.flipMap);
+        }
+    }
+    fs::rename(tmp, final);
+}
+
+bool MeshCache::outputsUpToDate(std::uint64_t key, const std::vector<std::string>& files) const
+{
+    std::ifstream in(path(key, ".written"));
+    if (!in) return false;
+
+    std::size_t nMatched = 0;
+    std::uint64_t size;
+    std::int64_t mtime;
+    std::string file;
+    while (in >> size >> mtime && std::getline(in >> std::ws, file))
+    {
+        std::error_code ec;
+        if (fs::file_size(file, ec) != size || ec) return false;
+        if (mtimeOf(file) != mtime) return false;
+        ++nMatched;
+    }
+    return nMatched == files.size();
+}
+
+void MeshCache::recordOutputs(std::uint64_t key, const std::vector<std::string>& files) const
+{
+    const std::string final = path(key, ".written");
+    const std::string tmp   = uniqueTmp(final);
+    {
+        std::ofstream out(tmp);
+        for (const auto& f : files)
+        {
+            std::error_code ec;
+            out << fs::file_size(f, ec) << " " << mtimeOf(f) << " " << f << "\n";
+        }
+    }
+    fs::rename(tmp, final);
+}
+
+// ---- 只在内容变化时替换输出文件 ----
+
+bool replaceFileIfChanged(const std::string& tmpPath, const std::string& finalPath)
+{
+    if (sameContents(tmpPath, finalPath))
+    {
+        fs::remove(tmpPath);
+        return false;
+    }
+    fs::rename(tmpPath, finalPath);
+    return true;
+}
+
+std::vector<std::string> polyMeshFiles(const std::string& directory, bool withZones,
+                                       PolyMeshCompression compression)
+{
+    const std::string ext = compression == PolyMeshCompression::gzip ? ".gz" : "";
+    std::vector<std::string> files;
+    for (const char* name : {"points", "faces", "owner", "neighbour", "boundary"})
+    {
+        files.push_back(directory + "/" + name + ext);
+    }
+    if (withZones)
+    {
+        files.push_back(directory + "/cellZones" + ext);
+        files.push_back(directory + "/faceZones" + ext);
+    }
+    return files;
+}
+
+void writePolyMeshIfChanged(const MeshData& mesh, const std::string& directory,
+                            PolyMeshFormat format, PolyMeshCompression compression)
+{
+    ScopedStage stage("writePolyMeshIfChanged");
+
+    const std::string staging = uniqueTmp(directory + "/.pmg_staging");
+    writePolyMeshFiles(mesh, staging, format, compression);
+
+    // 另一种压缩方式的同名文件一律删掉，避免 OpenFOAM 读到过期的那个
+    const PolyMeshCompression other = compression == PolyMeshCompression::gzip
+        ? PolyMeshCompression::none : PolyMeshCompression::gzip;
+    for (const std::string& f : polyMeshFiles(directory, true, other))
+    {
+        fs::remove(f);
+    }
+
+    // 没写出的 zone 文件（mesh 无 zone）在目标目录中也删掉
+    int nReplaced = 0;
+    int nFiles = 0;
+    for (const std::string& f : polyMeshFiles(directory, true, compression))
+    {
+        const std::string tmp = staging + f.substr(directory.size());
+        if (!fs::exists(tmp))
+        {
+            fs::remove(f);
+            continue;
+        }
+        ++nFiles;
+        if (replaceFileIfChanged(tmp, f)) ++nReplaced;
+    }
+    fs::remove_all(staging);
+
+    std::cout << "polyMesh " << directory << ": " << nReplaced
+              << " file(s) changed, " << (nFiles - nReplaced) << " unchanged\n";
+}
+
+void writeVTKSurfaceIfChanged(const MeshData& mesh, const std::string& filePath)
+{
+    const bool gzip = filePath.size() > 3 && filePath.compare(filePath.size() - 3, 3, ".gz") == 0;
+    const std::string tmp = uniqueTmp(filePath);
+    writeVTKSurface(mesh, tmp, gzip);
+    replaceFileIfChanged(tmp, filePath);
+}
+
+void writeVolFieldIfChanged(const MeshData& mesh, const std::string& timeDir, const VolField& field)
+{
+    // 临时目录下保留同名的时间目录，使文件头中的 location 与最终位置一致
+    fs::create_directories(timeDir);
+    const std::string staging = uniqueTmp(timeDir + "/.pmg_staging");
+    const std::string stagingTime = staging + "/" + fs::path(timeDir).filename().string();
+
+    writeVolField(mesh, stagingTime, field);
+    replaceFileIfChanged(stagingTime + "/" + field.name, timeDir + "/" + field.name);
+    fs::remove_all(staging);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+#include "FieldWriter.h"
+#include "PolyMeshWriter.h"
+
+// 内容寻址的中间结果缓存。
+// 每个阶段的输入（网格参数、掩模定义、patch 规则、输出格式）哈希成一个 key，
+// 阶段产物以 key 命名存放在缓存目录中：
+//   <key>.keep    背景网格的保留 cell 位图（区域掩模时为每 cell 一字节的区域编号）
+//   <key>.mesh    裁剪 + 清理后的拓扑（MeshData 二进制转储）
+//   <key>.written 已写出文件的清单（路径 / 大小 / 修改时间）
+// 重跑时只重算输入发生变化的阶段。
+
+// 64 位 FNV-1a 哈希
+class HashBuilder
+{
+public:
+    HashBuilder& add(const void* data, std::size_t n);
+    HashBuilder& add(const std::string& s);
+    HashBuilder& add(double v)        { return add(&v, sizeof v); }
+    HashBuilder& add(int v)           { return add(&v, sizeof v); }
+    HashBuilder& add(std::uint64_t v) { return add(&v, sizeof v); }
+
+    std::uint64_t value() const { return h_; }
+    std::string   hex() const;
+
+private:
+    std::uint64_t h_ = 1469598103934665603ull;
+};
+
+class MeshCache
+{
+public:
+    explicit MeshCache(std::string directory);
+
+    const std::string& directory() const { return dir_; }
+
+    bool loadKeep (std::uint64_t key, std::vector<char>& keepCell) const;
+    void storeKeep(std::uint64_t key, const std::vector<char>& keepCell) const;
+
+    bool loadMesh (std::uint64_t key, MeshData& mesh) const;
+    void storeMesh(std::uint64_t key, const MeshData& mesh) const;
+
+    // files 是否都还是上次以 key 写出时的样子（存在且大小 / 修改时间未变）
+    bool outputsUpToDate(std::uint64_t key, const std::vector<std::string>& files) const;
+    void recordOutputs  (std::uint64_t key, const std::vector<std::string>& files) const;
+
+private:
+    std::string path(std::uint64_t key, const char* ext) const;
+
+    std::string dir_;
+};
+
+// 若 tmpPath 与 finalPath 内容相同则删除 tmpPath、保留原文件（时间戳不变），
+// 否则用 tmpPath 替换 finalPath。返回是否发生了替换。
+bool replaceFileIfChanged(const std::string& tmpPath, const std::string& finalPath);
+
+// 先写到临时目录，再逐个文件 replaceFileIfChanged，未变化的文件不会被改写
+void writePolyMeshIfChanged(const MeshData& mesh, const std::string& directory,
+                            PolyMeshFormat format = PolyMeshFormat::ascii,
+                            PolyMeshCompression compression = PolyMeshCompression::none);
+void writeVTKSurfaceIfChanged(const MeshData& mesh, const std::string& filePath);
+void writeVolFieldIfChanged(const MeshData& mesh, const std::string& timeDir, const VolField& field);
+
+// polyMesh 目录下由 writePolyMesh 写出的文件；withZones 时含 cellZones / faceZones，
+// gzip 时文件名带 .gz
+std::vector<std::string> polyMeshFiles(const std::string& directory, bool withZones = false,
+                                       PolyMeshCompression compression = PolyMeshCompression::none);
@@ -0,0 +1,279 @@
+#include "MeshChecker.h"
+#include "MeshGeometry.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+struct Vec
+{
+    double x = 0.0, y = 0.0, z = 0.0;
+};
+
+inline Vec sub(const Vec& a, const Vec& b)   { return {a.x - b.x, a.y - b.y, a.z - b.z}; }
+inline double dot(const Vec& a, const Vec& b) { return a.x*b.x + a.y*b.y + a.z*b.z; }
+inline double mag(const Vec& a) { return std::sqrt(dot(a, a)); }
+
+// 对 [0, n) 并行执行 failed(i)，统计失败个数与最小失败编号
+template <class Pred>
+MeshCheckItem countFailures(const char* name, std::size_t n, Pred failed)
+{
+    const unsigned nChunks = parallelChunkCount(n);
+    std::vector<long long> count(nChunks, 0);
+    std::vector<long long> first(nChunks, -1);
+
+    parallelFor(n, [&](std::size_t b, std::size_t e, unsigned c)
+    {
+        for (std::size_t i = b; i < e; ++i)
+        {
+            if (failed(i))
+            {
+                if (first[c] < 0) first[c] = static_cast<long long>(i);
+                ++count[c];
+            }
+        }
+    });
+
+    MeshCheckItem item;
+    item.name = name;
+    for (unsigned c = 0; c < nChunks; ++c)
+    {
+        item.nFailed += count[c];
+        if (first[c] >= 0 && (item.firstFailed < 0 || first[c] < item.firstFailed))
+        {
+            item.firstFailed = first[c];
+        }
+    }
+    return item;
+}
+
+void finish(MeshCheckReport& r)
+{
+    r.passed = true;
+    for (const auto& c : r.checks)
+    {
+        if (c.nFailed != 0) r.passed = false;
+    }
+}
+
+} // namespace
+
+MeshCheckReport checkMesh(const MeshData& mesh, const MeshCheckOptions& opts)
+{
+    ScopedStage stage("checkMesh");
+
+    MeshCheckReport r;
+
+    const auto& pts = mesh.points;
+    const std::size_t nPoints   = pts.size();
+    const std::size_t nFaces    = mesh.faces.size();
+    const std::size_t nInternal = mesh.neighbour.size();
+
+    r.nPoints        = nPoints;
+    r.nFaces         = nFaces;
+    r.nInternalFaces = nInternal;
+
+    // 0) 尺寸一致性：不满足时后续检查都没有意义
+    {
+        MeshCheckItem item;
+        item.name = "sizes";
+        if (mesh.owner.size() != nFaces || nInternal > nFaces ||
+            mesh.faces.offsets.back() != static_cast<label>(mesh.faces.verts.size()))
+        {
+            item.nFailed = 1;
+        }
+        r.checks.push_back(item);
+        if (item.nFailed != 0)
+        {
+            finish(r);
+            return r;
+        }
+    }
+
+    // 1) 点编号 / cell 编号范围（不足三个顶点的面也算点编号错误）
+    r.checks.push_back(countFailures("pointIndices", nFaces, [&](std::size_t f)
+    {
+        if (mesh.faces.offsets[f + 1] - mesh.faces.offsets[f] < 3) return true;
+        for (label v : mesh.faces[f])
+        {
+            if (v < 0 || static_cast<std::size_t>(v) >= nPoints) return true;
+        }
+        return false;
+    }));
+
+    r.checks.push_back(countFailures("cellIndices", nFaces, [&](std::size_t f)
+    {
+        if (mesh.owner[f] < 0) return true;
+        return f < nInternal && mesh.neighbour[f] < 0;
+    }));
+
+    if (r.checks.back().nFailed != 0 || r.checks[r.checks.size() - 2].nFailed != 0)
+    {
+        finish(r);
+        return r;
+    }
+
+    label maxCell = -1;
+    for (label c : mesh.owner)     maxCell = std::max(maxCell, c);
+    for (label c : mesh.neighbour) maxCell = std::max(maxCell, c);
+    const std::size_t nCells = static_cast<std::size_t>(maxCell + 1);
+    r.nCells = nCells;
+    stage.setCells(nCells);
+    stage.setFaces(nFaces);
+
+    // 2) owner < neighbour
+    r.checks.push_back(countFailures("ownerLessThanNeighbour", nInternal, [&](std::size_t f)
+    {
+        return !(mesh.owner[f] < mesh.neighbour[f]);
+    }));
+
+    // 3) upper-triangular：internal faces 按 (owner, neighbour) 递增。
+    //    同一对 cell 之间可以有多个面（cut cell 合并后），与 OpenFOAM 一样不算错
+    r.checks.push_back(countFailures("upperTriangular", nInternal, [&](std::size_t f)
+    {
+        if (f == 0) return false;
+        const label o0 = mesh.owner[f - 1], o1 = mesh.owner[f];
+        if (o0 != o1) return o0 > o1;
+        return mesh.neighbour[f - 1] > mesh.neighbour[f];
+    }));
+
+    // 4) 未被任何面使用的点
+    {
+        std::vector<std::atomic<unsigned char>> used(nPoints);
+        parallelFor(nPoints, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t i = b; i < e; ++i) used[i].store(0, std::memory_order_relaxed);
+        });
+        parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            for (std::size_t f = b; f < e; ++f)
+            {
+                for (label v : mesh.faces[f]) used[v].store(1, std::memory_order_relaxed);
+            }
+        });
+        r.checks.push_back(countFailures("unusedPoints", nPoints, [&](std::size_t p)
+        {
+            return used[p].load(std::memory_order_relaxed) == 0;
+        }));
+    }
+
+    finish(r);
+    if (opts.failFast && !r.passed)
+    {
+        return r;
+    }
+
+    // 5) 面 / cell 几何量：取网格上的几何缓存（MeshGeometry.h），之后的场初始化等直接复用
+    const MeshGeometry& geo = meshGeometry(mesh);
+    auto Cf = [&geo](std::size_t f) { return Vec{geo.faceCentreX[f], geo.faceCentreY[f], geo.faceCentreZ[f]}; };
+    auto Sf = [&geo](std::size_t f) { return Vec{geo.faceAreaX[f], geo.faceAreaY[f], geo.faceAreaZ[f]}; };
+    auto Cc = [&geo](std::size_t c) { return Vec{geo.cellCentreX[c], geo.cellCentreY[c], geo.cellCentreZ[c]}; };
+    const std::vector<double>& V = geo.cellVolume;
+
+    r.checks.push_back(countFailures("closedCells", nCells, [&](std::size_t c)
+    {
+        return geo.cellClosure[c] > opts.closedCellTol;
+    }));
+
+    r.checks.push_back(countFailures("positiveVolumes", nCells, [&](std::size_t c)
+    {
+        return !(V[c] > 0.0);
+    }));
+
+    if (nCells > 0)
+    {
+        r.minVolume = *std::min_element(V.begin(), V.end());
+        r.maxVolume = *std::max_element(V.begin(), V.end());
+        double total = 0.0;
+        for (double v : V) total += v;
+        r.totalVolume = total;
+    }
+
+    // 8) 面朝向：Sf 与 owner->neighbour（边界面为 owner->面心）同向
+    r.checks.push_back(countFailures("faceOrientation", nFaces, [&](std::size_t f)
+    {
+        const Vec co = Cc(mesh.owner[f]);
+        Vec d = f < nInternal ? sub(Cc(mesh.neighbour[f]), co) : sub(Cf(f), co);
+        return !(dot(Sf(f), d) > 0.0);
+    }));
+
+    // 9) 非正交性
+    {
+        const double rad2deg = 180.0 / 3.14159265358979323846;
+        const unsigned nChunks = parallelChunkCount(nInternal);
+        std::vector<double> maxAngle(nChunks, 0.0), sumAngle(nChunks, 0.0);
+        std::vector<long long> count(nChunks, 0), first(nChunks, -1);
+
+        parallelFor(nInternal, [&](std::size_t b, std::size_t e, unsigned c)
+        {
+            for (std::size_t f = b; f < e; ++f)
+            {
+                const Vec S = Sf(f);
+                Vec d = sub(Cc(mesh.neighbour[f]), Cc(mesh.owner[f]));
+                double denom = mag(d) * mag(S);
+                double cosA = denom > 0.0 ? dot(d, S) / denom : -1.0;
+                cosA = std::max(-1.0, std::min(1.0, cosA));
+                double angle = std::acos(cosA) * rad2deg;
+
+                maxAngle[c] = std::max(maxAngle[c], angle);
+                sumAngle[c] += angle;
+                if (angle > opts.maxNonOrthogonality)
+                {
+                    if (first[c] < 0) first[c] = static_cast<long long>(f);
+                    ++count[c];
+                }
+            }
+        }, 4096);
+
+        MeshCheckItem item;
+        item.name = "nonOrthogonality";
+        double sum = 0.0;
+        for (unsigned c = 0; c < nChunks; ++c)
+        {
+            r.maxNonOrthogonality = std::max(r.maxNonOrthogonality, maxAngle[c]);
+            sum += sumAngle[c];
+            item.nFailed += count[c];
+            if (first[c] >= 0 && (item.firstFailed < 0 || first[c] < item.firstFailed))
+            {
+                item.firstFailed = first[c];
+            }
+        }
+        r.avgNonOrthogonality = nInternal > 0 ? sum / nInternal : 0.0;
+        r.checks.push_back(item);
+    }
+
+    finish(r);
+    return r;
+}
+
+void writeMeshCheckReport(const MeshCheckReport& r, std::ostream& out)
+{
+    out << "{\n";
+    out << "  \"passed\": " << (r.passed ? "true" : "false") << ",\n";
+    out << "  \"nPoints\": " << r.nPoints << ",\n";
+    out << "  \"nFaces\": " << r.nFaces << ",\n";
+    out << "  \"nInternalFaces\": " << r.nInternalFaces << ",\n";
+    out << "  \"nCells\": " << r.nCells << ",\n";
+    out << "  \"maxNonOrthogonality\": " << r.maxNonOrthogonality << ",\n";
+    out << "  \"avgNonOrthogonality\": " << r.avgNonOrthogonality << ",\n";
+    out << "  \"minVolume\": " << r.minVolume << ",\n";
+    out << "  \"maxVolume\": " << r.maxVolume << ",\n";
+    out << "  \"totalVolume\": " << r.totalVolume << ",\n";
+    out << "  \"checks\": [\n";
+    for (std::size_t i = 0; i < r.checks.size(); ++i)
+    {
+        const auto& c = r.checks[i];
+        out << "    {\"name\": \"" << c.name << "\", \"failed\": " << c.nFailed
+            << ", \"first\": " << c.firstFailed << "}"
+            << (i + 1 < r.checks.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+
+// 直接在 MeshData 上做的网格质量检查（类似 OpenFOAM checkMesh 的子集），
+// 按 face / cell 并行，写出之前就能发现坏网格。
+
+struct MeshCheckOptions
+{
+    double maxNonOrthogonality = 70.0;   // 度，超过即判为失败
+    double closedCellTol       = 1e-6;   // |sum(Sf)| / sum(|Sf|) 的容差
+    bool   failFast            = true;   // 拓扑检查失败后不再做几何检查
+};
+
+struct MeshCheckItem
+{
+    std::string name;
+    long long nFailed     = 0;
+    long long firstFailed = -1;   // 第一个失败的 face / cell / point 编号
+};
+
+struct MeshCheckReport
+{
+    std::size_t nPoints        = 0;
+    std::size_t nFaces         = 0;
+    std::size_t nInternalFaces = 0;
+    std::size_t nCells         = 0;
+
+    double maxNonOrthogonality = 0.0;
+    double avgNonOrthogonality = 0.0;
+    double minVolume           = 0.0;
+    double maxVolume           = 0.0;
+    double totalVolume         = 0.0;
+
+    std::vector<MeshCheckItem> checks;
+    bool passed = true;
+};
+
+MeshCheckReport checkMesh(const MeshData& mesh,
+                          const MeshCheckOptions& opts = MeshCheckOptions());
+
+// 以 JSON 形式输出检查报告
+void writeMeshCheckReport(const MeshCheckReport& report, std::ostream& out);
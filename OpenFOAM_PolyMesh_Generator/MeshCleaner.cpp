@@ -1,43 +1,47 @@
 
 #include "MeshCleaner.h"
+#include "MeshGeometry.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
 
 #include <vector>
 #include <iostream>
 
 void removeUnusedPoints(MeshData& mesh)
 {
+    ScopedStage stage("removeUnusedPoints");
+
     const std::size_t nPoints = mesh.points.size();
     const std::size_t nFaces  = mesh.faces.size();
+    stage.setFaces(nFaces);
 
     if (nPoints == 0 || nFaces == 0)
     {
         return;
     }
 
+    ScratchFrame scratch;
+
     // 1) 标记哪些点被 faces 使用
-    std::vector<char> used(nPoints, 0);
+    ScratchVector<char> used(nPoints, 0);
 
-    for (const auto& f : mesh.faces)
+    for (label pid : mesh.faces.verts)
     {
-        for (int k = 0; k < 4; ++k)
+        if (pid < 0 || static_cast<std::size_t>(pid) >= nPoints)
         {
-            int pid = f[k];
-            if (pid < 0 || static_cast<std::size_t>(pid) >= nPoints)
-            {
-                std::cerr << "removeUnusedPoints: face uses invalid point index "
-                          << pid << " (nPoints=" << nPoints << ")\n";
-                return; // 不继续操作，避免进一步破坏
-            }
-            used[pid] = 1;
+            std::cerr << "removeUnusedPoints: face uses invalid point index "
+                      << pid << " (nPoints=" << nPoints << ")\n";
+            return; // 不继续操作，避免进一步破坏
         }
+        used[pid] = 1;
     }
 
     // 2) 建立 old -> new 的编号映射，只给被使用的点分配新编号
-    std::vector<int> oldToNew(nPoints, -1);
+    ScratchVector<label> oldToNew(nPoints, -1);
     std::vector<Point> newPoints;
     newPoints.reserve(nPoints);
 
-    int newIndex = 0;
+    label newIndex = 0;
     for (std::size_t i = 0; i < nPoints; ++i)
     {
         if (used[i])
@@ -55,24 +59,21 @@ void removeUnusedPoints(MeshData& mesh)
     }
 
     // 3) 用映射更新所有 faces 中的点索引
-    for (auto& f : mesh.faces)
+    for (label& v : mesh.faces.verts)
     {
-        for (int k = 0; k < 4; ++k)
+        label nid = oldToNew[v];
+        if (nid < 0)
         {
-            int oldId = f[k];
-            int nid   = oldToNew[oldId];
-            if (nid < 0)
-            {
-                std::cerr << "removeUnusedPoints: face references unused point "
-                          << oldId << " after marking.\n";
-                return;
-            }
-            f[k] = nid;
+            std::cerr << "removeUnusedPoints: face references unused point "
+                      << v << " after marking.\n";
+            return;
         }
+        v = nid;
     }
 
-    // 4) 替换点数组
+    // 4) 替换点数组（包围盒可能变化，几何缓存作废）
     mesh.points.swap(newPoints);
+    invalidateGeometry(mesh);
 
     std::cout << "removeUnusedPoints: compacted points from "
               << nPoints << " to " << mesh.points.size() << "\n";
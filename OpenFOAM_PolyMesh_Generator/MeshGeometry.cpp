@@ -0,0 +1,234 @@
+#include "MeshGeometry.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+namespace
+{
+
+// [b, e) 内各面的面心与面积矢量。N > 0 时所有面都是 N 边形（编译期定长，内层循环可展开），
+// N == 0 时按偏移表逐面取边数；两者的运算顺序相同，结果逐位一致。
+template <std::size_t N>
+void faceRange(const MeshData& mesh, std::size_t b, std::size_t e, MeshGeometry& g)
+{
+    const Point* pts     = mesh.points.data();
+    const label* verts   = mesh.faces.verts.data();
+    const label* offsets = mesh.faces.offsets.data();
+
+    for (std::size_t f = b; f < e; ++f)
+    {
+        const label* fv = verts + offsets[f];
+        const std::size_t nv = N > 0 ? N : static_cast<std::size_t>(offsets[f + 1] - offsets[f]);
+
+        double cx = 0.0, cy = 0.0, cz = 0.0;
+        for (std::size_t k = 0; k < nv; ++k)
+        {
+            cx += pts[fv[k]].x;
+            cy += pts[fv[k]].y;
+            cz += pts[fv[k]].z;
+        }
+        const double dn = static_cast<double>(nv);
+        cx /= dn; cy /= dn; cz /= dn;
+
+        double sx = 0.0, sy = 0.0, sz = 0.0;
+        for (std::size_t k = 0; k < nv; ++k)
+        {
+            const Point& p = pts[fv[k]];
+            const Point& q = pts[fv[(k + 1) % nv]];
+            const double ax = p.x - cx, ay = p.y - cy, az = p.z - cz;
+            const double bx = q.x - cx, by = q.y - cy, bz = q.z - cz;
+            sx += 0.5 * (ay * bz - az * by);
+            sy += 0.5 * (az * bx - ax * bz);
+            sz += 0.5 * (ax * by - ay * bx);
+        }
+
+        g.faceCentreX[f] = cx; g.faceCentreY[f] = cy; g.faceCentreZ[f] = cz;
+        g.faceAreaX[f]   = sx; g.faceAreaY[f]   = sy; g.faceAreaZ[f]   = sz;
+    }
+}
+
+} // namespace
+
+void buildCellFaces(const MeshData& mesh, std::size_t nCells,
+                    ScratchVector<std::size_t>& cellStart, ScratchVector<label>& cellFaces)
+{
+    const std::size_t nFaces    = mesh.faces.size();
+    const std::size_t nInternal = mesh.neighbour.size();
+
+    cellStart.assign(nCells + 1, 0);
+    cellFaces.resize(nFaces + nInternal);
+
+    std::unique_ptr<std::atomic<std::size_t>[]> cursor(new std::atomic<std::size_t>[nCells + 1]());
+
+    parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t f = b; f < e; ++f)
+        {
+            cursor[mesh.owner[f] + 1].fetch_add(1, std::memory_order_relaxed);
+            if (f < nInternal) cursor[mesh.neighbour[f] + 1].fetch_add(1, std::memory_order_relaxed);
+        }
+    });
+
+    for (std::size_t c = 0; c < nCells; ++c)
+    {
+        cellStart[c + 1] = cellStart[c] + cursor[c + 1].load(std::memory_order_relaxed);
+        cursor[c].store(cellStart[c], std::memory_order_relaxed);
+    }
+
+    parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t f = b; f < e; ++f)
+        {
+            cellFaces[cursor[mesh.owner[f]].fetch_add(1, std::memory_order_relaxed)] = static_cast<label>(f);
+            if (f < nInternal)
+            {
+                cellFaces[cursor[mesh.neighbour[f]].fetch_add(1, std::memory_order_relaxed)] = static_cast<label>(f);
+            }
+        }
+    });
+
+    // 段内次序依线程调度而定，排好后下游的求和结果才确定
+    parallelFor(nCells, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t c = b; c < e; ++c)
+        {
+            std::sort(cellFaces.data() + cellStart[c], cellFaces.data() + cellStart[c + 1]);
+        }
+    }, 1024);
+}
+
+MeshGeometry computeGeometry(const MeshData& mesh)
+{
+    ScopedStage stage("meshGeometry");
+    ScratchFrame scratch;
+
+    const std::size_t nFaces    = mesh.faces.size();
+    const std::size_t nPoints   = mesh.points.size();
+
+    label maxCell = -1;
+    for (label c : mesh.owner)     maxCell = std::max(maxCell, c);
+    for (label c : mesh.neighbour) maxCell = std::max(maxCell, c);
+    const std::size_t nCells = static_cast<std::size_t>(maxCell + 1);
+
+    MeshGeometry g;
+    g.nCells = nCells;
+    stage.setCells(nCells);
+    stage.setFaces(nFaces);
+
+    // 1) 面心 / 面积矢量
+    for (auto* v : {&g.faceCentreX, &g.faceCentreY, &g.faceCentreZ, &g.faceAreaX, &g.faceAreaY, &g.faceAreaZ})
+    {
+        v->resize(nFaces);
+    }
+    const bool quads = mesh.faces.allQuads();
+    parallelFor(nFaces, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        if (quads) faceRange<4>(mesh, b, e, g);
+        else       faceRange<0>(mesh, b, e, g);
+    });
+
+    // 2) cell -> faces 的 CSR；面的方向由 owner 判断（owner 为该 cell 时朝外）
+    ScratchVector<std::size_t> cellStart;
+    ScratchVector<label>       cellFaces;
+    buildCellFaces(mesh, nCells, cellStart, cellFaces);
+
+    // 3) cell 体积、体心（以面心平均为顶点的棱锥分解）与封闭性
+    for (auto* v : {&g.cellCentreX, &g.cellCentreY, &g.cellCentreZ, &g.cellVolume, &g.cellClosure})
+    {
+        v->resize(nCells);
+    }
+    parallelFor(nCells, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t c = b; c < e; ++c)
+        {
+            const std::size_t s0 = cellStart[c], s1 = cellStart[c + 1];
+
+            double sumSx = 0.0, sumSy = 0.0, sumSz = 0.0, sumMagS = 0.0;
+            double ex = 0.0, ey = 0.0, ez = 0.0;
+            for (std::size_t k = s0; k < s1; ++k)
+            {
+                const std::size_t f = static_cast<std::size_t>(cellFaces[k]);
+                const double sign = static_cast<std::size_t>(mesh.owner[f]) == c ? 1.0 : -1.0;
+                const double Sx = g.faceAreaX[f], Sy = g.faceAreaY[f], Sz = g.faceAreaZ[f];
+                sumSx += sign * Sx; sumSy += sign * Sy; sumSz += sign * Sz;
+                sumMagS += std::sqrt(Sx * Sx + Sy * Sy + Sz * Sz);
+                ex += g.faceCentreX[f]; ey += g.faceCentreY[f]; ez += g.faceCentreZ[f];
+            }
+            const double nf = s1 > s0 ? double(s1 - s0) : 1.0;
+            ex /= nf; ey /= nf; ez /= nf;
+
+            const double magSumS = std::sqrt(sumSx * sumSx + sumSy * sumSy + sumSz * sumSz);
+            g.cellClosure[c] = s1 == s0        ? std::numeric_limits<double>::infinity()
+                             : sumMagS > 0.0   ? magSumS / sumMagS
+                                               : 0.0;
+
+            double vol = 0.0, cx = 0.0, cy = 0.0, cz = 0.0;
+            for (std::size_t k = s0; k < s1; ++k)
+            {
+                const std::size_t f = static_cast<std::size_t>(cellFaces[k]);
+                const double sign = static_cast<std::size_t>(mesh.owner[f]) == c ? 1.0 : -1.0;
+                const double fx = g.faceCentreX[f], fy = g.faceCentreY[f], fz = g.faceCentreZ[f];
+                const double pv = sign * (g.faceAreaX[f] * (fx - ex) + g.faceAreaY[f] * (fy - ey)
+                                          + g.faceAreaZ[f] * (fz - ez)) / 3.0;
+                vol += pv;
+                cx += pv * (0.75 * fx + 0.25 * ex);
+                cy += pv * (0.75 * fy + 0.25 * ey);
+                cz += pv * (0.75 * fz + 0.25 * ez);
+            }
+
+            g.cellVolume[c] = vol;
+            if (std::fabs(vol) > std::numeric_limits<double>::min())
+            {
+                g.cellCentreX[c] = cx / vol; g.cellCentreY[c] = cy / vol; g.cellCentreZ[c] = cz / vol;
+            }
+            else
+            {
+                g.cellCentreX[c] = ex; g.cellCentreY[c] = ey; g.cellCentreZ[c] = ez;
+            }
+        }
+    });
+
+    // 4) 点的包围盒：各块分别求，再合并
+    if (nPoints > 0)
+    {
+        const unsigned nChunks = parallelChunkCount(nPoints);
+        std::vector<Point> lo(nChunks, mesh.points[0]), hi(nChunks, mesh.points[0]);
+        parallelFor(nPoints, [&](std::size_t b, std::size_t e, unsigned chunk)
+        {
+            Point l = lo[chunk], h = hi[chunk];
+            for (std::size_t p = b; p < e; ++p)
+            {
+                const Point& q = mesh.points[p];
+                l.x = std::min(l.x, q.x); l.y = std::min(l.y, q.y); l.z = std::min(l.z, q.z);
+                h.x = std::max(h.x, q.x); h.y = std::max(h.y, q.y); h.z = std::max(h.z, q.z);
+            }
+            lo[chunk] = l;
+            hi[chunk] = h;
+        });
+        g.boundsMin = lo[0];
+        g.boundsMax = hi[0];
+        for (unsigned c = 1; c < nChunks; ++c)
+        {
+            g.boundsMin = {std::min(g.boundsMin.x, lo[c].x), std::min(g.boundsMin.y, lo[c].y),
+                           std::min(g.boundsMin.z, lo[c].z)};
+            g.boundsMax = {std::max(g.boundsMax.x, hi[c].x), std::max(g.boundsMax.y, hi[c].y),
+                           std::max(g.boundsMax.z, hi[c].z)};
+        }
+    }
+
+    return g;
+}
+
+const MeshGeometry& meshGeometry(const MeshData& mesh)
+{
+    return mesh.geometry.get([&mesh]()
+    {
+        return std::make_shared<const MeshGeometry>(computeGeometry(mesh));
+    });
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include "MeshTypes.h"
+#include "ScratchArena.h"
+
+// 网格的面 / cell 几何量，按分量分开存放（structure of arrays）：
+// - 面心、面积矢量：三角扇形分解，法向按顶点顺序右手定则（与 checkMesh 相同）
+// - cell 体心、体积：以面心平均为顶点的棱锥分解
+// - cellClosure：|sum(Sf)| / sum(|Sf|)，封闭 cell 为 0（没有面的 cell 为无穷大）
+// - 所有点的包围盒
+// 一次并行计算全部量：面一遍、cell 一遍、点一遍。
+struct MeshGeometry
+{
+    std::size_t nCells = 0;   // 由 owner / neighbour 推出
+
+    std::vector<double> faceCentreX, faceCentreY, faceCentreZ;
+    std::vector<double> faceAreaX,   faceAreaY,   faceAreaZ;
+    std::vector<double> cellCentreX, cellCentreY, cellCentreZ;
+    std::vector<double> cellVolume;
+    std::vector<double> cellClosure;
+
+    Point boundsMin{0.0, 0.0, 0.0};
+    Point boundsMax{0.0, 0.0, 0.0};
+
+    Point faceCentre(std::size_t f) const { return {faceCentreX[f], faceCentreY[f], faceCentreZ[f]}; }
+    Point faceArea(std::size_t f) const   { return {faceAreaX[f], faceAreaY[f], faceAreaZ[f]}; }
+    Point cellCentre(std::size_t c) const { return {cellCentreX[c], cellCentreY[c], cellCentreZ[c]}; }
+};
+
+// cell -> face 的 CSR：cell c 的面为 cellFaces[cellStart[c] .. cellStart[c+1])，每段按面编号
+// 升序（内部面在 owner、neighbour 两侧各出现一次）。两遍并行（原子游标计数、填入）后逐段排序，
+// 结果与线程数无关。nCells 须覆盖 owner / neighbour 中的所有编号。
+void buildCellFaces(const MeshData& mesh, std::size_t nCells,
+                    ScratchVector<std::size_t>& cellStart, ScratchVector<label>& cellFaces);
+
+// 计算网格的几何量（不读写缓存）。点 / cell 编号须合法（checkMesh 的拓扑检查通过）。
+MeshGeometry computeGeometry(const MeshData& mesh);
+
+// 网格的几何缓存：第一次调用时计算并挂到 mesh.geometry，之后直接返回。
+// 可在多个线程上对同一网格并发调用（第一次计算在 GeometryCache 的锁内进行）；
+// MeshData 的拷贝不带缓存，第一次用到时重新计算。
+const MeshGeometry& meshGeometry(const MeshData& mesh);
+
+// 丢弃缓存。修改点坐标或拓扑（faces / owner / neighbour 及其顺序）之后必须调用；
+// removeUnusedPoints、applyPatchRules 等就地修改网格的函数已自行调用。
+inline void invalidateGeometry(MeshData& mesh)
+{
+    mesh.geometry.reset();
+}
@@ -0,0 +1,234 @@
+#include "MeshHierarchy.h"
+#include "FoamHeader.h"
+#include "GzipStream.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+namespace
+{
+
+// 细一级 (i, j, k) 所在粗 cell 的编号
+struct CoarseIndex
+{
+    int Nx, Ny, Nz;   // 细一级
+    int fz;           // z 方向的加密倍数（2 或 1）
+    int cNx, cNy;
+
+    CoarseIndex(const MeshData& fineBg)
+        : Nx(fineBg.Nx), Ny(fineBg.Ny), Nz(fineBg.Nz), fz(fineBg.Nz > 1 ? 2 : 1),
+          cNx(fineBg.Nx / 2), cNy(fineBg.Ny / 2)
+    {
+    }
+
+    std::size_t operator()(std::size_t c) const
+    {
+        const std::size_t i = c % Nx;
+        const std::size_t j = c / Nx % Ny;
+        const std::size_t k = c / (static_cast<std::size_t>(Nx) * Ny);
+        return (k / fz * cNy + j / 2) * cNx + i / 2;
+    }
+};
+
+void checkCoarsenable(const MeshData& fineBg, const std::vector<char>& fineKeep, const char* who)
+{
+    const std::size_t nCells = static_cast<std::size_t>(fineBg.Nx) * fineBg.Ny * fineBg.Nz;
+    if (fineKeep.size() != nCells)
+    {
+        std::cerr << who << ": keep map has " << fineKeep.size() << " entries for "
+                  << nCells << " background cells\n";
+        std::exit(1);
+    }
+    if (fineBg.Nx % 2 || fineBg.Ny % 2 || (fineBg.Nz > 1 && fineBg.Nz % 2))
+    {
+        std::cerr << who << ": cannot halve " << fineBg.Nx << "x" << fineBg.Ny << "x" << fineBg.Nz
+                  << " (cell counts must be even)\n";
+        std::exit(1);
+    }
+}
+
+} // namespace
+
+label coarsenKeepMask(const MeshData& fineBg, const std::vector<char>& fineKeep,
+                    CoarsenRule rule, std::vector<char>& coarseKeep)
+{
+    ScopedStage stage("coarsenMask");
+    checkCoarsenable(fineBg, fineKeep, "coarsenKeepMask");
+
+    const CoarseIndex idx(fineBg);
+    const int Nx = fineBg.Nx;
+    const int Ny = fineBg.Ny;
+    const int cNz = fineBg.Nz / idx.fz;
+    const std::size_t nCoarse = static_cast<std::size_t>(idx.cNx) * idx.cNy * cNz;
+    const std::size_t sliceXY = static_cast<std::size_t>(Nx) * Ny;
+    stage.setCells(nCoarse);
+
+    coarseKeep.assign(nCoarse, 0);
+    std::vector<std::size_t> chunkKept(parallelChunkCount(nCoarse));
+
+    parallelFor(nCoarse, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::size_t kept = 0;
+        for (std::size_t cc = b; cc < e; ++cc)
+        {
+            const std::size_t ci = cc % idx.cNx;
+            const std::size_t cj = cc / idx.cNx % idx.cNy;
+            const std::size_t ck = cc / (static_cast<std::size_t>(idx.cNx) * idx.cNy);
+            const std::size_t c0 = ck * idx.fz * sliceXY + 2 * cj * Nx + 2 * ci;
+
+            std::array<char, 8> labels;
+            int nChildren = 0;
+            int nKept = 0;
+            for (int dk = 0; dk < idx.fz; ++dk)
+            {
+                for (int dj = 0; dj < 2; ++dj)
+                {
+                    for (int di = 0; di < 2; ++di)
+                    {
+                        const char r = fineKeep[c0 + dk * sliceXY + dj * Nx + di];
+                        ++nChildren;
+                        if (r) labels[nKept++] = r;
+                    }
+                }
+            }
+
+            const bool keep = rule == CoarsenRule::any ? nKept > 0 : nKept == nChildren;
+            if (!keep) continue;
+
+            // 子 cell 中出现最多的区域编号
+            char best = 0;
+            int  bestCount = 0;
+            for (int a = 0; a < nKept; ++a)
+            {
+                int count = 0;
+                for (int o = 0; o < nKept; ++o) count += labels[o] == labels[a];
+                if (count > bestCount || (count == bestCount && labels[a] < best))
+                {
+                    best = labels[a];
+                    bestCount = count;
+                }
+            }
+            coarseKeep[cc] = best;
+            ++kept;
+        }
+        chunkKept[chunk] = kept;
+    });
+
+    std::size_t total = 0;
+    for (std::size_t k : chunkKept) total += k;
+    return static_cast<label>(total);
+}
+
+std::vector<label> parentCellMap(const MeshData& fineBg, const std::vector<char>& fineKeep,
+                               const std::vector<char>& coarseKeep)
+{
+    ScopedStage stage("parentCellMap");
+    checkCoarsenable(fineBg, fineKeep, "parentCellMap");
+
+    const CoarseIndex idx(fineBg);
+
+    // 粗一级的压缩编号
+    ScratchFrame scratch;
+    ScratchVector<label> coarseMap(coarseKeep.size(), -1);
+    label nCoarse = 0;
+    for (std::size_t cc = 0; cc < coarseKeep.size(); ++cc)
+    {
+        if (coarseKeep[cc]) coarseMap[cc] = nCoarse++;
+    }
+
+    // 细一级：各块先数保留 cell，前缀和得到起始编号，再并行填写
+    const std::size_t nFine = fineKeep.size();
+    std::vector<std::size_t> chunkStart(parallelChunkCount(nFine) + 1, 0);
+    parallelFor(nFine, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::size_t kept = 0;
+        for (std::size_t c = b; c < e; ++c) kept += fineKeep[c] != 0;
+        chunkStart[chunk + 1] = kept;
+    });
+    for (std::size_t k = 1; k < chunkStart.size(); ++k) chunkStart[k] += chunkStart[k - 1];
+
+    std::vector<label> parent(chunkStart.back(), -1);
+    parallelFor(nFine, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::size_t out = chunkStart[chunk];
+        for (std::size_t c = b; c < e; ++c)
+        {
+            if (fineKeep[c]) parent[out++] = coarseMap[idx(c)];
+        }
+    });
+
+    stage.setCells(parent.size());
+    return parent;
+}
+
+std::string levelDirectory(const std::string& polyMeshDir, int level)
+{
+    if (level == 0)
+    {
+        return polyMeshDir;
+    }
+
+    std::filesystem::path p(polyMeshDir);
+    if (p.filename().empty()) p = p.parent_path();   // 末尾的 '/'
+
+    const std::string suffix = "-level" + std::to_string(level);
+    std::filesystem::path constantDir = p.parent_path();
+    if (p.filename() == "polyMesh" && constantDir.filename() == "constant"
+        && !constantDir.parent_path().empty())
+    {
+        std::filesystem::path caseDir = constantDir.parent_path();
+        return (caseDir.parent_path() / (caseDir.filename().string() + suffix)
+                / "constant" / "polyMesh").string();
+    }
+    return p.string() + suffix;
+}
+
+void writeParentCells(const std::vector<label>& parent, const std::string& directory,
+                      PolyMeshFormat format, PolyMeshCompression compression)
+{
+    ScopedStage stage("parentCells");
+
+    const bool binary = format == PolyMeshFormat::binary;
+    std::filesystem::create_directories(directory);
+    const std::string path = polyMeshFile(directory, "parentCells", compression);
+    auto file = openOutputFile(path, compression == PolyMeshCompression::gzip, std::ios::binary);
+    std::ostream& out = *file;
+    if (!out)
+    {
+        std::cerr << "Cannot open parentCells file for writing.\n";
+        std::exit(1);
+    }
+
+    out << foamHeader("labelList", "polyMesh", "parentCells", binary);
+    out << parent.size() << "\n(";
+    if (binary)
+    {
+        out.write(reinterpret_cast<const char*>(parent.data()),
+                  static_cast<std::streamsize>(parent.size() * sizeof(label)));
+    }
+    else
+    {
+        out << "\n";
+        for (label c : parent)
+        {
+            out << c << "\n";
+        }
+    }
+    out << ")\n\n";
+
+    stage.setCells(parent.size());
+    stage.setBytes(finishPolyMeshFile(out, path));
+}
+
+CoarsenRule coarsenRuleFromString(const std::string& s)
+{
+    if (s == "any") return CoarsenRule::any;
+    if (s == "all") return CoarsenRule::all;
+    std::cerr << "Unknown coarsening rule '" << s << "' (any | all)\n";
+    std::exit(1);
+}
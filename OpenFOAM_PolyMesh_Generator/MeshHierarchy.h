@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+#include "PolyMeshWriter.h"
+
+// 由同一张背景网格的 keep 图推出粗一级（每个方向 cell 数减半，Nz == 1 时 z 方向不变）的 keep 图，
+// 掩模只在最细一级求值一次。粗 cell 与 2x2(x2) 个子 cell 一一对应，几何上严格嵌套，
+// 因此层间映射是直接查表，不需要几何搜索。
+
+enum class CoarsenRule
+{
+    any,   // 任一子 cell 保留则保留（粗网格覆盖细网格）
+    all    // 全部子 cell 保留才保留（粗网格包含于细网格）
+};
+
+// fineKeep 为 fineBg 上的 keep 图（可为区域编号）；粗 cell 的区域取保留子 cell 中最多的编号
+// （并列时取较小者）。fineBg 的 Nx / Ny（及 Nz > 1 时的 Nz）须为偶数。返回粗一级保留数。
+label coarsenKeepMask(const MeshData& fineBg, const std::vector<char>& fineKeep,
+                      CoarsenRule rule, std::vector<char>& coarseKeep);
+
+// 压缩编号下的父 cell 映射：parent[fine] 为细一级保留 cell 所在粗 cell 的编号，
+// 粗 cell 被删（只在 CoarsenRule::all 时出现）则为 -1。
+std::vector<label> parentCellMap(const MeshData& fineBg, const std::vector<char>& fineKeep,
+                               const std::vector<char>& coarseKeep);
+
+// 第 level 级的 polyMesh 目录：<case>/constant/polyMesh -> <case>-level<l>/constant/polyMesh，
+// 其他路径直接加后缀 -level<l>；level 0 不变
+std::string levelDirectory(const std::string& polyMeshDir, int level);
+
+// 把 parentCellMap 写成 directory/parentCells（labelList）
+void writeParentCells(const std::vector<label>& parent, const std::string& directory,
+                      PolyMeshFormat format,
+                      PolyMeshCompression compression = PolyMeshCompression::none);
+
+CoarsenRule coarsenRuleFromString(const std::string& s);
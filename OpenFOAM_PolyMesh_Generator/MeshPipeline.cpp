@@ -0,0 +1,332 @@
+#include "MeshPipeline.h"
+#include "FoamHeader.h"
+#include "GzipStream.h"
+#include "Profiler.h"
+#include "SparseMask.h"
+#include "TaskPool.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+static_assert(sizeof(Point) == 3 * sizeof(double), "Point must be three packed doubles");
+static_assert(sizeof(Face) == 4 * sizeof(label), "quad face must be four packed labels");
+
+namespace
+{
+
+constexpr unsigned blocksPerWorker = 2;   // 每个工作线程最多领先写出线程的块数
+
+void appendLabel(std::string& s, label v)
+{
+    char buf[24];
+    const auto r = std::to_chars(buf, buf + sizeof buf, v);
+    s.append(buf, r.ptr);
+}
+
+// 与 std::ostream 的默认浮点格式（%g，6 位有效数字）逐字节相同
+void appendScalar(std::string& s, double v)
+{
+    char buf[32];
+    const int n = std::snprintf(buf, sizeof buf, "%g", v);
+    s.append(buf, static_cast<std::size_t>(n));
+}
+
+template <class T>
+void appendRaw(std::string& s, const std::vector<T>& v)
+{
+    s.append(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+void appendFaces(std::string& s, const std::vector<Face>& faces, bool binary)
+{
+    if (binary)
+    {
+        appendRaw(s, faces);
+        return;
+    }
+    for (const auto& f : faces)
+    {
+        s += "4(";
+        appendLabel(s, f[0]); s += ' ';
+        appendLabel(s, f[1]); s += ' ';
+        appendLabel(s, f[2]); s += ' ';
+        appendLabel(s, f[3]); s += ")\n";
+    }
+}
+
+void appendLabels(std::string& s, const std::vector<label>& v, bool binary)
+{
+    if (binary)
+    {
+        appendRaw(s, v);
+        return;
+    }
+    for (label c : v)
+    {
+        appendLabel(s, c);
+        s += '\n';
+    }
+}
+
+// 一块格式化好的输出：内部面部分按块顺序直接写出，边界面部分留到内部面全部写完
+struct FormattedBlock
+{
+    std::string points;
+    std::string faces;
+    std::string owner;
+    std::string neighbour;
+    std::vector<std::string> patchFaces;   // 按默认 patch
+    std::vector<std::string> patchOwner;
+    std::vector<RegionFace>  regionFaces;
+};
+
+void formatBlock(SparseMeshBlock& blk, bool binary, FormattedBlock& out)
+{
+    if (binary)
+    {
+        appendRaw(out.points, blk.points);
+    }
+    else
+    {
+        for (const Point& p : blk.points)
+        {
+            out.points += '(';
+            appendScalar(out.points, p.x); out.points += ' ';
+            appendScalar(out.points, p.y); out.points += ' ';
+            appendScalar(out.points, p.z); out.points += ")\n";
+        }
+    }
+    appendFaces(out.faces, blk.faces, binary);
+    appendLabels(out.owner, blk.owner, binary);
+    appendLabels(out.neighbour, blk.neighbour, binary);
+
+    out.patchFaces.resize(blk.patchFaces.size());
+    out.patchOwner.resize(blk.patchFaces.size());
+    for (std::size_t p = 0; p < blk.patchFaces.size(); ++p)
+    {
+        appendFaces(out.patchFaces[p], blk.patchFaces[p], binary);
+        appendLabels(out.patchOwner[p], blk.patchOwner[p], binary);
+    }
+    out.regionFaces = std::move(blk.regionFaces);
+}
+
+// 一个按顺序追加写出的 polyMesh 文件
+struct StreamedFile
+{
+    std::string                   path;
+    std::unique_ptr<std::ostream> out;
+
+    StreamedFile(const std::string& directory, const char* name, PolyMeshCompression compression)
+        : path(polyMeshFile(directory, name, compression)),
+          out(openOutputFile(path, compression == PolyMeshCompression::gzip, std::ios::binary))
+    {
+        if (!*out)
+        {
+            std::cerr << "Cannot open " << name << " file for writing.\n";
+            std::exit(1);
+        }
+    }
+
+    void write(const std::string& s)
+    {
+        out->write(s.data(), static_cast<std::streamsize>(s.size()));
+    }
+};
+
+// list 的开头 / 结尾：ASCII 为 "N\n(\n" ... ")\n;\n\n"，二进制为 "N\n(" ... ")\n\n"
+std::string listHead(std::size_t n, bool binary)
+{
+    return std::to_string(n) + (binary ? "\n(" : "\n(\n");
+}
+
+const char* listTail(bool binary)
+{
+    return binary ? ")\n\n" : ")\n;\n\n";
+}
+
+} // namespace
+
+void writeMeshPipelined(const MeshRequest& request, const std::string& baseDir,
+                        PolyMeshFormat format, PolyMeshCompression compression)
+{
+    using Clock = std::chrono::steady_clock;
+
+    if (request.checkIslands || request.alphaSamples > 0)
+    {
+        throw MeshRequestError("writeMeshPipelined: island checks and alpha need the dense keep map");
+    }
+    if (request.cutSurface || !request.blocks.empty())
+    {
+        throw MeshRequestError("writeMeshPipelined: cut cells and blocks are not supported, use generateMesh");
+    }
+
+    ScopedStage stage("pipeline");
+
+    // 1) 掩模求值：确定 cell / 点 / 面数，之后才能写文件头
+    const SparseKeepMask keep = evaluateSparseMask(request);
+    if (keep.cellCount == 0)
+    {
+        std::cerr << "applyMask: no cells left after masking!\n";
+        std::exit(1);
+    }
+
+    const bool useRegions = static_cast<bool>(request.regions);
+    const std::vector<std::string> noNames;
+    SparseMeshEmitter emitter(request.grid, keep, useRegions ? request.regionNames : noNames);
+    const PatchPlan plan = planPatchRules(emitter.patches(), emitter.nInternalFaces(), request.patches);
+
+    const bool binary = format == PolyMeshFormat::binary;
+    const std::size_t nFaces    = emitter.nFaces();
+    const std::size_t nInternal = emitter.nInternalFaces();
+    const std::size_t nBlocks   = emitter.nBlocks();
+
+    std::filesystem::create_directories(baseDir);
+
+    StreamedFile points   (baseDir, "points",    compression);
+    StreamedFile faces    (baseDir, "faces",     compression);
+    StreamedFile owner    (baseDir, "owner",     compression);
+    StreamedFile neighbour(baseDir, "neighbour", compression);
+
+    points.write(foamHeader("vectorField", "polyMesh", "points", binary)
+                 + listHead(static_cast<std::size_t>(emitter.nPoints()), binary));
+    if (binary)
+    {
+        // faceCompactList：偏移表不依赖面的内容，先整段写出，顶点表随后按块写
+        faces.write(foamHeader("faceCompactList", "polyMesh", "faces", true) + listHead(nFaces + 1, true));
+        std::vector<label> offsets;
+        for (std::size_t s = 0; s <= nFaces; s += 1u << 16)
+        {
+            offsets.clear();
+            for (std::size_t i = s; i < std::min(nFaces + 1, s + (1u << 16)); ++i)
+            {
+                offsets.push_back(static_cast<label>(4 * i));
+            }
+            std::string bytes;
+            appendRaw(bytes, offsets);
+            faces.write(bytes);
+        }
+        faces.write(listTail(true) + listHead(4 * nFaces, true));
+    }
+    else
+    {
+        faces.write(foamHeader("faceList", "polyMesh", "faces", false) + listHead(nFaces, false));
+    }
+    owner.write(foamHeader("labelList", "polyMesh", "owner", binary) + listHead(nFaces, binary));
+    neighbour.write(foamHeader("labelList", "polyMesh", "neighbour", binary) + listHead(nInternal, binary));
+
+    // 2) + 3) 任务池生成并格式化各块，调用线程按块顺序写出；最多领先 window 块
+    TaskPool pool;
+    const std::size_t window = static_cast<std::size_t>(blocksPerWorker) * pool.size();
+    std::vector<SparseMeshBlock> scratch(pool.size());
+    std::vector<std::unique_ptr<FormattedBlock>> slots(window);
+    std::mutex mutex;
+    std::condition_variable ready;
+
+    auto submit = [&](std::size_t b)
+    {
+        pool.submit([&, b](unsigned worker)
+        {
+            auto f = std::make_unique<FormattedBlock>();
+            emitter.emit(b, scratch[worker]);
+            formatBlock(scratch[worker], binary, *f);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                slots[b % window] = std::move(f);
+            }
+            ready.notify_all();
+        });
+    };
+
+    for (std::size_t b = 0; b < std::min(window, nBlocks); ++b)
+    {
+        submit(b);
+    }
+
+    std::vector<std::vector<std::string>> patchFaces(emitter.patches().size());
+    std::vector<std::vector<std::string>> patchOwner(patchFaces.size());
+    std::vector<FaceZone> faceZones;
+    double waitSeconds  = 0.0;
+    double writeSeconds = 0.0;
+
+    for (std::size_t b = 0; b < nBlocks; ++b)
+    {
+        std::unique_ptr<FormattedBlock> blk;
+        {
+            const auto t0 = Clock::now();
+            std::unique_lock<std::mutex> lock(mutex);
+            ready.wait(lock, [&]() { return slots[b % window] != nullptr; });
+            blk = std::move(slots[b % window]);
+            waitSeconds += std::chrono::duration<double>(Clock::now() - t0).count();
+        }
+        if (b + window < nBlocks)
+        {
+            submit(b + window);
+        }
+
+        const auto t0 = Clock::now();
+        points.write(blk->points);
+        faces.write(blk->faces);
+        owner.write(blk->owner);
+        neighbour.write(blk->neighbour);
+        writeSeconds += std::chrono::duration<double>(Clock::now() - t0).count();
+
+        for (std::size_t p = 0; p < patchFaces.size(); ++p)
+        {
+            patchFaces[p].push_back(std::move(blk->patchFaces[p]));
+            patchOwner[p].push_back(std::move(blk->patchOwner[p]));
+        }
+        if (useRegions)
+        {
+            emitter.appendFaceZones(blk->regionFaces, faceZones);
+        }
+    }
+    pool.wait();
+
+    // 边界面：按规则应用后的 patch 顺序，每个 patch 内依次为其原 patch、各块
+    for (const std::vector<std::size_t>& group : plan.sources)
+    {
+        for (std::size_t p : group)
+        {
+            for (std::size_t b = 0; b < nBlocks; ++b)
+            {
+                faces.write(patchFaces[p][b]);
+                owner.write(patchOwner[p][b]);
+            }
+        }
+    }
+
+    std::uint64_t totalBytes = 0;
+    for (StreamedFile* f : {&points, &faces, &owner, &neighbour})
+    {
+        f->write(listTail(binary));
+        totalBytes += finishPolyMeshFile(*f->out, f->path);
+    }
+
+    // boundary / zone 文件：只需要 patch 表与 zone
+    MeshData meta;
+    meta.patches = plan.patches;
+    if (useRegions)
+    {
+        meta.cellZones = emitter.cellZones();
+        meta.faceZones = std::move(faceZones);
+    }
+    totalBytes += writePolyMeshBoundary(meta, baseDir, compression);
+    totalBytes += writePolyMeshZones(meta, baseDir, format, compression);
+
+    stage.setCells(static_cast<std::uint64_t>(keep.cellCount));
+    stage.setFaces(nFaces);
+    stage.setBytes(totalBytes);
+
+    std::cout << "pipeline: " << keep.cellCount << " cells, " << nFaces << " faces in " << nBlocks
+              << " blocks; writer busy " << writeSeconds << " s, waited " << waitSeconds << " s for blocks\n";
+    std::cout << (binary ? "polyMesh (binary) written to " : "polyMesh written to ") << baseDir << "\n";
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <string>
+#include "PolyMeshGen.h"
+#include "PolyMeshWriter.h"
+
+// 流水线模式：生成与写盘重叠进行，墙钟时间接近 max(计算, I/O) 而不是两者之和。
+//   1) 掩模求值（sparse，游程 keep 图）：各文件头里的点数 / 面数要先知道，这一步先整体完成，
+//      结果只与保留的 cell 成正比
+//   2) 面生成 + 格式化：按 SparseMeshEmitter 的块（固定行数的背景行）投到任务池，
+//      每块格式化成 points / faces / owner / neighbour 的文本（或二进制字节）
+//   3) 写出：调用线程按块顺序依次追加到各文件；已领先写出的块数有上限（有界队列），
+//      内存只与窗口内的块及边界面成正比
+// 边界面（及 patch 合并）在内部面之后按 patch 顺序写出，结果与
+// generateMesh（sparse）+ writePolyMesh 逐字节相同。不支持 checkIslands / alphaSamples
+// （与 cut cell、多块一样抛出 MeshRequestError）。
+void writeMeshPipelined(const MeshRequest& request, const std::string& directory,
+                        PolyMeshFormat format = PolyMeshFormat::ascii,
+                        PolyMeshCompression compression = PolyMeshCompression::none);
@@ -3,6 +3,80 @@
 
 #include <vector>
 #include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+
+// Build options of the library (CMake writes PMGConfig.h and installs it with the headers;
+// the Xcode project has none and uses the defaults).
+#if __has_include("PMGConfig.h")
+#include "PMGConfig.h"
+#endif
+
+// Point / face / cell index type. 32-bit by default; build with PMG_LABEL_64
+// (CMake option of the same name) for meshes beyond ~2e9 points or faces.
+// Binary files carry the matching "label=32|64" in their arch header.
+// The width is part of the interface (Face, owner, ...), so users must agree with the library.
+#ifdef PMG_LABEL_64
+using label = std::int64_t;
+#else
+using label = std::int32_t;
+#endif
+
+using Face = std::array<label, 4>;
+
+// Variable-length face list in CSR form: face f is verts[offsets[f] .. offsets[f+1]),
+// i.e. the layout of OpenFOAM's binary faceCompactList. The structured generator and the
+// masking paths only produce quads (Face); cut cells (CutCell.h) add arbitrary n-gons.
+struct FaceList
+{
+    std::vector<label> offsets{0};
+    std::vector<label> verts;
+
+    std::size_t size() const { return offsets.size() - 1; }
+    bool empty() const { return offsets.size() == 1; }
+    std::size_t faceSize(std::size_t f) const
+    {
+        return static_cast<std::size_t>(offsets[f + 1] - offsets[f]);
+    }
+    bool allQuads() const { return verts.size() == 4 * size(); }
+
+    std::span<const label> operator[](std::size_t f) const
+    {
+        return {verts.data() + offsets[f], faceSize(f)};
+    }
+    std::span<label> operator[](std::size_t f)
+    {
+        return {verts.data() + offsets[f], faceSize(f)};
+    }
+
+    void clear()
+    {
+        offsets.assign(1, 0);
+        verts.clear();
+    }
+    void reserve(std::size_t nFaces, std::size_t nVerts)
+    {
+        offsets.reserve(nFaces + 1);
+        verts.reserve(nVerts);
+    }
+    void push_back(std::span<const label> f)
+    {
+        verts.insert(verts.end(), f.begin(), f.end());
+        offsets.push_back(static_cast<label>(verts.size()));
+    }
+    void push_back(const Face& f) { push_back(std::span<const label>(f)); }
+
+    // n quads with zeroed vertices, filled in afterwards through operator[] (parallel fills)
+    void resizeQuads(std::size_t n)
+    {
+        offsets.resize(n + 1);
+        for (std::size_t i = 0; i <= n; ++i) offsets[i] = static_cast<label>(4 * i);
+        verts.assign(4 * n, 0);
+    }
+};
 
 // Simple 3D point
 struct Point
@@ -10,6 +84,77 @@ struct Point
     double x, y, z;
 };
 
+// Background box grid: [0,Lx] x [0,Ly] x [0,Lz] split into Nx x Ny x Nz cells
+struct GridDescriptor
+{
+    int    Nx = 1;
+    int    Ny = 1;
+    int    Nz = 1;
+    double Lx = 1.0;
+    double Ly = 1.0;
+    double Lz = 1.0;
+};
+
+// Boundary patch: a contiguous range of boundary faces
+struct PatchInfo
+{
+    std::string name;
+    std::string type = "patch";
+    label startFace = 0;
+    label nFaces    = 0;
+};
+
+// Named cell set (polyMesh/cellZones)
+struct CellZone
+{
+    std::string name;
+    std::vector<label> cells;
+};
+
+// Named internal-face set with orientation (polyMesh/faceZones)
+struct FaceZone
+{
+    std::string name;
+    std::vector<label> faces;
+    std::vector<char> flipMap;   // 1: zone normal opposite to the face normal
+};
+
+// Face / cell geometry cache, see MeshGeometry.h
+struct MeshGeometry;
+
+// Holder for the lazily computed geometry of one MeshData. The first meshGeometry() call fills
+// it under the mutex, so concurrent readers of a const mesh are safe. A copy starts empty,
+// because the copy's arrays may be edited independently; a move takes the cache along with
+// the arrays.
+class GeometryCache
+{
+public:
+    GeometryCache() = default;
+    GeometryCache(const GeometryCache&) {}
+    GeometryCache& operator=(const GeometryCache&) { reset(); return *this; }
+    GeometryCache(GeometryCache&& o) noexcept : ptr_(std::move(o.ptr_)) {}
+    GeometryCache& operator=(GeometryCache&& o) noexcept
+    {
+        if (this != &o) ptr_ = std::move(o.ptr_);
+        return *this;
+    }
+
+    // Return the cached geometry, computing it with make() on first use
+    template <class Make>
+    const MeshGeometry& get(Make&& make) const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ptr_) ptr_ = make();
+        return *ptr_;
+    }
+
+    void reset() { ptr_.reset(); }
+
+private:
+    mutable std::mutex                          mutex_;
+    mutable std::shared_ptr<const MeshGeometry> ptr_;
+};
+
 // Mesh data container
 struct MeshData
 {
@@ -18,15 +163,18 @@ struct MeshData
     int Nz = 0;
 
     std::vector<Point> points;
-    std::vector<std::array<int, 4>> faces;   // all faces: internal + boundary
-    std::vector<int> owner;                  // size = nFaces
-    std::vector<int> neighbour;              // size = nInternalFaces
-
-    // Patch information (indices into faces/owner)
-    int startFaceBack   = 0; int nFacesBack   = 0;
-    int startFaceFront  = 0; int nFacesFront  = 0;
-    int startFaceBottom = 0; int nFacesBottom = 0;
-    int startFaceTop    = 0; int nFacesTop    = 0;
-    int startFaceRight  = 0; int nFacesRight  = 0;
-    int startFaceLeft   = 0; int nFacesLeft   = 0;
+    FaceList           faces;       // all faces: internal + boundary
+    std::vector<label> owner;       // size = nFaces
+    std::vector<label> neighbour;   // size = nInternalFaces
+
+    // Patch information (indices into faces/owner), in face order
+    std::vector<PatchInfo> patches;
+
+    // Optional zones (only written when non-empty)
+    std::vector<CellZone> cellZones;
+    std::vector<FaceZone> faceZones;
+
+    // Geometry cache: filled on first use by meshGeometry() (MeshGeometry.h), dropped by
+    // invalidateGeometry() whenever points / faces / owner / neighbour change
+    GeometryCache geometry;
 };
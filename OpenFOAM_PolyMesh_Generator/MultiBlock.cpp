@@ -0,0 +1,589 @@
+#include "MultiBlock.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+
+// 边界面的 patch 编号，顺序与 applyKeepMask 相同
+constexpr int patchReflector = 4;
+
+const char* const patchNames[6] = {"back", "front", "bottom", "top", "reflector", "left"};
+
+// cell 的六个面（xmin, xmax, ymin, ymax, zmin, zmax）落在包围盒上时所在的 patch
+constexpr int sidePatch[6] = {5, patchReflector, 2, 3, 0, 1};
+
+double coord(const Point& p, int d)
+{
+    return d == 0 ? p.x : (d == 1 ? p.y : p.z);
+}
+
+// 接口的两个切向，按坐标轴顺序
+std::array<int, 2> tangents(int axis)
+{
+    return {axis == 0 ? 1 : 0, axis == 2 ? 1 : 2};
+}
+
+struct BlockGeom
+{
+    std::array<int, 3>    n{};
+    std::array<double, 3> lo{};
+    std::array<double, 3> hi{};
+    std::array<double, 3> h{};
+    label                 pointOffset = 0;   // 块内点在合并前的全局编号起点
+    label                 cellOffset  = 0;   // 块内保留 cell 的全局编号起点
+
+    label nPoints() const { return label(n[0] + 1) * (n[1] + 1) * (n[2] + 1); }
+    label nCells() const  { return label(n[0]) * n[1] * n[2]; }
+
+    label pointIndex(int i, int j, int k) const
+    {
+        return label(k) * (n[1] + 1) * (n[0] + 1) + label(j) * (n[0] + 1) + i;
+    }
+    label cellIndex(int i, int j, int k) const
+    {
+        return label(k) * n[1] * n[0] + label(j) * n[0] + i;
+    }
+};
+
+std::vector<BlockGeom> blockGeometry(const std::vector<BlockDescriptor>& blocks)
+{
+    std::vector<BlockGeom> geom(blocks.size());
+    label pointOffset = 0;
+    for (std::size_t b = 0; b < blocks.size(); ++b)
+    {
+        const GridDescriptor& g = blocks[b].grid;
+        if (g.Nx <= 0 || g.Ny <= 0 || g.Nz <= 0 || !(g.Lx > 0.0) || !(g.Ly > 0.0) || !(g.Lz > 0.0))
+        {
+            std::cerr << "assembleBlocks: invalid block '" << blocks[b].name << "' " << g.Nx << "x" << g.Ny
+                      << "x" << g.Nz << ", size " << g.Lx << "x" << g.Ly << "x" << g.Lz << "\n";
+            std::exit(1);
+        }
+
+        BlockGeom& bg = geom[b];
+        bg.n = {g.Nx, g.Ny, g.Nz};
+        const std::array<double, 3> L = {g.Lx, g.Ly, g.Lz};
+        for (int d = 0; d < 3; ++d)
+        {
+            bg.lo[d] = coord(blocks[b].origin, d);
+            bg.hi[d] = bg.lo[d] + L[d];
+            bg.h[d]  = L[d] / bg.n[d];
+        }
+        bg.pointOffset = pointOffset;
+        pointOffset += bg.nPoints();
+    }
+    return geom;
+}
+
+// 所有块的包围盒与几何容差（与 applyKeepMask 相同，取最大边长的 1e-8）
+void boundingBox(const std::vector<BlockGeom>& geom, std::array<double, 3>& lo, std::array<double, 3>& hi,
+                 double& tol)
+{
+    lo = { 1e30,  1e30,  1e30};
+    hi = {-1e30, -1e30, -1e30};
+    for (const BlockGeom& g : geom)
+    {
+        for (int d = 0; d < 3; ++d)
+        {
+            lo[d] = std::min(lo[d], g.lo[d]);
+            hi[d] = std::max(hi[d], g.hi[d]);
+        }
+    }
+    double L = std::max({hi[0] - lo[0], hi[1] - lo[1], hi[2] - lo[2]});
+    if (L <= 0.0) L = 1.0;
+    tol = 1e-8 * L;
+}
+
+// x 在 g 的 d 方向网格线上时返回其编号，否则返回 -1
+int gridLine(const BlockGeom& g, int d, double x, double tol)
+{
+    const double s = (x - g.lo[d]) / g.h[d];
+    const double r = std::round(s);
+    return std::fabs(s - r) * g.h[d] <= tol ? static_cast<int>(r) : -1;
+}
+
+struct BlockFaces
+{
+    std::vector<Face>  internalFaces;
+    std::vector<label> internalOwner;
+    std::vector<label> internalNeighbour;
+
+    std::array<std::vector<Face>, 6>  patchFaces;
+    std::array<std::vector<label>, 6> patchOwner;
+};
+
+} // namespace
+
+std::vector<BlockInterface> findBlockInterfaces(const std::vector<BlockDescriptor>& blocks)
+{
+    const std::vector<BlockGeom> geom = blockGeometry(blocks);
+    std::array<double, 3> lo, hi;
+    double tol = 0.0;
+    boundingBox(geom, lo, hi, tol);
+
+    std::vector<BlockInterface> interfaces;
+    for (std::size_t a = 0; a < geom.size(); ++a)
+    {
+        for (std::size_t b = 0; b < geom.size(); ++b)
+        {
+            if (a == b) continue;
+            const BlockGeom& ga = geom[a];
+            const BlockGeom& gb = geom[b];
+
+            std::array<double, 3> ovLo, ovHi;
+            int nOverlap = 0;
+            for (int d = 0; d < 3; ++d)
+            {
+                ovLo[d] = std::max(ga.lo[d], gb.lo[d]);
+                ovHi[d] = std::min(ga.hi[d], gb.hi[d]);
+                if (ovHi[d] - ovLo[d] > tol) ++nOverlap;
+            }
+            if (nOverlap == 3)
+            {
+                std::cerr << "assembleBlocks: blocks '" << blocks[a].name << "' and '" << blocks[b].name
+                          << "' overlap\n";
+                std::exit(1);
+            }
+
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const std::array<int, 2> t = tangents(axis);
+                if (std::fabs(ga.hi[axis] - gb.lo[axis]) > tol
+                    || !(ovHi[t[0]] - ovLo[t[0]] > tol) || !(ovHi[t[1]] - ovLo[t[1]] > tol))
+                {
+                    continue;
+                }
+
+                // 重叠区间的两端须同时是两块的网格线，且两边夹着同样多的 cell（即步长相同）
+                BlockInterface f;
+                f.lower = a;
+                f.upper = b;
+                f.axis  = axis;
+                bool conformal = true;
+                for (int s = 0; s < 2; ++s)
+                {
+                    const int ia0 = gridLine(ga, t[s], ovLo[t[s]], tol);
+                    const int ia1 = gridLine(ga, t[s], ovHi[t[s]], tol);
+                    const int ib0 = gridLine(gb, t[s], ovLo[t[s]], tol);
+                    const int ib1 = gridLine(gb, t[s], ovHi[t[s]], tol);
+                    if (ia0 < 0 || ia1 < 0 || ib0 < 0 || ib1 < 0 || ia1 - ia0 != ib1 - ib0)
+                    {
+                        conformal = false;
+                        break;
+                    }
+                    f.begin[s]      = ia0;
+                    f.end[s]        = ia1;
+                    f.upperBegin[s] = ib0;
+                }
+                if (!conformal)
+                {
+                    std::cerr << "assembleBlocks: blocks '" << blocks[a].name << "' and '" << blocks[b].name
+                              << "' touch at " << "xyz"[axis] << " = " << ga.hi[axis]
+                              << " but their grid lines do not match there\n";
+                    std::exit(1);
+                }
+                interfaces.push_back(f);
+            }
+        }
+    }
+    return interfaces;
+}
+
+MeshData assembleBlocks(const std::vector<BlockDescriptor>& blocks, const MaskFunc& inDomain,
+                        MultiBlockReport* report)
+{
+    ScopedStage stage("assembleBlocks");
+    ScratchFrame scratch;
+
+    if (blocks.empty())
+    {
+        std::cerr << "assembleBlocks: no blocks given\n";
+        std::exit(1);
+    }
+
+    std::vector<BlockGeom> geom = blockGeometry(blocks);
+    const std::vector<BlockInterface> interfaces = findBlockInterfaces(blocks);
+    const std::size_t nBlocks = geom.size();
+
+    std::array<double, 3> boxLo, boxHi;
+    double tol = 0.0;
+    boundingBox(geom, boxLo, boxHi, tol);
+
+    // 1) 各块在 cell 中心求掩模，块内压缩编号（块间并行）
+    std::vector<std::vector<char>>  keepCell(nBlocks);
+    std::vector<std::vector<label>> cellMap(nBlocks);
+    std::vector<label>              nKept(nBlocks, 0);
+    label nCellsOld = 0;
+    for (const BlockGeom& g : geom) nCellsOld += g.nCells();
+    {
+        ScopedStage maskStage("blockMask");
+        maskStage.setCells(static_cast<std::uint64_t>(nCellsOld));
+
+        parallelFor(nBlocks, [&](std::size_t b0, std::size_t b1, unsigned)
+        {
+            for (std::size_t b = b0; b < b1; ++b)
+            {
+                const BlockGeom& g = geom[b];
+                std::vector<char>&  keep = keepCell[b];
+                std::vector<label>& map  = cellMap[b];
+                keep.assign(static_cast<std::size_t>(g.nCells()), 0);
+                map.assign(static_cast<std::size_t>(g.nCells()), -1);
+
+                label next = 0;
+                for (int k = 0; k < g.n[2]; ++k)
+                {
+                    for (int j = 0; j < g.n[1]; ++j)
+                    {
+                        for (int i = 0; i < g.n[0]; ++i)
+                        {
+                            const Point c{g.lo[0] + (i + 0.5) * g.h[0],
+                                          g.lo[1] + (j + 0.5) * g.h[1],
+                                          g.lo[2] + (k + 0.5) * g.h[2]};
+                            if (inDomain(c))
+                            {
+                                const label cIdx = g.cellIndex(i, j, k);
+                                keep[cIdx] = 1;
+                                map[cIdx]  = next++;
+                            }
+                        }
+                    }
+                }
+                nKept[b] = next;
+            }
+        }, 1);
+    }
+
+    label nCellsNew = 0;
+    for (std::size_t b = 0; b < nBlocks; ++b)
+    {
+        geom[b].cellOffset = nCellsNew;
+        nCellsNew += nKept[b];
+    }
+    if (nCellsNew == 0)
+    {
+        std::cerr << "applyMask: no cells left after masking!\n";
+        std::exit(1);
+    }
+
+    // 2) 接口上的点按索引区间两两合并（并查集，根为最小编号），再按原顺序压缩编号
+    const label nPointsOld = geom.back().pointOffset + geom.back().nPoints();
+    ScratchVector<label> pointId(static_cast<std::size_t>(nPointsOld));
+    MeshData out;
+    {
+        ScopedStage pointStage("blockPoints");
+
+        ScratchVector<label> parent(static_cast<std::size_t>(nPointsOld));
+        for (label p = 0; p < nPointsOld; ++p) parent[p] = p;
+
+        auto root = [&parent](label p)
+        {
+            while (parent[p] != p)
+            {
+                parent[p] = parent[parent[p]];
+                p = parent[p];
+            }
+            return p;
+        };
+
+        for (const BlockInterface& f : interfaces)
+        {
+            const BlockGeom& ga = geom[f.lower];
+            const BlockGeom& gb = geom[f.upper];
+            const std::array<int, 2> t = tangents(f.axis);
+            for (int v = 0; v <= f.end[1] - f.begin[1]; ++v)
+            {
+                for (int u = 0; u <= f.end[0] - f.begin[0]; ++u)
+                {
+                    std::array<int, 3> ia{}, ib{};
+                    ia[f.axis] = ga.n[f.axis];
+                    ib[f.axis] = 0;
+                    ia[t[0]] = f.begin[0] + u;       ia[t[1]] = f.begin[1] + v;
+                    ib[t[0]] = f.upperBegin[0] + u;  ib[t[1]] = f.upperBegin[1] + v;
+
+                    const label pa = root(ga.pointOffset + ga.pointIndex(ia[0], ia[1], ia[2]));
+                    const label pb = root(gb.pointOffset + gb.pointIndex(ib[0], ib[1], ib[2]));
+                    parent[std::max(pa, pb)] = std::min(pa, pb);
+                }
+            }
+        }
+
+        label nPointsNew = 0;
+        for (label p = 0; p < nPointsOld; ++p)
+        {
+            pointId[p] = parent[p] == p ? nPointsNew++ : pointId[root(p)];
+        }
+
+        out.points.resize(static_cast<std::size_t>(nPointsNew));
+        parallelFor(nBlocks, [&](std::size_t b0, std::size_t b1, unsigned)
+        {
+            for (std::size_t b = b0; b < b1; ++b)
+            {
+                const BlockGeom& g = geom[b];
+                for (int k = 0; k <= g.n[2]; ++k)
+                {
+                    for (int j = 0; j <= g.n[1]; ++j)
+                    {
+                        for (int i = 0; i <= g.n[0]; ++i)
+                        {
+                            const label p = g.pointOffset + g.pointIndex(i, j, k);
+                            if (parent[p] == p)
+                            {
+                                out.points[pointId[p]] = Point{g.lo[0] + i * g.h[0],
+                                                               g.lo[1] + j * g.h[1],
+                                                               g.lo[2] + k * g.h[2]};
+                            }
+                        }
+                    }
+                }
+            }
+        }, 1);
+
+        pointStage.setCells(static_cast<std::uint64_t>(nPointsOld - nPointsNew));
+    }
+
+    // 3) 各块边界面对面的 cell：-2 为块外（按包围盒分 patch），-1 为对面被裁掉，否则为全局 cell 编号。
+    //    按接口面在本块该侧的切向 cell 编号 (u + n[t0] * v) 排列，只为有接口的侧建立
+    std::vector<std::array<std::vector<label>, 6>> across(nBlocks);
+    for (const BlockInterface& f : interfaces)
+    {
+        const std::array<int, 2> t = tangents(f.axis);
+        const BlockGeom& ga = geom[f.lower];
+        const BlockGeom& gb = geom[f.upper];
+        std::vector<label>& lowerSide = across[f.lower][2 * f.axis + 1];
+        std::vector<label>& upperSide = across[f.upper][2 * f.axis];
+        if (lowerSide.empty()) lowerSide.assign(static_cast<std::size_t>(ga.n[t[0]]) * ga.n[t[1]], -2);
+        if (upperSide.empty()) upperSide.assign(static_cast<std::size_t>(gb.n[t[0]]) * gb.n[t[1]], -2);
+
+        for (int v = 0; v < f.end[1] - f.begin[1]; ++v)
+        {
+            for (int u = 0; u < f.end[0] - f.begin[0]; ++u)
+            {
+                std::array<int, 3> ia{}, ib{};
+                ia[f.axis] = ga.n[f.axis] - 1;
+                ib[f.axis] = 0;
+                ia[t[0]] = f.begin[0] + u;       ia[t[1]] = f.begin[1] + v;
+                ib[t[0]] = f.upperBegin[0] + u;  ib[t[1]] = f.upperBegin[1] + v;
+
+                const label ca = cellMap[f.lower][ga.cellIndex(ia[0], ia[1], ia[2])];
+                const label cb = cellMap[f.upper][gb.cellIndex(ib[0], ib[1], ib[2])];
+                lowerSide[ia[t[0]] + label(ga.n[t[0]]) * ia[t[1]]] = cb < 0 ? -1 : gb.cellOffset + cb;
+                upperSide[ib[t[0]] + label(gb.n[t[0]]) * ib[t[1]]] = ca < 0 ? -1 : ga.cellOffset + ca;
+            }
+        }
+    }
+
+    // 4) 各块生成面（块间并行）。块内内部面由编号小的 cell 生成；接口面由 lower 块生成，
+    //    owner 取两侧中编号小的 cell，法向朝外
+    std::vector<BlockFaces> blockFaces(nBlocks);
+    {
+        ScopedStage emitStage("faceEmission");
+        emitStage.setCells(static_cast<std::uint64_t>(nCellsNew));
+
+        parallelFor(nBlocks, [&](std::size_t b0, std::size_t b1, unsigned)
+        {
+            for (std::size_t b = b0; b < b1; ++b)
+            {
+                const BlockGeom& g = geom[b];
+                const std::vector<char>&  keep = keepCell[b];
+                const std::vector<label>& map  = cellMap[b];
+                BlockFaces& bf = blockFaces[b];
+
+                // 块的各侧是否落在包围盒上
+                std::array<int, 6> boxPatch{};
+                for (int s = 0; s < 6; ++s)
+                {
+                    const int d = s / 2;
+                    const double plane = (s & 1) ? g.hi[d] : g.lo[d];
+                    const double box   = (s & 1) ? boxHi[d] : boxLo[d];
+                    boxPatch[s] = std::fabs(plane - box) <= tol ? sidePatch[s] : patchReflector;
+                }
+                const std::array<label, 3> stride = {1, label(g.n[0]), label(g.n[0]) * g.n[1]};
+
+                auto addBoundary = [&bf](const Face& f, int patch, label own)
+                {
+                    bf.patchFaces[patch].push_back(f);
+                    bf.patchOwner[patch].push_back(own);
+                };
+                auto addInternal = [&bf](const Face& f, label own, label nbr)
+                {
+                    bf.internalFaces.push_back(f);
+                    bf.internalOwner.push_back(own);
+                    bf.internalNeighbour.push_back(nbr);
+                };
+
+                for (int k = 0; k < g.n[2]; ++k)
+                {
+                    for (int j = 0; j < g.n[1]; ++j)
+                    {
+                        for (int i = 0; i < g.n[0]; ++i)
+                        {
+                            const label cIdx = g.cellIndex(i, j, k);
+                            if (!keep[cIdx]) continue;
+                            const label cNew = g.cellOffset + map[cIdx];
+
+                            auto pt = [&](int di, int dj, int dk)
+                            {
+                                return pointId[g.pointOffset + g.pointIndex(i + di, j + dj, k + dk)];
+                            };
+                            const label p000 = pt(0, 0, 0), p100 = pt(1, 0, 0);
+                            const label p010 = pt(0, 1, 0), p110 = pt(1, 1, 0);
+                            const label p001 = pt(0, 0, 1), p101 = pt(1, 0, 1);
+                            const label p011 = pt(0, 1, 1), p111 = pt(1, 1, 1);
+
+                            // 与 applyKeepMask 相同的朝外顶点顺序：xmin, xmax, ymin, ymax, zmin, zmax
+                            const Face sideFace[6] = {
+                                {p000, p001, p011, p010}, {p100, p110, p111, p101},
+                                {p000, p100, p101, p001}, {p010, p011, p111, p110},
+                                {p000, p010, p110, p100}, {p001, p101, p111, p011}};
+                            const std::array<int, 3> idx = {i, j, k};
+
+                            for (int s = 0; s < 6; ++s)
+                            {
+                                const int  d     = s / 2;
+                                const bool upper = (s & 1) != 0;
+
+                                if (upper ? idx[d] < g.n[d] - 1 : idx[d] > 0)
+                                {
+                                    const label nbr = upper ? cIdx + stride[d] : cIdx - stride[d];
+                                    if (!keep[nbr])
+                                    {
+                                        addBoundary(sideFace[s], patchReflector, cNew);
+                                    }
+                                    else if (upper)
+                                    {
+                                        addInternal(sideFace[s], cNew, g.cellOffset + map[nbr]);
+                                    }
+                                    continue;
+                                }
+
+                                label other = -2;
+                                if (!across[b][s].empty())
+                                {
+                                    const std::array<int, 2> t = tangents(d);
+                                    other = across[b][s][idx[t[0]] + label(g.n[t[0]]) * idx[t[1]]];
+                                }
+
+                                if (other == -2)
+                                {
+                                    addBoundary(sideFace[s], boxPatch[s], cNew);
+                                }
+                                else if (other == -1)
+                                {
+                                    addBoundary(sideFace[s], patchReflector, cNew);
+                                }
+                                else if (upper)
+                                {
+                                    const Face& f = sideFace[s];
+                                    if (cNew < other)
+                                    {
+                                        addInternal(f, cNew, other);
+                                    }
+                                    else
+                                    {
+                                        addInternal(Face{f[0], f[3], f[2], f[1]}, other, cNew);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }, 1);
+    }
+
+    // 5) 内部面按 owner 计数排序（块内已按 owner 有序，接口面插入各自 owner 处），
+    //    同一 owner 的几个面再按 neighbour 排序；边界面按 patch、块顺序拼接
+    std::size_t nInternal = 0;
+    std::size_t nFaces    = 0;
+    for (const BlockFaces& bf : blockFaces)
+    {
+        nInternal += bf.internalFaces.size();
+        nFaces    += bf.internalFaces.size();
+        for (const auto& pf : bf.patchFaces) nFaces += pf.size();
+    }
+
+    out.faces.resizeQuads(nFaces);
+    out.owner.resize(nFaces);
+    out.neighbour.resize(nInternal);
+
+    label nInterfaceFaces = 0;
+    {
+        ScratchVector<label> start(static_cast<std::size_t>(nCellsNew) + 1, 0);
+        for (const BlockFaces& bf : blockFaces)
+        {
+            for (label o : bf.internalOwner) ++start[o + 1];
+        }
+        for (label c = 0; c < nCellsNew; ++c) start[c + 1] += start[c];
+
+        ScratchVector<label> next(start.begin(), start.end() - 1);
+        for (std::size_t b = 0; b < nBlocks; ++b)
+        {
+            const BlockFaces& bf = blockFaces[b];
+            for (std::size_t f = 0; f < bf.internalFaces.size(); ++f)
+            {
+                const label own = bf.internalOwner[f];
+                const label nbr = bf.internalNeighbour[f];
+                if (own < geom[b].cellOffset || nbr >= geom[b].cellOffset + nKept[b]) ++nInterfaceFaces;
+
+                // 插入排序：每个 owner 至多 6 个面
+                label pos = next[own]++;
+                while (pos > start[own] && out.neighbour[pos - 1] > nbr)
+                {
+                    out.owner[pos]     = own;
+                    out.neighbour[pos] = out.neighbour[pos - 1];
+                    std::copy_n(out.faces[pos - 1].begin(), 4, out.faces[pos].begin());
+                    --pos;
+                }
+                out.owner[pos]     = own;
+                out.neighbour[pos] = nbr;
+                std::copy_n(bf.internalFaces[f].begin(), 4, out.faces[pos].begin());
+            }
+        }
+    }
+
+    std::size_t faceStart = nInternal;
+    for (int p = 0; p < 6; ++p)
+    {
+        PatchInfo patch;
+        patch.name      = patchNames[p];
+        patch.startFace = static_cast<label>(faceStart);
+        for (const BlockFaces& bf : blockFaces)
+        {
+            const auto& pFaces = bf.patchFaces[p];
+            for (std::size_t i = 0; i < pFaces.size(); ++i)
+            {
+                std::copy_n(pFaces[i].begin(), 4, out.faces[faceStart + i].begin());
+                out.owner[faceStart + i] = bf.patchOwner[p][i];
+            }
+            faceStart += pFaces.size();
+        }
+        patch.nFaces = static_cast<label>(faceStart) - patch.startFace;
+        out.patches.push_back(patch);
+    }
+
+    stage.setCells(static_cast<std::uint64_t>(nCellsNew));
+    stage.setFaces(nFaces);
+
+    if (report)
+    {
+        report->nCells          = nCellsNew;
+        report->nMergedPoints   = nPointsOld - static_cast<label>(out.points.size());
+        report->nInterfaceFaces = nInterfaceFaces;
+    }
+
+    std::cout << "assembleBlocks: " << nBlocks << " blocks, " << interfaces.size() << " interfaces, "
+              << nInterfaceFaces << " interface faces, " << nPointsOld - static_cast<label>(out.points.size())
+              << " points merged\n";
+    std::cout << "applyMask: old cells = " << nCellsOld << ", new cells = " << nCellsNew << "\n";
+    std::cout << "applyMask: internal faces new = " << nInternal
+              << ", boundary faces = " << (nFaces - nInternal) << "\n";
+
+    return out;
+}
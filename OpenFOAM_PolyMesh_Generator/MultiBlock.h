@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <string>
+#include <vector>
+#include "MeshTypes.h"
+#include "DomainMask.h"
+
+// 多块结构网格中的一块：[origin, origin + (Lx, Ly, Lz)] 的盒子分成 Nx x Ny x Nz 个 cell。
+// 各块的范围与分辨率相互独立，如细长的激波管一块、宽的反射腔一块。
+struct BlockDescriptor
+{
+    std::string    name;
+    Point          origin{0.0, 0.0, 0.0};
+    GridDescriptor grid;
+};
+
+// 两块之间的协调（conformal）接口：lower 块的 +axis 面与 upper 块的 -axis 面共面并有重叠。
+// 切向 t = 0, 1 依次为 axis 之后的两个方向（x: y z，y: x z，z: x y）；重叠部分在 lower 块中为
+// cell 区间 [begin[t], end[t])，在 upper 块中从 upperBegin[t] 起，两边一一对应。
+struct BlockInterface
+{
+    std::size_t        lower = 0;
+    std::size_t        upper = 0;
+    int                axis  = 0;
+    std::array<int, 2> begin{};
+    std::array<int, 2> end{};
+    std::array<int, 2> upperBegin{};
+};
+
+// 找出所有块间接口。接口两侧在切向必须共用同一组网格线（步长相同、重叠区间的端点落在两边的
+// 网格线上），否则打印错误并退出；块之间有体积重叠、块尺寸非法时同样报错退出。
+std::vector<BlockInterface> findBlockInterfaces(const std::vector<BlockDescriptor>& blocks);
+
+struct MultiBlockReport
+{
+    label nCells          = 0;   // 输出的 cell 数
+    label nMergedPoints   = 0;   // 接口上合并掉的重复点数
+    label nInterfaceFaces = 0;   // 两侧都保留、成为内部面的接口面数
+};
+
+// 多块装配：各块分别在 cell 中心求掩模并生成拓扑（块间并行），接口上的点按接口的索引区间直接
+// 合并（不做坐标查找），两侧都保留的接口面成为内部面。
+// cell 按块顺序、块内按结构序编号；内部面按 (owner, neighbour) 排序。边界面按位置分到
+// back / front / bottom / top / reflector / left（与 applyKeepMask 相同，以所有块的包围盒为准），
+// 不在包围盒上的块边界与裁剪出的面进入 reflector。
+// 只有一块且 origin 为 0 时与 generateStructuredMesh + applyMask 的结果相同。
+// 与 applyMask 一样先保留全部点，由调用方 removeUnusedPoints 清理。
+MeshData assembleBlocks(const std::vector<BlockDescriptor>& blocks, const MaskFunc& inDomain,
+                        MultiBlockReport* report = nullptr);
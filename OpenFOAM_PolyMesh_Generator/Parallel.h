@@ -0,0 +1,54 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 极简的并行循环工具：把 [0, n) 切成连续块，每块一个线程。
+// body(begin, end, chunk) 中 chunk 为块编号，可用来写各块自己的局部累加量。
+
+inline unsigned parallelThreadCount()
+{
+    unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1u : hw;
+}
+
+// 对规模 n 实际会切出的块数（minChunk 为每块最少元素数）
+inline unsigned parallelChunkCount(std::size_t n, std::size_t minChunk = 4096)
+{
+    if (minChunk == 0) minChunk = 1;
+    std::size_t byWork = n / minChunk;
+    if (byWork == 0) byWork = 1;
+    return static_cast<unsigned>(std::min<std::size_t>(parallelThreadCount(), byWork));
+}
+
+template <class Body>
+void parallelFor(std::size_t n, Body&& body, std::size_t minChunk = 4096)
+{
+    const unsigned nChunks = parallelChunkCount(n, minChunk);
+    if (nChunks <= 1)
+    {
+        body(std::size_t(0), n, 0u);
+        return;
+    }
+
+    const std::size_t chunkSize = (n + nChunks - 1) / nChunks;
+
+    std::vector<std::thread> workers;
+    workers.reserve(nChunks - 1);
+    for (unsigned c = 1; c < nChunks; ++c)
+    {
+        std::size_t b = std::min(n, c * chunkSize);
+        std::size_t e = std::min(n, b + chunkSize);
+        workers.emplace_back([&body, b, e, c]() { body(b, e, c); });
+    }
+
+    // 第 0 块在调用线程上做
+    body(std::size_t(0), std::min(n, chunkSize), 0u);
+
+    for (auto& t : workers)
+    {
+        t.join();
+    }
+}
@@ -0,0 +1,192 @@
+#include "PolyMeshWriter.h"
+#include "FoamHeader.h"
+#include "GzipStream.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+static_assert(sizeof(Point) == 3 * sizeof(double), "Point must be three packed doubles");
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "binary polyMesh writer assumes a little-endian host (arch LSB)"
+#endif
+
+namespace
+{
+
+// 一个二进制 list：count 个元素，每个 elemSize 字节；
+// fill(dst, b, e) 把元素 [b, e) 写到 dst（dst 已指向元素 b 的位置）
+struct RawList
+{
+    std::size_t count    = 0;
+    std::size_t elemSize = 0;
+    std::function<void(char* dst, std::size_t b, std::size_t e)> fill;
+};
+
+RawList copyList(const void* src, std::size_t count, std::size_t elemSize)
+{
+    RawList l;
+    l.count    = count;
+    l.elemSize = elemSize;
+    l.fill = [src, elemSize](char* dst, std::size_t b, std::size_t e)
+    {
+        std::memcpy(dst, static_cast<const char*>(src) + b * elemSize, (e - b) * elemSize);
+    };
+    return l;
+}
+
+// 按 OpenFOAM 二进制 list 的排布写出：header + 每个 list 为 "N\n(" 原始字节 ")\n\n"
+std::uint64_t writeMappedLists(const std::string& path, const std::string& header,
+                               const std::vector<RawList>& lists)
+{
+    std::vector<std::string> prefix(lists.size());
+    const std::string suffix = ")\n\n";
+
+    std::size_t total = header.size();
+    for (std::size_t i = 0; i < lists.size(); ++i)
+    {
+        prefix[i] = std::to_string(lists[i].count) + "\n(";
+        total += prefix[i].size() + lists[i].count * lists[i].elemSize + suffix.size();
+    }
+
+    MappedFile file(path, MappedFile::writeNew, total);
+    char* p = file.data();
+
+    std::memcpy(p, header.data(), header.size());
+    p += header.size();
+
+    for (std::size_t i = 0; i < lists.size(); ++i)
+    {
+        const RawList& l = lists[i];
+        std::memcpy(p, prefix[i].data(), prefix[i].size());
+        p += prefix[i].size();
+
+        char* base = p;
+        parallelFor(l.count, [&](std::size_t b, std::size_t e, unsigned)
+        {
+            l.fill(base + b * l.elemSize, b, e);
+        }, 1u << 16);
+        p += l.count * l.elemSize;
+
+        std::memcpy(p, suffix.data(), suffix.size());
+        p += suffix.size();
+    }
+
+    return total;
+}
+
+// 同样的排布写进 gzip 流：每个 list 按段（各段内并行）填到缓冲区再送入压缩流
+std::uint64_t writeGzipLists(const std::string& path, const std::string& header,
+                             const std::vector<RawList>& lists)
+{
+    constexpr std::size_t segmentBytes = 16u << 20;
+
+    auto file = openOutputFile(path, true);
+    std::ostream& out = *file;
+    if (!out)
+    {
+        std::cerr << "Cannot open " << path << " for writing.\n";
+        std::exit(1);
+    }
+
+    out << header;
+    std::vector<char> buf;
+    for (const RawList& l : lists)
+    {
+        out << l.count << "\n(";
+        const std::size_t perSegment = std::max<std::size_t>(1, segmentBytes / l.elemSize);
+        for (std::size_t s = 0; s < l.count; s += perSegment)
+        {
+            const std::size_t n = std::min(perSegment, l.count - s);
+            buf.resize(n * l.elemSize);
+            char* base = buf.data();
+            parallelFor(n, [&](std::size_t b, std::size_t e, unsigned)
+            {
+                l.fill(base + b * l.elemSize, s + b, s + e);
+            }, 1u << 16);
+            out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+        }
+        out << ")\n\n";
+    }
+
+    return finishPolyMeshFile(out, path);
+}
+
+} // namespace
+
+void writePolyMeshBinary(const MeshData& mesh, const std::string& baseDir,
+                         PolyMeshCompression compression)
+{
+    ScopedStage stage("writePolyMeshBinary");
+    std::uint64_t totalBytes = 0;
+
+    std::filesystem::create_directories(baseDir);
+
+    const std::size_t nFaces = mesh.faces.size();
+
+    // 已确定大小的文件直接 mmap 填充；gzip 时经压缩流写出
+    auto writeLists = [&](const char* name, const std::string& header, const std::vector<RawList>& lists)
+    {
+        const std::string path = polyMeshFile(baseDir, name, compression);
+        return compression == PolyMeshCompression::gzip ? writeGzipLists(path, header, lists)
+                                                         : writeMappedLists(path, header, lists);
+    };
+
+    // ---- points ----
+    {
+        ScopedStage fileStage("points");
+        std::uint64_t n = writeLists("points",
+            foamHeader("vectorField", "polyMesh", "points", true),
+            {copyList(mesh.points.data(), mesh.points.size(), sizeof(Point))});
+        fileStage.setBytes(n);
+        totalBytes += n;
+    }
+
+    // ---- faces：faceCompactList = 偏移表 (nFaces+1) + 顶点表 ----
+    {
+        ScopedStage fileStage("faces");
+
+        std::uint64_t n = writeLists("faces",
+            foamHeader("faceCompactList", "polyMesh", "faces", true),
+            {copyList(mesh.faces.offsets.data(), nFaces + 1, sizeof(label)),
+             copyList(mesh.faces.verts.data(), mesh.faces.verts.size(), sizeof(label))});
+        fileStage.setBytes(n);
+        totalBytes += n;
+    }
+
+    // ---- owner ----
+    {
+        ScopedStage fileStage("owner");
+        std::uint64_t n = writeLists("owner",
+            foamHeader("labelList", "polyMesh", "owner", true),
+            {copyList(mesh.owner.data(), mesh.owner.size(), sizeof(label))});
+        fileStage.setBytes(n);
+        totalBytes += n;
+    }
+
+    // ---- neighbour ----
+    {
+        ScopedStage fileStage("neighbour");
+        std::uint64_t n = writeLists("neighbour",
+            foamHeader("labelList", "polyMesh", "neighbour", true),
+            {copyList(mesh.neighbour.data(), mesh.neighbour.size(), sizeof(label))});
+        fileStage.setBytes(n);
+        totalBytes += n;
+    }
+
+    // ---- boundary ----
+    totalBytes += writePolyMeshBoundary(mesh, baseDir, compression);
+
+    // ---- cellZones / faceZones ----
+    totalBytes += writePolyMeshZones(mesh, baseDir, PolyMeshFormat::binary, compression);
+
+    stage.setFaces(nFaces);
+    stage.setBytes(totalBytes);
+}
@@ -0,0 +1,341 @@
+#include "PolyMeshGen.h"
+#include "StructuredMeshGenerator.h"
+#include "MeshCleaner.h"
+#include "MeshGeometry.h"
+#include "VolumeFraction.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <utility>
+
+PolyMesh::PolyMesh(MeshData&& mesh, label nCells, std::vector<double>&& alpha)
+    : mesh_(std::move(mesh)), nCells_(nCells), alpha_(std::move(alpha))
+{
+    if (nCells_ < 0)
+    {
+        label maxCell = -1;
+        for (label c : mesh_.owner)     maxCell = std::max(maxCell, c);
+        for (label c : mesh_.neighbour) maxCell = std::max(maxCell, c);
+        nCells_ = maxCell + 1;
+    }
+}
+
+MeshData PolyMesh::release() &&
+{
+    nCells_ = 0;
+    alpha_.clear();
+    return std::move(mesh_);
+}
+
+PatchPlan planPatchRules(const std::vector<PatchInfo>& patches, std::size_t nInternalFaces,
+                         const std::vector<PatchRule>& rules)
+{
+    std::vector<PatchInfo> renamed = patches;
+    for (const PatchRule& r : rules)
+    {
+        auto it = std::find_if(patches.begin(), patches.end(),
+                               [&](const PatchInfo& p) { return p.name == r.patch; });
+        if (it == patches.end())
+        {
+            throw MeshRequestError("applyPatchRules: no patch named '" + r.patch + "'");
+        }
+        PatchInfo& p = renamed[static_cast<std::size_t>(it - patches.begin())];
+        if (!r.name.empty()) p.name = r.name;
+        if (!r.type.empty()) p.type = r.type;
+    }
+
+    // 同名 patch 归为一组，组按首次出现的顺序排列
+    PatchPlan plan;
+    for (std::size_t p = 0; p < renamed.size(); ++p)
+    {
+        auto it = std::find_if(plan.patches.begin(), plan.patches.end(),
+                               [&](const PatchInfo& q) { return q.name == renamed[p].name; });
+        if (it == plan.patches.end())
+        {
+            plan.patches.push_back(renamed[p]);
+            plan.sources.push_back({p});
+        }
+        else
+        {
+            if (it->type != renamed[p].type)
+            {
+                throw MeshRequestError("applyPatchRules: patch '" + renamed[p].name
+                                       + "' merged with conflicting types " + it->type
+                                       + " and " + renamed[p].type);
+            }
+            plan.sources[static_cast<std::size_t>(it - plan.patches.begin())].push_back(p);
+        }
+    }
+
+    std::size_t start = nInternalFaces;
+    for (std::size_t g = 0; g < plan.patches.size(); ++g)
+    {
+        PatchInfo& patch = plan.patches[g];
+        patch.startFace = static_cast<label>(start);
+        patch.nFaces    = 0;
+        for (std::size_t p : plan.sources[g]) patch.nFaces += patches[p].nFaces;
+        start += static_cast<std::size_t>(patch.nFaces);
+    }
+    return plan;
+}
+
+void applyPatchRules(MeshData& mesh, const std::vector<PatchRule>& rules)
+{
+    if (rules.empty())
+    {
+        return;
+    }
+
+    PatchPlan plan = planPatchRules(mesh.patches, mesh.neighbour.size(), rules);
+    if (plan.patches.size() == mesh.patches.size())
+    {
+        mesh.patches = std::move(plan.patches);
+        return;
+    }
+
+    // 合并：边界面按组重新排成连续区间，内部面（及 faceZone）不受影响
+    ScopedStage stage("mergePatches");
+
+    const std::size_t nInternal = mesh.neighbour.size();
+    const std::size_t nBoundary = mesh.faces.size() - nInternal;
+    stage.setFaces(nBoundary);
+
+    FaceList faces;
+    std::vector<label> owner;
+    faces.reserve(nBoundary, mesh.faces.verts.size() - static_cast<std::size_t>(mesh.faces.offsets[nInternal]));
+    owner.reserve(nBoundary);
+
+    for (const std::vector<std::size_t>& g : plan.sources)
+    {
+        for (std::size_t p : g)
+        {
+            const PatchInfo& src = mesh.patches[p];
+            const auto b = static_cast<std::size_t>(src.startFace);
+            const auto e = b + static_cast<std::size_t>(src.nFaces);
+            for (std::size_t f = b; f < e; ++f)
+            {
+                faces.push_back(mesh.faces[f]);
+            }
+            owner.insert(owner.end(), mesh.owner.begin() + static_cast<std::ptrdiff_t>(b),
+                         mesh.owner.begin() + static_cast<std::ptrdiff_t>(e));
+        }
+    }
+
+    // 边界面的顶点总数不变，只需从第一个边界面起覆盖偏移表与顶点表
+    const label vertStart = mesh.faces.offsets[nInternal];
+    for (std::size_t i = 1; i <= nBoundary; ++i)
+    {
+        mesh.faces.offsets[nInternal + i] = vertStart + faces.offsets[i];
+    }
+    std::copy(faces.verts.begin(), faces.verts.end(), mesh.faces.verts.begin() + vertStart);
+    std::copy(owner.begin(), owner.end(), mesh.owner.begin() + static_cast<std::ptrdiff_t>(nInternal));
+    mesh.patches = std::move(plan.patches);
+    invalidateGeometry(mesh);   // 边界面换了位置
+}
+
+namespace
+{
+
+// 由 ws.keepCell 重建一级网格：拓扑、（可选）体积分数、清理未用点、patch 规则
+PolyMesh buildLevel(const MeshData& bg, MaskWorkspace& ws, const MeshRequest& request,
+                    const MaskFunc& inDomain)
+{
+    const bool useRegions = static_cast<bool>(request.regions);
+
+    MeshData masked;
+    {
+        ScopedStage stage("applyMask");
+        masked = applyKeepMask(bg, ws.keepCell, ws,
+                               useRegions ? request.regionNames : std::vector<std::string>());
+        stage.setCells(static_cast<std::uint64_t>(ws.cellCount));
+        stage.setFaces(masked.faces.size());
+    }
+
+    std::vector<double> alpha;
+    if (request.alphaSamples > 0)
+    {
+        alpha = computeVolumeFraction(bg, ws.keepCell, inDomain, request.alphaSamples);
+    }
+
+    removeUnusedPoints(masked);
+    applyPatchRules(masked, request.patches);
+
+    return PolyMesh(std::move(masked), ws.cellCount, std::move(alpha));
+}
+
+void checkRequest(const MeshRequest& request)
+{
+    const GridDescriptor& g = request.grid;
+    if (request.blocks.empty() && (g.Nx <= 0 || g.Ny <= 0 || g.Nz <= 0 || !(g.Lx > 0.0) || !(g.Ly > 0.0) || !(g.Lz > 0.0)))
+    {
+        std::ostringstream msg;
+        msg << "generateMesh: invalid grid " << g.Nx << "x" << g.Ny << "x" << g.Nz
+            << ", size " << g.Lx << "x" << g.Ly << "x" << g.Lz;
+        throw MeshRequestError(msg.str());
+    }
+    if (!request.regions && !request.mask && !request.cutSurface)
+    {
+        throw MeshRequestError("generateMesh: neither mask, regions nor cutSurface given");
+    }
+}
+
+} // namespace
+
+SparseKeepMask evaluateSparseMask(const MeshRequest& request)
+{
+    checkRequest(request);
+
+    ScopedStage stage("evaluateMask");
+    SparseKeepMask keep;
+    if (request.regions)
+    {
+        evaluateRegionsSparse(request.grid, request.regions, keep);
+    }
+    else
+    {
+        const MaskFunc& mask = request.mask;
+        evaluateRegionsSparse(request.grid, [&mask](const Point& c) { return mask(c) ? 1 : 0; }, keep);
+    }
+    return keep;
+}
+
+MeshLevels generateMeshLevels(const MeshRequest& request, int nLevels, CoarsenRule rule,
+                              ConnectivityReport* report)
+{
+    checkRequest(request);
+
+    if (!request.blocks.empty())
+    {
+        if (!request.mask || request.regions || request.cutSurface || request.sparse || request.checkIslands
+            || request.alphaSamples > 0 || nLevels > 1)
+        {
+            throw MeshRequestError("generateMesh: blocks need a plain mask and support neither regions, "
+                                   "cut cells, sparse masks, island checks, alpha nor levels");
+        }
+
+        MultiBlockReport blocks;
+        MeshData masked = assembleBlocks(request.blocks, request.mask, &blocks);
+        removeUnusedPoints(masked);
+        applyPatchRules(masked, request.patches);
+
+        MeshLevels out;
+        out.levels.push_back(PolyMesh(std::move(masked), blocks.nCells));
+        return out;
+    }
+
+    const GridDescriptor& g = request.grid;
+    const bool useRegions = static_cast<bool>(request.regions);
+    const long long factor = nLevels > 1 ? 1LL << (nLevels - 1) : 1;
+    if (nLevels < 1 || nLevels > 30 || g.Nx % factor || g.Ny % factor || (g.Nz > 1 && g.Nz % factor))
+    {
+        std::ostringstream msg;
+        msg << "generateMesh: " << nLevels << " levels need cell counts divisible by "
+            << factor << ", got " << g.Nx << "x" << g.Ny << "x" << g.Nz;
+        throw MeshRequestError(msg.str());
+    }
+
+    if (request.cutSurface)
+    {
+        if (request.sparse || request.regions || request.checkIslands || request.alphaSamples > 0 || nLevels > 1)
+        {
+            throw MeshRequestError("generateMesh: cut cells support neither sparse masks, regions, "
+                                   "island checks, alpha nor levels");
+        }
+
+        MeshData bg = generateStructuredMesh(g.Nx, g.Ny, g.Nz, g.Lx, g.Ly, g.Lz);
+        CutCellReport cut;
+        MeshData masked = applyCutCells(bg, request.cutSurface, request.cut, &cut);
+        removeUnusedPoints(masked);
+        applyPatchRules(masked, request.patches);
+
+        MeshLevels out;
+        out.levels.push_back(PolyMesh(std::move(masked), cut.nCells));
+        return out;
+    }
+
+    if (request.sparse)
+    {
+        if (request.checkIslands || request.alphaSamples > 0 || nLevels > 1)
+        {
+            throw MeshRequestError("generateMesh: sparse masks support neither island checks, alpha nor levels");
+        }
+
+        const SparseKeepMask keep = evaluateSparseMask(request);
+        MeshData masked = applySparseKeepMask(g, keep, useRegions ? request.regionNames
+                                                                  : std::vector<std::string>());
+        applyPatchRules(masked, request.patches);
+
+        MeshLevels out;
+        out.levels.push_back(PolyMesh(std::move(masked), keep.cellCount));
+        return out;
+    }
+
+    MaskFunc inDomain = request.mask;
+    if (useRegions)
+    {
+        const RegionFunc& region = request.regions;
+        inDomain = [&region](const Point& c) { return region(c) != 0; };
+    }
+
+    // 1) 最细一级背景结构网格
+    MeshData bg = generateStructuredMesh(g.Nx, g.Ny, g.Nz, g.Lx, g.Ly, g.Lz);
+
+    // 2) 掩模只在最细一级求值 ->（可选）连通性分析
+    MaskWorkspace ws;
+    {
+        ScopedStage stage("evaluateMask");
+        stage.setCells(static_cast<std::uint64_t>(g.Nx) * g.Ny * g.Nz);
+
+        if (useRegions)
+        {
+            evaluateRegions(bg, request.regions, ws.keepCell);
+        }
+        else
+        {
+            evaluateMask(bg, request.mask, ws.keepCell);
+        }
+
+        if (request.checkIslands)
+        {
+            ConnectivityReport islands = analyzeConnectivity(bg, ws.keepCell, request.islands);
+            const bool passed = islands.passed;
+            if (report)
+            {
+                *report = std::move(islands);
+            }
+            if (!passed)
+            {
+                return MeshLevels();
+            }
+        }
+    }
+
+    // 3) 逐级重建拓扑；粗一级的 keep 图与父 cell 映射只需细一级的尺寸与 keep 图
+    MeshLevels out;
+    for (int level = 0; level < nLevels; ++level)
+    {
+        out.levels.push_back(buildLevel(bg, ws, request, inDomain));
+        if (level + 1 == nLevels)
+        {
+            break;
+        }
+
+        std::vector<char> coarseKeep;
+        coarsenKeepMask(bg, ws.keepCell, rule, coarseKeep);
+        out.parentCells.push_back(parentCellMap(bg, ws.keepCell, coarseKeep));
+        ws.keepCell.swap(coarseKeep);
+
+        const int Nz = bg.Nz > 1 ? bg.Nz / 2 : 1;
+        bg = generateStructuredMesh(bg.Nx / 2, bg.Ny / 2, Nz, g.Lx, g.Ly, g.Lz);
+    }
+
+    return out;
+}
+
+PolyMesh generateMesh(const MeshRequest& request, ConnectivityReport* report)
+{
+    MeshLevels levels = generateMeshLevels(request, 1, CoarsenRule::any, report);
+    return levels.levels.empty() ? PolyMesh() : std::move(levels.levels.front());
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MeshTypes.h"
+#include "DomainMask.h"
+#include "Connectivity.h"
+#include "CutCell.h"
+#include "MeshGeometry.h"
+#include "MeshHierarchy.h"
+#include "MultiBlock.h"
+#include "SparseMask.h"
+
+// 嵌入式调用接口：在进程内生成网格，直接交给分解 / 场初始化等下游，不经过文件系统。
+//   GridDescriptor + 掩模 + patch 规则  ->  generateMesh  ->  PolyMesh（只读 span 视图）
+// PolyMesh 只能移动、不能拷贝；各阶段之间的网格数组都是移交所有权，不复制。
+
+// 请求本身有误（网格尺寸、选项组合、未知 patch 名等）时由 generateMesh / generateMeshLevels /
+// applyPatchRules / writeMeshPipelined 抛出；what() 为带函数名前缀的说明。嵌入调用的程序可以
+// 捕获后改正请求，命令行程序打印后退出。
+class MeshRequestError : public std::invalid_argument
+{
+public:
+    using std::invalid_argument::invalid_argument;
+};
+
+// 对默认 patch（back / front / bottom / top / reflector / left）改名或改类型。
+// name / type 为空表示不变；多个 patch 改成同一名字时合并为一个 patch
+// （如 back + front -> frontAndBack, empty），合并后的 patch 位于其中第一个的位置。
+struct PatchRule
+{
+    std::string patch;
+    std::string name;
+    std::string type;
+};
+
+struct MeshRequest
+{
+    GridDescriptor grid;
+
+    // 二选一：mask 为普通掩模；regions 非空时按区域裁剪并生成 cellZones / faceZones，
+    // regionNames[r-1] 为区域 r 的名字
+    MaskFunc                 mask;
+    RegionFunc               regions;
+    std::vector<std::string> regionNames;
+
+    std::vector<PatchRule> patches;
+
+    bool                checkIslands = false;   // 裁剪后做连通性分析
+    ConnectivityOptions islands;
+
+    int alphaSamples = 0;                       // > 0 时同时计算体积分数
+
+    // 游程编码 keep 图（SparseMask.h）：不生成背景网格，内存只与保留的 cell 成正比，
+    // 适合远大于内存的背景；不支持 checkIslands / alphaSamples / 多级网格
+    bool sparse = false;
+
+    // cut-cell 模式（CutCell.h）：给出符号距离时不用 mask / regions，被表面穿过的 cell
+    // 切成多面体，表面成为 reflector 上的贴体边界；不支持 sparse / checkIslands /
+    // alphaSamples / 多级网格
+    SignedDistanceFunc cutSurface;
+    CutCellOptions     cut;
+
+    // 多块模式（MultiBlock.h）：非空时不用 grid，各块按各自的范围与分辨率生成、分别求 mask，
+    // 在协调接口上拼成一个网格；只支持普通 mask，不支持 regions / sparse / cutSurface /
+    // checkIslands / alphaSamples / 多级网格
+    std::vector<BlockDescriptor> blocks;
+};
+
+class PolyMesh
+{
+public:
+    PolyMesh() = default;
+    // nCells < 0 时由 owner / neighbour 推出（如 readPolyMesh 读入的网格）
+    explicit PolyMesh(MeshData&& mesh, label nCells = -1, std::vector<double>&& alpha = {});
+
+    PolyMesh(const PolyMesh&) = delete;
+    PolyMesh& operator=(const PolyMesh&) = delete;
+    PolyMesh(PolyMesh&& o) noexcept
+        : mesh_(std::move(o.mesh_)), nCells_(std::exchange(o.nCells_, 0)), alpha_(std::move(o.alpha_))
+    {
+    }
+    PolyMesh& operator=(PolyMesh&& o) noexcept
+    {
+        mesh_   = std::move(o.mesh_);
+        nCells_ = std::exchange(o.nCells_, 0);
+        alpha_  = std::move(o.alpha_);
+        return *this;
+    }
+
+    bool empty() const { return nCells_ == 0; }
+    label nCells() const { return nCells_; }
+    label nInternalFaces() const { return static_cast<label>(mesh_.neighbour.size()); }
+
+    std::span<const Point>              points() const    { return mesh_.points; }
+    const FaceList&                     faces() const     { return mesh_.faces; }
+    std::span<const label>              owner() const     { return mesh_.owner; }
+    std::span<const label>              neighbour() const { return mesh_.neighbour; }
+    std::span<const PatchInfo>          patches() const   { return mesh_.patches; }
+    std::span<const CellZone>           cellZones() const { return mesh_.cellZones; }
+    std::span<const FaceZone>           faceZones() const { return mesh_.faceZones; }
+
+    // 面心 / 面积矢量 / 体心 / 体积（MeshGeometry.h），第一次调用时计算并缓存
+    const MeshGeometry& geometry() const { return meshGeometry(mesh_); }
+
+    // 体积分数（alphaSamples > 0 时），按 cell 编号排列
+    std::span<const double> alpha() const { return alpha_; }
+
+    // 交给 writePolyMesh / checkMesh / evaluateInitialField 等以 MeshData 为参数的函数
+    const MeshData& data() const { return mesh_; }
+
+    // 取走底层数组，之后本对象为空
+    MeshData release() &&;
+
+private:
+    MeshData            mesh_;
+    label               nCells_ = 0;
+    std::vector<double> alpha_;
+};
+
+// 生成背景网格、求掩模、（可选）连通性分析、重建拓扑、清理未用点并应用 patch 规则。
+// 连通性分析未通过时返回空 PolyMesh；report 非空时写入分析结果。
+// 参数错误（网格尺寸、未知 patch 名等）时抛出 MeshRequestError。
+PolyMesh generateMesh(const MeshRequest& request, ConnectivityReport* report = nullptr);
+
+// 多级网格：同一 GridDescriptor、同一次掩模求值得到 nLevels 级网格，第 l 级为
+// Nx/2^l x Ny/2^l x Nz/2^l（Nz == 1 时保持 1），粗一级的 keep 图按 rule 由细一级推出。
+// 连通性分析只在最细一级做，粗级别的体积分数在各自的背景网格上计算。
+struct MeshLevels
+{
+    std::vector<PolyMesh>           levels;        // levels[0] 最细
+    std::vector<std::vector<label>> parentCells;   // parentCells[l][c]: levels[l] 的 cell c 在 levels[l+1] 中的父 cell
+};
+
+// 连通性分析未通过时 levels 为空；网格尺寸不能被 2^(nLevels-1) 整除时抛出 MeshRequestError
+MeshLevels generateMeshLevels(const MeshRequest& request, int nLevels, CoarsenRule rule,
+                              ConnectivityReport* report = nullptr);
+
+// 就地应用 patch 规则（只移动边界面，内部面与 zone 不变）。没有规则中的 patch 名、
+// 合并的 patch 类型不一致时抛出 MeshRequestError，网格不变
+void applyPatchRules(MeshData& mesh, const std::vector<PatchRule>& rules);
+
+// patch 规则的结果，不移动任何面：patches 为规则应用后的 patch（startFace 从 nInternalFaces 起
+// 依次重排），sources[i] 为 patches[i] 依次包含的原 patch 编号
+struct PatchPlan
+{
+    std::vector<PatchInfo>                patches;
+    std::vector<std::vector<std::size_t>> sources;
+};
+
+PatchPlan planPatchRules(const std::vector<PatchInfo>& patches, std::size_t nInternalFaces,
+                         const std::vector<PatchRule>& rules);
+
+// sparse 路径的掩模求值（检查 grid / mask 后在 GridDescriptor 上直接求值）
+SparseKeepMask evaluateSparseMask(const MeshRequest& request);
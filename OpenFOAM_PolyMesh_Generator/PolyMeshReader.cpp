@@ -0,0 +1,479 @@
+#include "PolyMeshReader.h"
+#include "Dictionary.h"
+#include "GzipStream.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+static_assert(sizeof(Point) == 3 * sizeof(double), "Point must be three packed doubles");
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "binary polyMesh reader assumes a little-endian host (arch LSB)"
+#endif
+
+namespace
+{
+
+[[noreturn]] void readError(const std::string& path, const std::string& msg)
+{
+    std::cerr << "Cannot read " << path << ": " << msg << "\n";
+    std::exit(1);
+}
+
+// 一个映射好的 OpenFOAM 文件：FoamFile 头已解析，pos 指向头之后。
+// 文件不存在而 <path>.gz 存在时读压缩文件（整个解压到内存）。
+struct FoamFile
+{
+    std::string path;
+    std::unique_ptr<MappedFile> map;
+    std::vector<char> inflated;
+    std::string cls;
+    bool        binary     = false;
+    int         labelBits  = 32;
+    int         scalarBits = 64;
+    const char* pos = nullptr;
+    const char* end = nullptr;
+
+    explicit FoamFile(const std::string& p)
+        : path(p)
+    {
+        if (!std::filesystem::exists(p) && std::filesystem::exists(p + ".gz"))
+        {
+            path = p + ".gz";
+            inflated = readGzipFile(path);
+            pos = inflated.data();
+            end = inflated.data() + inflated.size();
+        }
+        else
+        {
+            map = std::make_unique<MappedFile>(p, MappedFile::readOnly);
+            pos = map->data();
+            end = map->data() + map->size();
+        }
+        const char* const begin = pos;
+
+        const std::string_view text(begin, static_cast<std::size_t>(end - begin));
+        const std::size_t h = text.find("FoamFile");
+        if (h == std::string_view::npos) return;   // 无头文件：按 ASCII 处理
+
+        const std::size_t open  = text.find('{', h);
+        const std::size_t close = text.find('}', open);
+        if (open == std::string_view::npos || close == std::string_view::npos)
+        {
+            readError(path, "malformed FoamFile header");
+        }
+
+        const Dictionary header = Dictionary::parse(
+            std::string(text.substr(open + 1, close - open - 1)), path);
+
+        cls    = header.getWordOrDefault("class", "");
+        binary = header.getWordOrDefault("format", "ascii") == "binary";
+
+        // arch "LSB;label=32;scalar=64"
+        const std::string arch = header.getWordOrDefault("arch", "LSB;label=32;scalar=64");
+        if (arch.find("MSB") != std::string::npos)
+        {
+            readError(path, "big-endian (MSB) files are not supported");
+        }
+        const std::size_t l = arch.find("label=");
+        const std::size_t s = arch.find("scalar=");
+        if (l != std::string::npos) labelBits  = std::atoi(arch.c_str() + l + 6);
+        if (s != std::string::npos) scalarBits = std::atoi(arch.c_str() + s + 7);
+
+        pos = begin + close + 1;
+    }
+
+    // 跳过空白与 // 、/* */ 注释
+    void skipSpace()
+    {
+        while (pos < end)
+        {
+            const char c = *pos;
+            if (c == ' ' || c == '\n' || c == '\t' || c == '\r')
+            {
+                ++pos;
+            }
+            else if (c == '/' && pos + 1 < end && pos[1] == '/')
+            {
+                while (pos < end && *pos != '\n') ++pos;
+            }
+            else if (c == '/' && pos + 1 < end && pos[1] == '*')
+            {
+                const char* e = std::search(pos + 2, end, "*/", "*/" + 2);
+                pos = e == end ? end : e + 2;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    // 读 list 长度及其后的 '(' 或 '{'（uniform 形式 N{v}），返回该括号字符
+    char readCount(std::size_t& count)
+    {
+        skipSpace();
+        const auto r = std::from_chars(pos, end, count);
+        if (r.ec != std::errc()) readError(path, "expected a list size");
+        pos = r.ptr;
+        skipSpace();
+        if (pos >= end || (*pos != '(' && *pos != '{')) readError(path, "expected '(' after list size");
+        return *pos++;
+    }
+};
+
+// ---------------------------------------------------------------
+// ASCII：并行 from_chars 分词
+// ---------------------------------------------------------------
+
+// 解析 [b, e) 中的全部数字，'(' 与 ')' 视作分隔符。
+// 区间按行边界切成若干块并行解析，各块结果按顺序拼接。
+template <class T>
+std::vector<T> parseNumbers(const std::string& path, const char* b, const char* e)
+{
+    const std::size_t bytes  = static_cast<std::size_t>(e - b);
+    const unsigned    nParts = parallelChunkCount(bytes, 1u << 20);
+
+    std::vector<const char*> cut(nParts + 1, e);
+    cut[0] = b;
+    for (unsigned c = 1; c < nParts; ++c)
+    {
+        const char* p = std::max(cut[c - 1], b + bytes * c / nParts);
+        p = static_cast<const char*>(std::memchr(p, '\n', static_cast<std::size_t>(e - p)));
+        cut[c] = p ? p + 1 : e;
+    }
+
+    std::vector<std::vector<T>> parts(nParts);
+    std::vector<const char*>    bad(nParts, nullptr);
+
+    parallelFor(nParts, [&](std::size_t pb, std::size_t pe, unsigned)
+    {
+        for (std::size_t c = pb; c < pe; ++c)
+        {
+            std::vector<T>& out = parts[c];
+            out.reserve(static_cast<std::size_t>(cut[c + 1] - cut[c]) / 4);
+
+            const char* p   = cut[c];
+            const char* end = cut[c + 1];
+            while (p < end)
+            {
+                const char ch = *p;
+                if (ch == ' ' || ch == '\n' || ch == '\t' || ch == '\r' || ch == '(' || ch == ')')
+                {
+                    ++p;
+                    continue;
+                }
+                T v;
+                const auto r = std::from_chars(p, end, v);
+                if (r.ec != std::errc())
+                {
+                    bad[c] = p;
+                    break;
+                }
+                out.push_back(v);
+                p = r.ptr;
+            }
+        }
+    }, 1);
+
+    std::vector<std::size_t> offset(nParts + 1, 0);
+    for (unsigned c = 0; c < nParts; ++c)
+    {
+        if (bad[c])
+        {
+            const char* q = bad[c];
+            const char* qe = std::find(q, std::min(e, q + 32), '\n');
+            readError(path, "unexpected token '" + std::string(q, qe) + "'");
+        }
+        offset[c + 1] = offset[c] + parts[c].size();
+    }
+
+    std::vector<T> all(offset[nParts]);
+    parallelFor(nParts, [&](std::size_t pb, std::size_t pe, unsigned)
+    {
+        for (std::size_t c = pb; c < pe; ++c)
+        {
+            std::copy(parts[c].begin(), parts[c].end(), all.begin() + offset[c]);
+            std::vector<T>().swap(parts[c]);
+        }
+    }, 1);
+    return all;
+}
+
+// 读一个 ASCII list，返回其中全部数字（按出现顺序展平）。
+// nested 为 false 时 list 在第一个 ')' 处结束（labelList），
+// 为 true 时在文件最后一个 ')' 处结束（vectorField / faceList，list 在文件末尾）。
+// uniform 形式 N{v} 展开为 N 份 v。
+template <class T>
+std::vector<T> readAsciiList(FoamFile& f, std::size_t& count, bool nested)
+{
+    const char open = f.readCount(count);
+
+    if (open == '{')
+    {
+        const char* close = std::find(f.pos, f.end, '}');
+        if (close == f.end) readError(f.path, "missing '}' in uniform list");
+        const std::vector<T> v = parseNumbers<T>(f.path, f.pos, close);
+        f.pos = close + 1;
+
+        std::vector<T> all;
+        all.reserve(count * v.size());
+        for (std::size_t i = 0; i < count; ++i) all.insert(all.end(), v.begin(), v.end());
+        return all;
+    }
+
+    const char* close = nullptr;
+    if (nested)
+    {
+        for (const char* p = f.end; p > f.pos; --p)
+        {
+            if (p[-1] == ')') { close = p - 1; break; }
+        }
+    }
+    else
+    {
+        close = static_cast<const char*>(std::memchr(f.pos, ')', static_cast<std::size_t>(f.end - f.pos)));
+    }
+    if (!close) readError(f.path, "missing ')' at end of list");
+
+    std::vector<T> all = parseNumbers<T>(f.path, f.pos, close);
+    f.pos = close + 1;
+    return all;
+}
+
+// ---------------------------------------------------------------
+// binary：原始字节
+// ---------------------------------------------------------------
+
+template <class T>
+std::vector<T> readBinaryList(FoamFile& f)
+{
+    std::size_t count = 0;
+    if (f.readCount(count) != '(') readError(f.path, "uniform lists are not supported in binary files");
+
+    const std::size_t bytes = count * sizeof(T);
+    if (static_cast<std::size_t>(f.end - f.pos) < bytes + 1 || f.pos[bytes] != ')')
+    {
+        readError(f.path, "binary list of " + std::to_string(count) + " entries is truncated");
+    }
+
+    std::vector<T> v(count);
+    const char* src = f.pos;
+    parallelFor(count, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        std::memcpy(v.data() + b, src + b * sizeof(T), (e - b) * sizeof(T));
+    }, 1u << 16);
+
+    f.pos += bytes + 1;
+    return v;
+}
+
+void checkArch(const FoamFile& f)
+{
+    if (f.labelBits != 8 * static_cast<int>(sizeof(label)) || f.scalarBits != 64)
+    {
+        readError(f.path, "arch label=" + std::to_string(f.labelBits) + ";scalar="
+                  + std::to_string(f.scalarBits) + " does not match this build (label="
+                  + std::to_string(8 * sizeof(label)) + ";scalar=64)");
+    }
+}
+
+std::vector<label> readLabels(const std::string& path)
+{
+    FoamFile f(path);
+    if (f.binary)
+    {
+        checkArch(f);
+        return readBinaryList<label>(f);
+    }
+
+    std::size_t count = 0;
+    std::vector<label> v = readAsciiList<label>(f, count, false);
+    if (v.size() != count)
+    {
+        readError(path, "expected " + std::to_string(count) + " labels, found " + std::to_string(v.size()));
+    }
+    return v;
+}
+
+std::vector<Point> readPoints(const std::string& path)
+{
+    FoamFile f(path);
+    if (f.binary)
+    {
+        checkArch(f);
+        return readBinaryList<Point>(f);
+    }
+
+    std::size_t count = 0;
+    const std::vector<double> v = readAsciiList<double>(f, count, true);
+    if (v.size() != 3 * count)
+    {
+        readError(path, "expected " + std::to_string(count) + " points, found "
+                  + std::to_string(v.size()) + " scalars");
+    }
+
+    std::vector<Point> pts(count);
+    std::memcpy(pts.data(), v.data(), v.size() * sizeof(double));
+    return pts;
+}
+
+FaceList readFaces(const std::string& path)
+{
+    FoamFile f(path);
+
+    std::vector<label> offsets;   // faceCompactList：nFaces+1 个偏移
+    std::vector<label> verts;     // 各面顶点依次排列
+    std::size_t nFaces = 0;
+
+    if (f.cls == "faceCompactList")
+    {
+        if (f.binary)
+        {
+            checkArch(f);
+            offsets = readBinaryList<label>(f);
+            verts   = readBinaryList<label>(f);
+        }
+        else
+        {
+            std::size_t n = 0;
+            offsets = readAsciiList<label>(f, n, false);
+            verts   = readAsciiList<label>(f, n, false);
+        }
+        if (offsets.empty() || offsets.back() != static_cast<label>(verts.size()))
+        {
+            readError(path, "inconsistent faceCompactList offsets");
+        }
+        nFaces = offsets.size() - 1;
+    }
+    else
+    {
+        if (f.binary) readError(path, "binary faceList is not supported (expected faceCompactList)");
+
+        // "n(v0 ... vn-1)" 展平为 n, v0, ..., vn-1
+        const std::vector<label> flat = readAsciiList<label>(f, nFaces, true);
+        offsets.reserve(nFaces + 1);
+        verts.reserve(flat.size());
+        offsets.push_back(0);
+        std::size_t i = 0;
+        while (i < flat.size() && offsets.size() <= nFaces)
+        {
+            const std::size_t n = static_cast<std::size_t>(flat[i]);
+            if (i + 1 + n > flat.size()) break;
+            verts.insert(verts.end(), flat.begin() + i + 1, flat.begin() + i + 1 + n);
+            offsets.push_back(static_cast<label>(verts.size()));
+            i += 1 + n;
+        }
+        if (offsets.size() != nFaces + 1 || i != flat.size())
+        {
+            readError(path, "expected " + std::to_string(nFaces) + " faces");
+        }
+    }
+
+    for (std::size_t i = 0; i < nFaces; ++i)
+    {
+        if (offsets[i + 1] - offsets[i] < 3) readError(path, "face " + std::to_string(i) + " has fewer than 3 vertices");
+    }
+
+    FaceList faces;
+    faces.offsets = std::move(offsets);
+    faces.verts   = std::move(verts);
+    return faces;
+}
+
+std::vector<PatchInfo> readBoundary(const std::string& path)
+{
+    FoamFile f(path);
+
+    std::size_t count = 0;
+    if (f.readCount(count) != '(') readError(path, "expected '(' after patch count");
+
+    const char* close = nullptr;
+    for (const char* p = f.end; p > f.pos; --p)
+    {
+        if (p[-1] == ')') { close = p - 1; break; }
+    }
+    if (!close) readError(path, "missing ')' at end of patch list");
+
+    const Dictionary patches = Dictionary::parse(std::string(f.pos, close), path);
+
+    std::vector<PatchInfo> out;
+    for (const auto& e : patches.entries())
+    {
+        if (!e.isDict()) continue;
+        const Dictionary& d = e.dict.front();
+
+        PatchInfo p;
+        p.name      = e.key;
+        p.type      = d.getWordOrDefault("type", "patch");
+        p.nFaces    = d.getLabel("nFaces");
+        p.startFace = d.getLabel("startFace");
+        out.push_back(p);
+    }
+
+    if (out.size() != count)
+    {
+        readError(path, "expected " + std::to_string(count) + " patches, found " + std::to_string(out.size()));
+    }
+    return out;
+}
+
+} // namespace
+
+MeshData readPolyMesh(const std::string& baseDir)
+{
+    ScopedStage stage("readPolyMesh");
+
+    MeshData m;
+    m.Nx = m.Ny = m.Nz = 0;
+
+    {
+        ScopedStage fileStage("points");
+        m.points = readPoints(baseDir + "/points");
+        fileStage.setBytes(m.points.size() * sizeof(Point));
+    }
+    {
+        ScopedStage fileStage("faces");
+        m.faces = readFaces(baseDir + "/faces");
+        fileStage.setFaces(m.faces.size());
+    }
+    {
+        ScopedStage fileStage("owner");
+        m.owner = readLabels(baseDir + "/owner");
+    }
+    {
+        ScopedStage fileStage("neighbour");
+        m.neighbour = readLabels(baseDir + "/neighbour");
+    }
+    {
+        ScopedStage fileStage("boundary");
+        m.patches = readBoundary(baseDir + "/boundary");
+    }
+
+    if (m.owner.size() != m.faces.size() || m.neighbour.size() > m.faces.size())
+    {
+        readError(baseDir, "owner / neighbour sizes do not match faces");
+    }
+
+    label maxCell = -1;
+    for (label c : m.owner)     maxCell = std::max(maxCell, c);
+    for (label c : m.neighbour) maxCell = std::max(maxCell, c);
+
+    stage.setCells(static_cast<std::size_t>(maxCell + 1));
+    stage.setFaces(m.faces.size());
+
+    std::cout << "polyMesh read from " << baseDir << ": "
+              << m.points.size() << " points, " << m.faces.size() << " faces, "
+              << maxCell + 1 << " cells\n";
+    return m;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <string>
+#include "MeshTypes.h"
+
+// 读取 polyMesh 目录（points / faces / owner / neighbour / boundary）到 MeshData。
+// 每个文件整体 mmap；按 FoamFile 头里的 format 自动区分 ASCII / binary：
+// - binary: 原始字节直接拷贝（faces 为 faceCompactList），要求 arch 的 label / scalar
+//   位宽与本程序一致
+// - ASCII: list 主体按行边界切块，各线程用 std::from_chars 并行解析
+// 面可为任意 n 边形（CSR 存放）；Nx/Ny/Nz 置 0（不是结构网格）。出错时打印错误并退出。
+MeshData readPolyMesh(const std::string& directory);
@@ -4,14 +4,207 @@
 #include <cstdlib>
 
 #include "PolyMeshWriter.h"
+#include "FoamHeader.h"
+#include "GzipStream.h"
+#include "Profiler.h"
 
-void writePolyMesh(const MeshData &mesh, const std::string &baseDir)
+std::string polyMeshFile(const std::string& directory, const std::string& name,
+                         PolyMeshCompression compression)
 {
+    const std::string plain = directory + "/" + name;
+    const std::string gz    = plain + ".gz";
+    const bool gzip = compression == PolyMeshCompression::gzip;
+    std::filesystem::remove(gzip ? plain : gz);
+    return gzip ? gz : plain;
+}
+
+std::uint64_t finishPolyMeshFile(std::ostream& out, const std::string& path)
+{
+    if (!closeOutputFile(out))
+    {
+        std::cerr << "Error writing " << path << "\n";
+        std::exit(1);
+    }
+    return static_cast<std::uint64_t>(std::filesystem::file_size(path));
+}
+
+std::uint64_t writePolyMeshBoundary(const MeshData& mesh, const std::string& baseDir,
+                                    PolyMeshCompression compression)
+{
+    ScopedStage fileStage("boundary");
+    const std::string path = polyMeshFile(baseDir, "boundary", compression);
+    auto file = openOutputFile(path, compression == PolyMeshCompression::gzip);
+    std::ostream& out = *file;
+    if (!out)
+    {
+        std::cerr << "Cannot open boundary file for writing.\n";
+        std::exit(1);
+    }
+
+    out <<
+"FoamFile\n"
+"{\n"
+"    version     2.0;\n"
+"    format      ascii;\n"
+"    class       polyBoundaryMesh;\n"
+"    location    \"polyMesh\";\n"
+"    object      boundary;\n"
+"}\n"
+"\n"
+"// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * //\n"
+"\n";
+
+    out << mesh.patches.size() << "\n(\n";
+
+    for (const PatchInfo& p : mesh.patches)
+    {
+        out << p.name << "\n"
+"{\n"
+"    type            " << p.type << ";\n"
+"    physicalType    " << p.type << ";\n"
+"    nFaces          " << p.nFaces << ";\n"
+"    startFace       " << p.startFace << ";\n"
+"}\n";
+    }
+
+    out << ")\n;\n\n";
+
+    const std::uint64_t bytes = finishPolyMeshFile(out, path);
+    fileStage.setBytes(bytes);
+    return bytes;
+}
+
+namespace
+{
+
+// "N(...)" 形式的 list：ASCII 为空格分隔，二进制为原始字节
+template <class T>
+void writeZoneList(std::ostream& out, const std::vector<T>& v, bool binary)
+{
+    out << v.size() << "(";
+    if (binary)
+    {
+        out.write(reinterpret_cast<const char*>(v.data()),
+                  static_cast<std::streamsize>(v.size() * sizeof(T)));
+    }
+    else
+    {
+        for (std::size_t i = 0; i < v.size(); ++i)
+        {
+            out << (i ? " " : "") << static_cast<label>(v[i]);
+        }
+    }
+    out << ")";
+}
+
+} // namespace
+
+std::uint64_t writePolyMeshZones(const MeshData& mesh, const std::string& baseDir,
+                                 PolyMeshFormat format, PolyMeshCompression compression)
+{
+    static_assert(sizeof(char) == sizeof(bool), "flipMap is written as List<bool>");
+
+    const bool binary = format == PolyMeshFormat::binary;
+    std::uint64_t totalBytes = 0;
+
+    // 两个文件总是成对写出（可能是空 list），便于下游按固定文件集合检查
+    if (mesh.cellZones.empty() && mesh.faceZones.empty())
+    {
+        for (const char* name : {"cellZones", "faceZones"})
+        {
+            std::filesystem::remove(baseDir + "/" + name);
+            std::filesystem::remove(baseDir + "/" + name + ".gz");
+        }
+        return 0;
+    }
+
+    {
+        ScopedStage fileStage("cellZones");
+        const std::string path = polyMeshFile(baseDir, "cellZones", compression);
+        auto file = openOutputFile(path, compression == PolyMeshCompression::gzip, std::ios::binary);
+        std::ostream& out = *file;
+        if (!out)
+        {
+            std::cerr << "Cannot open cellZones file for writing.\n";
+            std::exit(1);
+        }
+
+        out << foamHeader("regIOobject", "polyMesh", "cellZones", binary);
+        out << mesh.cellZones.size() << "\n(\n";
+        for (const CellZone& z : mesh.cellZones)
+        {
+            out << z.name << "\n{\n    type cellZone;\ncellLabels      List<label> ";
+            writeZoneList(out, z.cells, binary);
+            out << ";\n}\n";
+        }
+        out << ")\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
+    }
+
+    {
+        ScopedStage fileStage("faceZones");
+        const std::string path = polyMeshFile(baseDir, "faceZones", compression);
+        auto file = openOutputFile(path, compression == PolyMeshCompression::gzip, std::ios::binary);
+        std::ostream& out = *file;
+        if (!out)
+        {
+            std::cerr << "Cannot open faceZones file for writing.\n";
+            std::exit(1);
+        }
+
+        out << foamHeader("regIOobject", "polyMesh", "faceZones", binary);
+        out << mesh.faceZones.size() << "\n(\n";
+        for (const FaceZone& z : mesh.faceZones)
+        {
+            out << z.name << "\n{\n    type faceZone;\nfaceLabels      List<label> ";
+            writeZoneList(out, z.faces, binary);
+            out << ";\nflipMap         List<bool> ";
+            writeZoneList(out, z.flipMap, binary);
+            out << ";\n}\n";
+        }
+        out << ")\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
+    }
+
+    return totalBytes;
+}
+
+void writePolyMesh(const MeshData& mesh, const std::string& baseDir, PolyMeshFormat format,
+                   PolyMeshCompression compression)
+{
+    writePolyMeshFiles(mesh, baseDir, format, compression);
+    std::cout << (format == PolyMeshFormat::binary ? "polyMesh (binary) written to " : "polyMesh written to ")
+              << baseDir << "\n";
+}
+
+void writePolyMeshFiles(const MeshData &mesh, const std::string &baseDir, PolyMeshFormat format,
+                        PolyMeshCompression compression)
+{
+    if (format == PolyMeshFormat::binary)
+    {
+        writePolyMeshBinary(mesh, baseDir, compression);
+        return;
+    }
+
+    const bool gzip = compression == PolyMeshCompression::gzip;
+
+    ScopedStage stage("writePolyMesh");
+    std::uint64_t totalBytes = 0;
+
     std::filesystem::create_directories(baseDir);
 
     // ---- points ----
     {
-        std::ofstream out(baseDir + "/points");
+        ScopedStage fileStage("points");
+        const std::string path = polyMeshFile(baseDir, "points", compression);
+        auto file = openOutputFile(path, gzip);
+        std::ostream& out = *file;
         if (!out)
         {
             std::cerr << "Cannot open points file for writing.\n";
@@ -37,11 +230,18 @@ void writePolyMesh(const MeshData &mesh, const std::string &baseDir)
             out << "(" << p.x << " " << p.y << " " << p.z << ")\n";
         }
         out << ")\n;\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
     }
 
     // ---- faces ----
     {
-        std::ofstream out(baseDir + "/faces");
+        ScopedStage fileStage("faces");
+        const std::string path = polyMeshFile(baseDir, "faces", compression);
+        auto file = openOutputFile(path, gzip);
+        std::ostream& out = *file;
         if (!out)
         {
             std::cerr << "Cannot open faces file for writing.\n";
@@ -62,17 +262,29 @@ void writePolyMesh(const MeshData &mesh, const std::string &baseDir)
 "\n";
 
         out << mesh.faces.size() << "\n(\n";
-        for (const auto &f : mesh.faces)
+        for (std::size_t f = 0; f < mesh.faces.size(); ++f)
         {
-            out << "4(" << f[0] << " " << f[1] << " "
-                        << f[2] << " " << f[3] << ")\n";
+            const auto fv = mesh.faces[f];
+            out << fv.size() << "(" << fv[0];
+            for (std::size_t k = 1; k < fv.size(); ++k)
+            {
+                out << " " << fv[k];
+            }
+            out << ")\n";
         }
         out << ")\n;\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
     }
 
     // ---- owner ----
     {
-        std::ofstream out(baseDir + "/owner");
+        ScopedStage fileStage("owner");
+        const std::string path = polyMeshFile(baseDir, "owner", compression);
+        auto file = openOutputFile(path, gzip);
+        std::ostream& out = *file;
         if (!out)
         {
             std::cerr << "Cannot open owner file for writing.\n";
@@ -93,16 +305,23 @@ void writePolyMesh(const MeshData &mesh, const std::string &baseDir)
 "\n";
 
         out << mesh.owner.size() << "\n(\n";
-        for (int c : mesh.owner)
+        for (label c : mesh.owner)
         {
             out << c << "\n";
         }
         out << ")\n;\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
     }
 
     // ---- neighbour ----
     {
-        std::ofstream out(baseDir + "/neighbour");
+        ScopedStage fileStage("neighbour");
+        const std::string path = polyMeshFile(baseDir, "neighbour", compression);
+        auto file = openOutputFile(path, gzip);
+        std::ostream& out = *file;
         if (!out)
         {
             std::cerr << "Cannot open neighbour file for writing.\n";
@@ -123,101 +342,24 @@ void writePolyMesh(const MeshData &mesh, const std::string &baseDir)
 "\n";
 
         out << mesh.neighbour.size() << "\n(\n";
-        for (int c : mesh.neighbour)
+        for (label c : mesh.neighbour)
         {
             out << c << "\n";
         }
         out << ")\n;\n\n";
+
+        const std::uint64_t bytes = finishPolyMeshFile(out, path);
+        fileStage.setBytes(bytes);
+        totalBytes += bytes;
     }
 
     // ---- boundary ----
-    {
-        std::ofstream out(baseDir + "/boundary");
-        if (!out)
-        {
-            std::cerr << "Cannot open boundary file for writing.\n";
-            std::exit(1);
-        }
+    totalBytes += writePolyMeshBoundary(mesh, baseDir, compression);
 
-        out <<
-"FoamFile\n"
-"{\n"
-"    version     2.0;\n"
-"    format      ascii;\n"
-"    class       polyBoundaryMesh;\n"
-"    location    \"polyMesh\";\n"
-"    object      boundary;\n"
-"}\n"
-"\n"
-"// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * //\n"
-"\n";
-
-        const int nPatches = 6;
-        out << nPatches << "\n(\n";
-
-        // front (z-min)
-        out <<
-"back\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesBack << ";\n"
-"    startFace       " << mesh.startFaceBack << ";\n"
-"}\n";
-
-        // back (z-max)
-        out <<
-"front\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesFront << ";\n"
-"    startFace       " << mesh.startFaceFront << ";\n"
-"}\n";
-
-        // top (y-max)
-        out <<
-"bottom\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesBottom << ";\n"
-"    startFace       " << mesh.startFaceBottom << ";\n"
-"}\n";
-
-        // bottom (y-min)
-        out <<
-"top\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesTop << ";\n"
-"    startFace       " << mesh.startFaceTop << ";\n"
-"}\n";
-
-        // reflector (use the former Right patch face range)
-        out <<
-"reflector\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesRight << ";\n"
-"    startFace       " << mesh.startFaceRight << ";\n"
-"}\n";
-
-        // left (inlet)
-        out <<
-"left\n"
-"{\n"
-"    type            patch;\n"
-"    physicalType    patch;\n"
-"    nFaces          " << mesh.nFacesLeft << ";\n"
-"    startFace       " << mesh.startFaceLeft << ";\n"
-"}\n";
-
-        out << ")\n;\n\n";
-    }
+    // ---- cellZones / faceZones ----
+    totalBytes += writePolyMeshZones(mesh, baseDir, PolyMeshFormat::ascii, compression);
 
-    std::cout << "polyMesh written to " << baseDir << "\n";
+    stage.setFaces(mesh.faces.size());
+    stage.setBytes(totalBytes);
 }
 
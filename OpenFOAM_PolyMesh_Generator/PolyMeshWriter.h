@@ -1,8 +1,54 @@
 
 #pragma once
 
+#include <cstdint>
+#include <ostream>
 #include <string>
 #include "MeshTypes.h"
 
-void writePolyMesh(const MeshData& mesh, const std::string& directory);
+enum class PolyMeshFormat
+{
+    ascii,
+    binary
+};
 
+// gzip 时每个文件写成 <name>.gz（OpenFOAM 读取时自动解压），由 GzipStream 分块并行压缩；
+// 同名的另一种文件（未压缩 / .gz）会被删除，避免 OpenFOAM 读到过期的那个
+enum class PolyMeshCompression
+{
+    none,
+    gzip
+};
+
+// 写出 polyMesh 并打印 "polyMesh written to <directory>"
+void writePolyMesh(const MeshData& mesh, const std::string& directory,
+                   PolyMeshFormat format = PolyMeshFormat::ascii,
+                   PolyMeshCompression compression = PolyMeshCompression::none);
+
+// 同 writePolyMesh，但不打印：写到临时目录再换入（writePolyMeshIfChanged）时由调用方报告结果
+void writePolyMeshFiles(const MeshData& mesh, const std::string& directory,
+                        PolyMeshFormat format = PolyMeshFormat::ascii,
+                        PolyMeshCompression compression = PolyMeshCompression::none);
+
+// 二进制后端：每个文件的大小事先精确算出，预分配（MappedFile）+ mmap 映射后
+// 由多个线程直接从 MeshData 填充互不重叠的区域，最后 msync 落盘。
+// gzip 时改为按段填充后送入压缩流。
+void writePolyMeshBinary(const MeshData& mesh, const std::string& directory,
+                         PolyMeshCompression compression = PolyMeshCompression::none);
+
+// 写 boundary 文件（ASCII 字典，两种格式共用），返回写出的字节数
+std::uint64_t writePolyMeshBoundary(const MeshData& mesh, const std::string& directory,
+                                    PolyMeshCompression compression = PolyMeshCompression::none);
+
+// 写 cellZones / faceZones（列表按 format 写成 ASCII 或二进制），返回写出的字节数。
+// 两个文件成对写出；mesh 没有任何 zone 时删除目录中残留的 zone 文件。
+std::uint64_t writePolyMeshZones(const MeshData& mesh, const std::string& directory,
+                                 PolyMeshFormat format,
+                                 PolyMeshCompression compression = PolyMeshCompression::none);
+
+// directory/name 按 compression 得到的实际文件名（gzip 时加 .gz），并删除另一种残留文件
+std::string polyMeshFile(const std::string& directory, const std::string& name,
+                         PolyMeshCompression compression);
+
+// 写完后关闭文件（gzip 时写 trailer），返回文件在磁盘上的字节数；失败时打印错误并退出
+std::uint64_t finishPolyMeshFile(std::ostream& out, const std::string& path);
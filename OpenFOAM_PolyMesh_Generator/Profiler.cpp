@@ -0,0 +1,272 @@
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+#include <sys/resource.h>
+#include <unistd.h>
+#if defined(__APPLE__)
+#include <mach/mach.h>
+#endif
+
+namespace
+{
+
+std::atomic<std::uint64_t> gAllocatedBytes{0};
+
+std::mutex               gMutex;
+std::vector<StageRecord> gRecords;
+
+// 每个线程自己的阶段名栈，用来拼嵌套名字
+thread_local std::vector<std::string> tStageStack;
+
+// 正在进行的阶段（gRecords 中的下标，所有线程），阶段峰值 RSS 在其中滚动更新
+std::vector<std::size_t> gOpenStages;
+std::uint64_t            gGeneration = 0;   // resetProfile 的次数
+
+// 自己记录的进程峰值：VmHWM 复位后 getrusage 的 ru_maxrss 不再可靠
+std::uint64_t gProcessPeak = 0;
+
+// RSS 采样只在 enableRssProfiling(true) 之后进行：复位 VmHWM 会改掉整个进程的
+// ru_maxrss / VmHWM（宿主程序与外部监控也看得到），库被嵌入调用时不能默认这样做
+std::atomic<bool> gRssProfiling{false};
+
+// VmHWM 能否复位；第一次复位失败后只用当前 RSS 采样
+bool gHwmResettable = true;
+
+#if defined(__linux__)
+// /proc/self/status 中的 VmHWM（上次复位以来的峰值 RSS），取不到时为 0
+std::uint64_t readHwmBytes()
+{
+    std::ifstream in("/proc/self/status");
+    std::string line;
+    while (std::getline(in, line))
+    {
+        if (line.compare(0, 6, "VmHWM:") == 0)
+        {
+            return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024u;
+        }
+    }
+    return 0;
+}
+
+bool resetHwm()
+{
+    std::ofstream out("/proc/self/clear_refs");
+    out << "5";
+    out.close();
+    return static_cast<bool>(out);
+}
+#endif
+
+// 取上次采样以来的峰值 RSS 并开始新的采样区间；结果滚动进所有正在进行的阶段。调用方持有 gMutex
+void sampleRss()
+{
+    std::uint64_t peak = currentRssBytes();
+#if defined(__linux__)
+    if (gHwmResettable)
+    {
+        peak = std::max(peak, readHwmBytes());
+        gHwmResettable = resetHwm();
+    }
+#endif
+    gProcessPeak = std::max(gProcessPeak, peak);
+    for (std::size_t slot : gOpenStages)
+    {
+        gRecords[slot].peakRssBytes = std::max(gRecords[slot].peakRssBytes, peak);
+    }
+}
+
+double nowSeconds()
+{
+    using clock = std::chrono::steady_clock;
+    return std::chrono::duration<double>(clock::now().time_since_epoch()).count();
+}
+
+void writeRate(std::ostream& out, const char* key, std::uint64_t n, double seconds)
+{
+    out << ", \"" << key << "\": " << (seconds > 0.0 ? n / seconds : 0.0);
+}
+
+} // namespace
+
+void enableRssProfiling(bool on)
+{
+    gRssProfiling.store(on, std::memory_order_relaxed);
+}
+
+void recordAllocation(std::size_t bytes)
+{
+    gAllocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+std::uint64_t allocatedBytesTotal()
+{
+    return gAllocatedBytes.load(std::memory_order_relaxed);
+}
+
+std::uint64_t peakRssBytes()
+{
+    std::uint64_t peak = 0;
+    struct rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+    {
+#if defined(__APPLE__)
+        peak = static_cast<std::uint64_t>(ru.ru_maxrss);           // macOS: 字节
+#else
+        peak = static_cast<std::uint64_t>(ru.ru_maxrss) * 1024u;   // Linux: KB
+#endif
+    }
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (gRssProfiling.load(std::memory_order_relaxed))
+    {
+        sampleRss();
+    }
+    return std::max(peak, gProcessPeak);
+}
+
+std::uint64_t currentRssBytes()
+{
+#if defined(__linux__)
+    std::ifstream in("/proc/self/statm");
+    std::uint64_t size = 0, resident = 0;
+    if (!(in >> size >> resident))
+    {
+        return 0;
+    }
+    return resident * static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+#elif defined(__APPLE__)
+    mach_task_basic_info_data_t info{};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count)
+        != KERN_SUCCESS)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(info.resident_size);
+#else
+    return 0;
+#endif
+}
+
+ScopedStage::ScopedStage(const char* name)
+{
+    std::string full = tStageStack.empty() ? std::string(name)
+                                           : tStageStack.back() + "/" + name;
+
+    {
+        std::lock_guard<std::mutex> lock(gMutex);
+        slot_       = gRecords.size();
+        generation_ = gGeneration;
+        rss_        = gRssProfiling.load(std::memory_order_relaxed);
+        StageRecord rec;
+        rec.name  = full;
+        rec.depth = static_cast<int>(tStageStack.size());
+        if (rss_)
+        {
+            sampleRss();   // 外层阶段先收下到此为止的峰值，本阶段从当前 RSS 起算
+            rec.rssEntryBytes = currentRssBytes();
+            rec.peakRssBytes  = rec.rssEntryBytes;
+            gOpenStages.push_back(slot_);
+        }
+        gRecords.push_back(std::move(rec));
+    }
+
+    tStageStack.push_back(std::move(full));
+    alloc0_           = allocatedBytesTotal();
+    scratchOuterPeak_ = threadScratch().restartPeak();
+    t0_               = nowSeconds();
+}
+
+ScopedStage::~ScopedStage()
+{
+    const double        dt     = nowSeconds() - t0_;
+    const std::uint64_t dAlloc = allocatedBytesTotal() - alloc0_;
+
+    ScratchArena& scratch = threadScratch();
+    const std::size_t scratchPeak = scratch.peak();
+    scratch.mergePeak(scratchOuterPeak_);   // 外层阶段的峰值包含本阶段
+
+    tStageStack.pop_back();
+
+    std::lock_guard<std::mutex> lock(gMutex);
+    if (generation_ != gGeneration)
+    {
+        return;   // 期间 resetProfile 清掉了记录
+    }
+    StageRecord& rec = gRecords[slot_];
+    if (rss_)
+    {
+        sampleRss();
+        gOpenStages.erase(std::find(gOpenStages.begin(), gOpenStages.end(), slot_));
+        rec.rssExitBytes = currentRssBytes();
+        rec.peakRssBytes = std::max(rec.peakRssBytes, rec.rssExitBytes);
+    }
+    {
+        rec.seconds          = dt;
+        rec.allocatedBytes   = dAlloc;
+        rec.scratchPeakBytes = scratchPeak;
+        rec.cells            = cells_;
+        rec.faces            = faces_;
+        rec.bytes            = bytes_;
+    }
+}
+
+std::vector<StageRecord> profileRecords()
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    return gRecords;
+}
+
+void resetProfile()
+{
+    std::lock_guard<std::mutex> lock(gMutex);
+    gRecords.clear();
+    gOpenStages.clear();
+    ++gGeneration;
+}
+
+void writeProfileReport(std::ostream& out)
+{
+    const std::vector<StageRecord> recs = profileRecords();
+
+    out << "{\n";
+    out << "  \"processPeakRssBytes\": " << peakRssBytes() << ",\n";
+    out << "  \"allocatedBytes\": " << allocatedBytesTotal() << ",\n";
+    out << "  \"stages\": [\n";
+    for (std::size_t i = 0; i < recs.size(); ++i)
+    {
+        const StageRecord& r = recs[i];
+        out << "    {\"name\": \"" << r.name << "\""
+            << ", \"depth\": " << r.depth
+            << ", \"seconds\": " << r.seconds
+            << ", \"allocatedBytes\": " << r.allocatedBytes
+            << ", \"rssEntryBytes\": " << r.rssEntryBytes
+            << ", \"rssExitBytes\": " << r.rssExitBytes
+            << ", \"peakRssBytes\": " << r.peakRssBytes;
+        if (r.scratchPeakBytes) out << ", \"scratchPeakBytes\": " << r.scratchPeakBytes;
+        if (r.cells) { out << ", \"cells\": " << r.cells; writeRate(out, "cellsPerSecond", r.cells, r.seconds); }
+        if (r.faces) { out << ", \"faces\": " << r.faces; writeRate(out, "facesPerSecond", r.faces, r.seconds); }
+        if (r.bytes) { out << ", \"bytes\": " << r.bytes; writeRate(out, "bytesPerSecond", r.bytes, r.seconds); }
+        out << "}" << (i + 1 < recs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n";
+    out << "}\n";
+}
+
+bool writeProfileReport(const std::string& filePath)
+{
+    std::ofstream out(filePath);
+    if (!out)
+    {
+        return false;
+    }
+    writeProfileReport(out);
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// 轻量级分阶段计时 / 内存统计。
+// 用法：在函数或代码块开头放一个 ScopedStage，析构时记录：
+//   - 墙钟时间
+//   - 该阶段内通过 operator new 分配的字节数（需链接 AllocCounter.cpp，否则为 0）
+//   - 进入 / 离开该阶段时的常驻内存（RSS），以及阶段期间 RSS 的峰值：Linux 上每次阶段开始 /
+//     结束时读 VmHWM 并经 /proc/self/clear_refs 复位，峰值只覆盖该阶段（含其子阶段）；
+//     其他平台或无法复位时退化为进入 / 离开时 RSS 的较大者。RSS 是进程级的，
+//     其他线程上同时进行的阶段会计入彼此的峰值。只在 enableRssProfiling(true) 之后记录，
+//     否则这几项为 0
+//   - 该阶段内当前线程 ScratchArena 的峰值占用（见 ScratchArena.h）
+//   - 可选的 cells / faces / bytes 计数（报告里换算成每秒吞吐）
+// 嵌套的 ScopedStage 名字自动拼成 "parent/child"。
+
+struct StageRecord
+{
+    std::string   name;
+    int           depth            = 0;
+    double        seconds          = 0.0;
+    std::uint64_t allocatedBytes   = 0;
+    std::uint64_t rssEntryBytes    = 0;
+    std::uint64_t rssExitBytes     = 0;
+    std::uint64_t peakRssBytes     = 0;   // 阶段期间的峰值，不是进程峰值
+    std::uint64_t scratchPeakBytes = 0;
+    std::uint64_t cells            = 0;
+    std::uint64_t faces            = 0;
+    std::uint64_t bytes            = 0;
+};
+
+class ScopedStage
+{
+public:
+    explicit ScopedStage(const char* name);
+    ~ScopedStage();
+
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+
+    void setCells(std::uint64_t n) { cells_ = n; }
+    void setFaces(std::uint64_t n) { faces_ = n; }
+    void setBytes(std::uint64_t n) { bytes_ = n; }
+
+private:
+    std::size_t   slot_;
+    std::uint64_t generation_;   // resetProfile 之后旧阶段不再写回
+    bool          rss_;          // 进入时 RSS 采样是否打开
+    double        t0_;
+    std::uint64_t alloc0_;
+    std::size_t   scratchOuterPeak_;
+    std::uint64_t cells_ = 0;
+    std::uint64_t faces_ = 0;
+    std::uint64_t bytes_ = 0;
+};
+
+// 打开 / 关闭各阶段的 RSS 采样（默认关闭）。打开后 Linux 上每个阶段边界都会复位进程的
+// VmHWM（宿主的 ru_maxrss 随之失真）并读 /proc，只应在显式要求剖析时打开（--profile、基准测试）
+void enableRssProfiling(bool on);
+
+// 进程迄今的峰值常驻内存（字节）
+std::uint64_t peakRssBytes();
+
+// 进程当前的常驻内存（字节），取不到时为 0
+std::uint64_t currentRssBytes();
+
+// 进程迄今通过 operator new 分配的累计字节数。计数来自 AllocCounter.cpp 中替换的
+// operator new，它只链接进可执行文件；单独使用库时始终为 0
+std::uint64_t allocatedBytesTotal();
+
+// 记一次分配（AllocCounter.cpp 调用）
+void recordAllocation(std::size_t bytes);
+
+std::vector<StageRecord> profileRecords();
+void resetProfile();
+
+// 以 JSON 形式输出全部阶段记录
+void writeProfileReport(std::ostream& out);
+bool writeProfileReport(const std::string& filePath);
@@ -0,0 +1,150 @@
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr std::size_t kMinChunk = 4u << 20;   // 第一块至少 4 MiB，之后每块翻倍
+constexpr std::size_t kHugePage = 2u << 20;
+
+std::atomic<std::size_t> gReserveBytes{0};
+std::atomic<bool>        gHugePages{false};
+
+std::size_t roundUp(std::size_t n, std::size_t to)
+{
+    return (n + to - 1) / to * to;
+}
+
+} // namespace
+
+ScratchArena::~ScratchArena()
+{
+    for (const Chunk& c : chunks_)
+    {
+        ::munmap(c.data, c.size);
+    }
+}
+
+void ScratchArena::addChunk(std::size_t minBytes)
+{
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t size = std::max({minBytes, kMinChunk, chunks_.empty() ? 0 : 2 * chunks_.back().size});
+    size = roundUp(size, hugePages_ ? kHugePage : page);
+
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        std::cerr << "ScratchArena: cannot map " << size << " bytes\n";
+        std::exit(1);
+    }
+#ifdef MADV_HUGEPAGE
+    if (hugePages_)
+    {
+        ::madvise(p, size, MADV_HUGEPAGE);
+    }
+#endif
+
+    chunks_.push_back(Chunk{static_cast<char*>(p), size, capacity_});
+    capacity_ += size;
+}
+
+void* ScratchArena::allocate(std::size_t bytes, std::size_t align)
+{
+    if (chunks_.empty())
+    {
+        const std::size_t reserveBytes = gReserveBytes.load(std::memory_order_relaxed);
+        if (reserveBytes > 0)
+        {
+            reserve(reserveBytes, gHugePages.load(std::memory_order_relaxed));
+        }
+    }
+    if (bytes == 0) bytes = 1;
+
+    for (;;)
+    {
+        if (current_ < chunks_.size())
+        {
+            // 块起点按页对齐，只需对齐块内偏移
+            const Chunk& c = chunks_[current_];
+            const std::size_t start = roundUp(offset_, align);
+            if (start + bytes <= c.size)
+            {
+                offset_ = start + bytes;
+                peak_   = std::max(peak_, c.base + offset_);
+                return c.data + start;
+            }
+            if (current_ + 1 < chunks_.size())
+            {
+                ++current_;
+                offset_ = 0;
+                continue;
+            }
+        }
+        addChunk(bytes + align);
+        current_ = chunks_.size() - 1;
+        offset_  = 0;
+    }
+}
+
+void ScratchArena::release(void* p, std::size_t bytes)
+{
+    if (current_ >= chunks_.size() || bytes == 0) return;
+    char* const top = chunks_[current_].data + offset_;
+    if (static_cast<char*>(p) + bytes == top)
+    {
+        offset_ -= bytes;
+    }
+}
+
+void ScratchArena::rewind(Mark m)
+{
+    current_ = m.chunk;
+    offset_  = m.offset;
+}
+
+void ScratchArena::reserve(std::size_t bytes, bool hugePages)
+{
+    hugePages_ = hugePages_ || hugePages;
+    if (capacity_ >= bytes) return;
+
+    addChunk(bytes - capacity_);
+
+    // 逐页写一次，让缺页发生在这里而不是各阶段里
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const Chunk& c = chunks_.back();
+    for (std::size_t o = 0; o < c.size; o += page)
+    {
+        c.data[o] = 0;
+    }
+}
+
+std::size_t ScratchArena::used() const
+{
+    return current_ < chunks_.size() ? chunks_[current_].base + offset_ : 0;
+}
+
+std::size_t ScratchArena::restartPeak()
+{
+    const std::size_t old = peak_;
+    peak_ = used();
+    return old;
+}
+
+ScratchArena& threadScratch()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void configureScratch(std::size_t bytes, bool hugePages)
+{
+    gReserveBytes.store(bytes, std::memory_order_relaxed);
+    gHugePages.store(hugePages, std::memory_order_relaxed);
+}
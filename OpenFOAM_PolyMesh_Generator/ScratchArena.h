@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+// 线性（bump）分配的临时缓冲区，供各阶段中用完即弃的数组使用（applyKeepMask 的面表、
+// removeUnusedPoints 的映射等），避免每个 case 反复 malloc / free 与缺页。
+// - 内存按块（mmap）向系统申请，块在 reset / rewind 之后保留，下一阶段或下一 case 直接复用
+// - allocate 只移动游标；release 只回收最后一次分配（vector 扩容时可原地回退），其余为空操作
+// - rewind(mark) / reset() 为 O(1)，之前分配的指针全部失效
+// - 峰值用量由 ScopedStage 记入分阶段报告（scratchPeakBytes）
+// 不是线程安全的：每个线程用自己的 threadScratch()。
+class ScratchArena
+{
+public:
+    struct Mark
+    {
+        std::size_t chunk  = 0;
+        std::size_t offset = 0;
+    };
+
+    ScratchArena() = default;
+    ~ScratchArena();
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align);
+    void  release(void* p, std::size_t bytes);
+
+    Mark mark() const { return Mark{current_, offset_}; }
+    void rewind(Mark m);
+    void reset() { rewind(Mark{}); }
+
+    // 预先映射至少 bytes 字节并逐页触碰（hugePages 时先 madvise(MADV_HUGEPAGE)），
+    // 之后的分配不再缺页
+    void reserve(std::size_t bytes, bool hugePages);
+
+    std::size_t used() const;                       // 当前占用（含块尾未用的零头）
+    std::size_t capacity() const { return capacity_; }
+    std::size_t peak() const { return peak_; }
+
+    // 把峰值重置为当前占用并返回旧峰值（ScopedStage 用来统计单个阶段的峰值）
+    std::size_t restartPeak();
+    void        mergePeak(std::size_t p) { if (p > peak_) peak_ = p; }
+
+private:
+    struct Chunk
+    {
+        char*       data = nullptr;
+        std::size_t size = 0;
+        std::size_t base = 0;   // 之前各块的总大小
+    };
+
+    void addChunk(std::size_t minBytes);
+
+    std::vector<Chunk> chunks_;
+    std::size_t current_  = 0;
+    std::size_t offset_   = 0;
+    std::size_t capacity_ = 0;
+    std::size_t peak_     = 0;
+    bool        hugePages_ = false;
+};
+
+// 当前线程的临时缓冲区。第一次分配时按 configureScratch 的设置预留。
+ScratchArena& threadScratch();
+
+// 之后第一次使用 threadScratch() 的线程各自预留 bytes 字节（0 为不预留），
+// hugePages 时建议内核用大页。应在启动工作线程前调用。
+void configureScratch(std::size_t bytes, bool hugePages);
+
+// 作用域结束时把 arena 回退到进入时的位置；其间的 ScratchVector 等须在它之后声明
+class ScratchFrame
+{
+public:
+    explicit ScratchFrame(ScratchArena& arena = threadScratch()) : arena_(arena), mark_(arena.mark()) {}
+    ~ScratchFrame() { arena_.rewind(mark_); }
+
+    ScratchFrame(const ScratchFrame&) = delete;
+    ScratchFrame& operator=(const ScratchFrame&) = delete;
+
+private:
+    ScratchArena&      arena_;
+    ScratchArena::Mark mark_;
+};
+
+// 从 arena 取内存的标准分配器（默认为当前线程的 arena）
+template <class T>
+class ScratchAllocator
+{
+public:
+    using value_type = T;
+
+    ScratchAllocator() noexcept : arena_(&threadScratch()) {}
+    explicit ScratchAllocator(ScratchArena& arena) noexcept : arena_(&arena) {}
+    template <class U>
+    ScratchAllocator(const ScratchAllocator<U>& o) noexcept : arena_(o.arena()) {}
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(arena_->allocate(n * sizeof(T), alignof(T)));
+    }
+    void deallocate(T* p, std::size_t n) noexcept { arena_->release(p, n * sizeof(T)); }
+
+    ScratchArena* arena() const noexcept { return arena_; }
+
+    template <class U>
+    bool operator==(const ScratchAllocator<U>& o) const noexcept { return arena_ == o.arena(); }
+
+private:
+    ScratchArena* arena_;
+};
+
+template <class T>
+using ScratchVector = std::vector<T, ScratchAllocator<T>>;
+
+template <class K, class V, class Less = std::less<K>>
+using ScratchMap = std::map<K, V, Less, ScratchAllocator<std::pair<const K, V>>>;
@@ -0,0 +1,636 @@
+#include "SparseMask.h"
+#include "Parallel.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <utility>
+
+std::span<const KeepRun> SparseKeepMask::row(int j, int k) const
+{
+    if (j < 0 || j >= Ny || k < 0 || k >= Nz)
+    {
+        return {};
+    }
+    const std::size_t r = static_cast<std::size_t>(k) * Ny + j;
+    return std::span<const KeepRun>(runs.data() + rowStart[r], rowStart[r + 1] - rowStart[r]);
+}
+
+label SparseKeepMask::cellId(int i, int j, int k) const
+{
+    std::span<const KeepRun> rr = row(j, k);
+    auto it = std::upper_bound(rr.begin(), rr.end(), i,
+                               [](int v, const KeepRun& run) { return v < run.i1; });
+    return (it != rr.end() && it->i0 <= i) ? it->cellStart + (i - it->i0) : -1;
+}
+
+int SparseKeepMask::region(int i, int j, int k) const
+{
+    std::span<const KeepRun> rr = row(j, k);
+    auto it = std::upper_bound(rr.begin(), rr.end(), i,
+                               [](int v, const KeepRun& run) { return v < run.i1; });
+    return (it != rr.end() && it->i0 <= i) ? it->region : 0;
+}
+
+// 点行 (j, k) 中被使用的点区间，点 i 的新编号为 pointStart + (i - i0)
+struct PointRun
+{
+    int i0 = 0;
+    int i1 = 0;
+    label pointStart = 0;
+};
+
+struct SparsePointRows
+{
+    int Ny = 0;
+    std::vector<std::size_t> rowStart;   // (Ny+1)*(Nz+1) + 1 项
+    std::vector<PointRun>    runs;
+
+    std::span<const PointRun> row(int j, int k) const
+    {
+        const std::size_t r = static_cast<std::size_t>(k) * (Ny + 1) + j;
+        return std::span<const PointRun>(runs.data() + rowStart[r], rowStart[r + 1] - rowStart[r]);
+    }
+};
+
+namespace
+{
+
+constexpr std::size_t rowsPerChunk = 64;
+
+// 每块约含的背景 cell 数（SparseMeshEmitter 的块大小）
+constexpr std::size_t blockCells = 1u << 15;
+
+
+// 在一行的段上按 i 单调递增查询（每次调用不回退）
+template <class Run, label Run::*Start>
+class RowCursor
+{
+public:
+    RowCursor() = default;
+    explicit RowCursor(std::span<const Run> row) : it_(row.data()), end_(row.data() + row.size()) {}
+
+    label at(int i)
+    {
+        while (it_ != end_ && it_->i1 <= i) ++it_;
+        return (it_ != end_ && it_->i0 <= i) ? it_->*Start + (i - it_->i0) : -1;
+    }
+
+private:
+    const Run* it_  = nullptr;
+    const Run* end_ = nullptr;
+};
+
+using CellCursor  = RowCursor<KeepRun, &KeepRun::cellStart>;
+using PointCursor = RowCursor<PointRun, &PointRun::pointStart>;
+
+// 与 applyKeepMask 的 patch 顺序一致：back, front, bottom, top, reflector, left
+enum Patch { back, front, bottom, top, reflector, left, nPatches };
+
+// 被保留 cell 使用的点：点行 (j, k) 取周围最多 4 个 cell 行的段 [i0, i1] 的并
+SparsePointRows buildPointRows(const SparseKeepMask& mask, label& nPoints)
+{
+    const int Ny = mask.Ny;
+    const int Nz = mask.Nz;
+    const std::size_t nRows = static_cast<std::size_t>(Ny + 1) * (Nz + 1);
+
+    SparsePointRows pr;
+    pr.Ny = Ny;
+    pr.rowStart.assign(nRows + 1, 0);
+
+    const unsigned nChunks = parallelChunkCount(nRows, rowsPerChunk);
+    std::vector<std::vector<PointRun>> chunkRuns(nChunks);
+
+    parallelFor(nRows, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::vector<PointRun>& local = chunkRuns[chunk];
+        std::vector<std::pair<int,int>> ranges;
+        for (std::size_t r = b; r < e; ++r)
+        {
+            const int j = static_cast<int>(r % (Ny + 1));
+            const int k = static_cast<int>(r / (Ny + 1));
+
+            ranges.clear();
+            for (int dk = -1; dk <= 0; ++dk)
+            {
+                for (int dj = -1; dj <= 0; ++dj)
+                {
+                    for (const KeepRun& run : mask.row(j + dj, k + dk))
+                    {
+                        ranges.emplace_back(run.i0, run.i1 + 1);
+                    }
+                }
+            }
+            std::sort(ranges.begin(), ranges.end());
+
+            std::size_t n = 0;
+            for (const auto& [a, z] : ranges)
+            {
+                if (n > 0 && a <= local.back().i1)
+                {
+                    local.back().i1 = std::max(local.back().i1, z);
+                }
+                else
+                {
+                    local.push_back(PointRun{a, z, 0});
+                    ++n;
+                }
+            }
+            pr.rowStart[r + 1] = n;
+        }
+    }, rowsPerChunk);
+
+    for (std::size_t r = 0; r < nRows; ++r) pr.rowStart[r + 1] += pr.rowStart[r];
+    pr.runs.reserve(pr.rowStart.back());
+    for (auto& local : chunkRuns)
+    {
+        pr.runs.insert(pr.runs.end(), local.begin(), local.end());
+    }
+
+    std::int64_t next = 0;
+    for (PointRun& run : pr.runs)
+    {
+        run.pointStart = static_cast<label>(next);
+        next += run.i1 - run.i0;
+    }
+    if (next > std::numeric_limits<label>::max())
+    {
+        std::cerr << "applySparseKeepMask: " << next << " points exceed the " << 8 * sizeof(label)
+                  << "-bit label range\n";
+        std::exit(1);
+    }
+    nPoints = static_cast<label>(next);
+    return pr;
+}
+
+// 按行遍历保留的 cell，依 applyKeepMask 的顺序给出每个面：
+// 每个 cell 依次 xmin, xmax, ymin, ymax, zmin, zmax；较低编号的邻居已给出的共享面跳过
+template <class Sink>
+void walkRows(const SparseKeepMask& mask, const SparsePointRows& points,
+              std::size_t rb, std::size_t re, Sink& sink)
+{
+    const int Ny = mask.Ny;
+    const int Nz = mask.Nz;
+
+    for (std::size_t r = rb; r < re; ++r)
+    {
+        const int j = static_cast<int>(r % Ny);
+        const int k = static_cast<int>(r / Ny);
+
+        std::span<const KeepRun> runs = mask.row(j, k);
+        if (runs.empty()) continue;
+
+        CellCursor xm(runs), xp(runs);
+        CellCursor ym(mask.row(j - 1, k)), yp(mask.row(j + 1, k));
+        CellCursor zm(mask.row(j, k - 1)), zp(mask.row(j, k + 1));
+
+        PointCursor P00(points.row(j,     k    ));
+        PointCursor P10(points.row(j + 1, k    ));
+        PointCursor P01(points.row(j,     k + 1));
+        PointCursor P11(points.row(j + 1, k + 1));
+
+        for (const KeepRun& run : runs)
+        {
+            for (int i = run.i0; i < run.i1; ++i)
+            {
+                const label c = run.cellStart + (i - run.i0);
+
+                const label p000 = P00.at(i), p100 = p000 + 1;
+                const label p010 = P10.at(i), p110 = p010 + 1;
+                const label p001 = P01.at(i), p101 = p001 + 1;
+                const label p011 = P11.at(i), p111 = p011 + 1;
+
+                // xmin
+                if (xm.at(i - 1) < 0)
+                {
+                    sink.boundary(i == 0 ? left : reflector, {p000, p001, p011, p010}, c);
+                }
+
+                // xmax
+                label n = i + 1 < run.i1 ? c + 1 : xp.at(i + 1);
+                if (n >= 0) sink.internal({p100, p110, p111, p101}, c, n);
+                else        sink.boundary(reflector, {p100, p110, p111, p101}, c);
+
+                // ymin
+                if (ym.at(i) < 0)
+                {
+                    sink.boundary(j == 0 ? bottom : reflector, {p000, p100, p101, p001}, c);
+                }
+
+                // ymax
+                n = yp.at(i);
+                if (n >= 0) sink.internal({p010, p011, p111, p110}, c, n);
+                else        sink.boundary(j == Ny - 1 ? top : reflector, {p010, p011, p111, p110}, c);
+
+                // zmin
+                if (zm.at(i) < 0)
+                {
+                    sink.boundary(k == 0 ? back : reflector, {p000, p010, p110, p100}, c);
+                }
+
+                // zmax
+                n = zp.at(i);
+                if (n >= 0) sink.internal({p001, p101, p111, p011}, c, n);
+                else        sink.boundary(k == Nz - 1 ? front : reflector, {p001, p101, p111, p011}, c);
+            }
+        }
+    }
+}
+
+struct CountSink
+{
+    std::size_t nInternal = 0;
+    std::array<std::size_t, nPatches> nPatch{};
+
+    void internal(const Face&, label, label) { ++nInternal; }
+    void boundary(int p, const Face&, label) { ++nPatch[p]; }
+};
+
+// 写进一块的局部数组；有区域时同时记下两侧区域不同的内部面
+struct BlockSink
+{
+    SparseMeshBlock*         out;
+    const std::vector<char>* cellRegion;
+
+    void internal(const Face& f, label own, label nei)
+    {
+        if (!cellRegion->empty() && (*cellRegion)[own] != (*cellRegion)[nei])
+        {
+            out->regionFaces.push_back(RegionFace{static_cast<label>(out->faceStart + out->faces.size()),
+                                                  (*cellRegion)[own], (*cellRegion)[nei]});
+        }
+        out->faces.push_back(f);
+        out->owner.push_back(own);
+        out->neighbour.push_back(nei);
+    }
+    void boundary(int p, const Face& f, label own)
+    {
+        out->patchFaces[p].push_back(f);
+        out->patchOwner[p].push_back(own);
+    }
+};
+
+// 一块四边形面拷到 FaceList（resizeQuads 之后）的第 f0 个面起
+void copyQuads(const std::vector<Face>& src, FaceList& dst, std::size_t f0)
+{
+    label* v = dst.verts.data() + 4 * f0;
+    for (const Face& f : src)
+    {
+        v = std::copy(f.begin(), f.end(), v);
+    }
+}
+
+} // namespace
+
+label evaluateRegionsSparse(const GridDescriptor& grid, const RegionFunc& region, SparseKeepMask& mask)
+{
+    ScopedStage stage("maskEval");
+
+    const int Nx = grid.Nx;
+    const int Ny = grid.Ny;
+    const int Nz = grid.Nz;
+    const std::size_t nRows = static_cast<std::size_t>(Ny) * Nz;
+    stage.setCells(nRows * Nx);
+
+    const double dx = grid.Lx / Nx;
+    const double dy = grid.Ly / Ny;
+    const double dz = grid.Lz / Nz;
+
+    mask.Nx = Nx;
+    mask.Ny = Ny;
+    mask.Nz = Nz;
+    mask.rowStart.assign(nRows + 1, 0);
+    mask.runs.clear();
+
+    const unsigned nChunks = parallelChunkCount(nRows, rowsPerChunk);
+    std::vector<std::vector<KeepRun>> chunkRuns(nChunks);
+
+    parallelFor(nRows, [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::vector<KeepRun>& local = chunkRuns[chunk];
+        for (std::size_t r = b; r < e; ++r)
+        {
+            const int j = static_cast<int>(r % Ny);
+            const int k = static_cast<int>(r / Ny);
+
+            // 与 evaluateRegions 中 8 个角点平均的求和顺序相同，结果逐位一致
+            const double y0 = j * dy, y1 = (j + 1) * dy;
+            const double z0 = k * dz, z1 = (k + 1) * dz;
+            Point c{};
+            c.y = (y0 + y0 + y1 + y1 + y0 + y0 + y1 + y1) / 8.0;
+            c.z = (z0 + z0 + z0 + z0 + z1 + z1 + z1 + z1) / 8.0;
+
+            std::size_t n = 0;
+            for (int i = 0; i < Nx; ++i)
+            {
+                const double x0 = i * dx, x1 = (i + 1) * dx;
+                c.x = (x0 + x1 + x0 + x1 + x0 + x1 + x0 + x1) / 8.0;
+
+                const int rg = region(c);
+                if (rg < 0 || rg > 127)
+                {
+                    std::cerr << "applyMask: region label " << rg << " out of range 0..127\n";
+                    std::exit(1);
+                }
+                if (rg == 0) continue;
+
+                if (n > 0 && local.back().i1 == i && local.back().region == rg)
+                {
+                    ++local.back().i1;
+                }
+                else
+                {
+                    local.push_back(KeepRun{i, i + 1, 0, static_cast<char>(rg)});
+                    ++n;
+                }
+            }
+            mask.rowStart[r + 1] = n;
+        }
+    }, rowsPerChunk);
+
+    for (std::size_t r = 0; r < nRows; ++r) mask.rowStart[r + 1] += mask.rowStart[r];
+    mask.runs.reserve(mask.rowStart.back());
+    for (auto& local : chunkRuns)
+    {
+        mask.runs.insert(mask.runs.end(), local.begin(), local.end());
+    }
+
+    std::int64_t next = 0;
+    for (KeepRun& run : mask.runs)
+    {
+        run.cellStart = static_cast<label>(next);
+        next += run.i1 - run.i0;
+    }
+    if (next > std::numeric_limits<label>::max())
+    {
+        std::cerr << "evaluateRegionsSparse: " << next << " kept cells exceed the " << 8 * sizeof(label)
+                  << "-bit label range\n";
+        std::exit(1);
+    }
+    mask.cellCount = static_cast<label>(next);
+    return mask.cellCount;
+}
+
+SparseMeshEmitter::SparseMeshEmitter(const GridDescriptor& grid, const SparseKeepMask& mask,
+                                     const std::vector<std::string>& regionNames)
+    : mask_(mask), grid_(grid), regionNames_(regionNames)
+{
+    ScopedStage stage("countFaces");
+
+    const int Nx = mask.Nx;
+    const int Ny = mask.Ny;
+    const int Nz = mask.Nz;
+    const std::size_t nRows = static_cast<std::size_t>(Ny) * Nz;
+
+    if (grid.Nx != Nx || grid.Ny != Ny || grid.Nz != Nz || mask.rowStart.size() != nRows + 1)
+    {
+        std::cerr << "SparseMeshEmitter: mask is " << Nx << "x" << Ny << "x" << Nz
+                  << ", grid is " << grid.Nx << "x" << grid.Ny << "x" << grid.Nz << "\n";
+        std::exit(1);
+    }
+
+    // 1) 被使用的点
+    points_ = std::make_unique<SparsePointRows>(buildPointRows(mask, nPoints_));
+
+    // 2) 分块：每块 rowsPerBlock_ 个 cell 行，点行按相同块数均分
+    rowsPerBlock_ = std::max<std::size_t>(1, blockCells / static_cast<std::size_t>(Nx));
+    nBlocks_      = (nRows + rowsPerBlock_ - 1) / rowsPerBlock_;
+
+    const std::size_t nPointRows = points_->rowStart.size() - 1;
+    blockPointStart_.assign(nBlocks_ + 1, static_cast<std::size_t>(nPoints_));
+    for (std::size_t b = 0; b < nBlocks_; ++b)
+    {
+        const std::size_t s = points_->rowStart[b * nPointRows / nBlocks_];
+        if (s < points_->runs.size()) blockPointStart_[b] = static_cast<std::size_t>(points_->runs[s].pointStart);
+    }
+
+    // 3) 每块的内部面 / 各 patch 面数，前缀和得到各块在最终编号中的起点
+    std::vector<CountSink> counts(nBlocks_);
+    parallelFor(nBlocks_, [&](std::size_t b, std::size_t e, unsigned)
+    {
+        for (std::size_t blk = b; blk < e; ++blk)
+        {
+            walkRows(mask, *points_, blk * rowsPerBlock_, std::min(nRows, (blk + 1) * rowsPerBlock_), counts[blk]);
+        }
+    }, 1);
+
+    std::array<std::size_t, nPatches> patchSize{};
+    blockFaceStart_.assign(nBlocks_ + 1, 0);
+    for (std::size_t b = 0; b < nBlocks_; ++b)
+    {
+        blockFaceStart_[b + 1] = blockFaceStart_[b] + counts[b].nInternal;
+        for (int p = 0; p < nPatches; ++p) patchSize[p] += counts[b].nPatch[p];
+    }
+    nInternal_ = blockFaceStart_.back();
+
+    static const char* const patchNames[nPatches] = {"back", "front", "bottom", "top", "reflector", "left"};
+    blockPatchStart_.resize(nBlocks_ * nPatches);
+    std::size_t faceStart = nInternal_;
+    for (int p = 0; p < nPatches; ++p)
+    {
+        PatchInfo patch;
+        patch.name      = patchNames[p];
+        patch.startFace = static_cast<label>(std::min<std::size_t>(faceStart, std::numeric_limits<label>::max()));
+        patch.nFaces    = static_cast<label>(std::min<std::size_t>(patchSize[p], std::numeric_limits<label>::max()));
+        patches_.push_back(patch);
+
+        for (std::size_t b = 0; b < nBlocks_; ++b)
+        {
+            blockPatchStart_[b * nPatches + p] = faceStart;
+            faceStart += counts[b].nPatch[p];
+        }
+    }
+    nFaces_ = faceStart;
+    if (nFaces_ > static_cast<std::size_t>(std::numeric_limits<label>::max()))
+    {
+        std::cerr << "applySparseKeepMask: " << nFaces_ << " faces exceed the " << 8 * sizeof(label)
+                  << "-bit label range\n";
+        std::exit(1);
+    }
+
+    // 4) 有区域时按 cell 记下区域编号（faceZone 用）
+    if (!regionNames_.empty())
+    {
+        cellRegion_.resize(static_cast<std::size_t>(mask.cellCount));
+        for (const KeepRun& run : mask.runs)
+        {
+            if (run.region > static_cast<int>(regionNames_.size()))
+            {
+                std::cerr << "applyMask: region label " << static_cast<int>(run.region) << " has no name ("
+                          << regionNames_.size() << " regions)\n";
+                std::exit(1);
+            }
+            std::fill_n(cellRegion_.begin() + run.cellStart, run.i1 - run.i0, run.region);
+        }
+    }
+
+    stage.setCells(static_cast<std::uint64_t>(mask.cellCount));
+    stage.setFaces(nFaces_);
+}
+
+SparseMeshEmitter::~SparseMeshEmitter() = default;
+
+void SparseMeshEmitter::emit(std::size_t b, SparseMeshBlock& out) const
+{
+    const int Ny = mask_.Ny;
+    const std::size_t nRows = static_cast<std::size_t>(Ny) * mask_.Nz;
+
+    // 点：坐标与 generateStructuredMesh 相同
+    const double dx = grid_.Lx / grid_.Nx;
+    const double dy = grid_.Ly / grid_.Ny;
+    const double dz = grid_.Lz / grid_.Nz;
+
+    const std::size_t nPointRows = points_->rowStart.size() - 1;
+    out.pointStart = blockPointStart_[b];
+    out.points.clear();
+    for (std::size_t r = b * nPointRows / nBlocks_; r < (b + 1) * nPointRows / nBlocks_; ++r)
+    {
+        const int j = static_cast<int>(r % (Ny + 1));
+        const int k = static_cast<int>(r / (Ny + 1));
+        for (std::size_t s = points_->rowStart[r]; s < points_->rowStart[r + 1]; ++s)
+        {
+            const PointRun& run = points_->runs[s];
+            for (int i = run.i0; i < run.i1; ++i)
+            {
+                out.points.push_back(Point{i * dx, j * dy, k * dz});
+            }
+        }
+    }
+
+    // 面
+    out.faceStart = blockFaceStart_[b];
+    out.faces.clear();
+    out.owner.clear();
+    out.neighbour.clear();
+    out.regionFaces.clear();
+    out.patchFaceStart.assign(blockPatchStart_.begin() + static_cast<std::ptrdiff_t>(b * nPatches),
+                              blockPatchStart_.begin() + static_cast<std::ptrdiff_t>((b + 1) * nPatches));
+    out.patchFaces.resize(nPatches);
+    out.patchOwner.resize(nPatches);
+    for (int p = 0; p < nPatches; ++p)
+    {
+        out.patchFaces[p].clear();
+        out.patchOwner[p].clear();
+    }
+
+    BlockSink sink{&out, &cellRegion_};
+    walkRows(mask_, *points_, b * rowsPerBlock_, std::min(nRows, (b + 1) * rowsPerBlock_), sink);
+}
+
+std::vector<CellZone> SparseMeshEmitter::cellZones() const
+{
+    std::vector<CellZone> zones(regionNames_.size());
+    for (std::size_t r = 0; r < regionNames_.size(); ++r)
+    {
+        zones[r].name = regionNames_[r];
+    }
+    for (const KeepRun& run : mask_.runs)
+    {
+        std::vector<label>& cells = zones[run.region - 1].cells;
+        for (label c = run.cellStart; c < run.cellStart + (run.i1 - run.i0); ++c)
+        {
+            cells.push_back(c);
+        }
+    }
+    return zones;
+}
+
+void SparseMeshEmitter::appendFaceZones(std::span<const RegionFace> faces, std::vector<FaceZone>& zones)
+{
+    for (const RegionFace& f : faces)
+    {
+        const int ro = f.owner;
+        const int rn = f.neighbour;
+        const auto key = std::make_pair(std::min(ro, rn), std::max(ro, rn));
+        auto it = faceZoneOf_.find(key);
+        if (it == faceZoneOf_.end())
+        {
+            it = faceZoneOf_.emplace(key, zones.size()).first;
+            zones.push_back(FaceZone{
+                regionNames_[key.first - 1] + "_" + regionNames_[key.second - 1], {}, {}});
+        }
+        FaceZone& z = zones[it->second];
+        z.faces.push_back(f.face);
+        z.flipMap.push_back(ro > rn ? 1 : 0);
+    }
+}
+
+MeshData applySparseKeepMask(const GridDescriptor& grid, const SparseKeepMask& mask,
+                             const std::vector<std::string>& regionNames)
+{
+    ScopedStage stage("applySparseMask");
+
+    const std::size_t nRows = static_cast<std::size_t>(mask.Ny) * mask.Nz;
+    stage.setCells(static_cast<std::uint64_t>(mask.cellCount));
+
+    if (mask.cellCount == 0)
+    {
+        std::cerr << "applyMask: no cells left after masking!\n";
+        std::exit(1);
+    }
+
+    SparseMeshEmitter emitter(grid, mask, regionNames);
+
+    MeshData out;
+    out.Nx = mask.Nx;
+    out.Ny = mask.Ny;
+    out.Nz = mask.Nz;
+    out.points.resize(static_cast<std::size_t>(emitter.nPoints()));
+    out.faces.resizeQuads(emitter.nFaces());
+    out.owner.resize(emitter.nFaces());
+    out.neighbour.resize(emitter.nInternalFaces());
+    out.patches = emitter.patches();
+
+    // 各块独立生成，拷到各自的最终位置
+    std::vector<std::vector<RegionFace>> regionFaces(emitter.nBlocks());
+    {
+        ScopedStage emitStage("faceEmission");
+        emitStage.setCells(static_cast<std::uint64_t>(mask.cellCount));
+
+        parallelFor(emitter.nBlocks(), [&](std::size_t b, std::size_t e, unsigned)
+        {
+            SparseMeshBlock blk;
+            for (std::size_t i = b; i < e; ++i)
+            {
+                emitter.emit(i, blk);
+                std::copy(blk.points.begin(), blk.points.end(),
+                          out.points.begin() + static_cast<std::ptrdiff_t>(blk.pointStart));
+                const auto f0 = static_cast<std::ptrdiff_t>(blk.faceStart);
+                copyQuads(blk.faces, out.faces, blk.faceStart);
+                std::copy(blk.owner.begin(), blk.owner.end(), out.owner.begin() + f0);
+                std::copy(blk.neighbour.begin(), blk.neighbour.end(), out.neighbour.begin() + f0);
+                for (std::size_t p = 0; p < blk.patchFaces.size(); ++p)
+                {
+                    const auto p0 = static_cast<std::ptrdiff_t>(blk.patchFaceStart[p]);
+                    copyQuads(blk.patchFaces[p], out.faces, blk.patchFaceStart[p]);
+                    std::copy(blk.patchOwner[p].begin(), blk.patchOwner[p].end(), out.owner.begin() + p0);
+                }
+                regionFaces[i] = std::move(blk.regionFaces);
+            }
+        }, 1);
+
+        emitStage.setFaces(out.faces.size());
+    }
+
+    // zone：区域 r 的 cell 组成 cellZone，两侧区域不同的内部面组成 faceZone
+    if (!regionNames.empty())
+    {
+        out.cellZones = emitter.cellZones();
+        for (const std::vector<RegionFace>& faces : regionFaces)
+        {
+            emitter.appendFaceZones(faces, out.faceZones);
+        }
+    }
+
+    std::cout << "applyMask: old cells = " << static_cast<std::int64_t>(nRows) * mask.Nx
+              << ", new cells = " << mask.cellCount << " (" << mask.runs.size() << " runs)\n";
+    std::cout << "applyMask: internal faces new = " << out.neighbour.size()
+              << ", boundary faces = " << (out.faces.size() - out.neighbour.size()) << "\n";
+
+    return out;
+}
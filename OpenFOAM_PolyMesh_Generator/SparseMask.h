@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "MeshTypes.h"
+#include "DomainMask.h"
+
+// 游程编码的 keep 图，用于远大于内存的背景网格：
+// 每一行 (j, k) 只存连续保留、区域相同的 i 区间，外加每段第一个 cell 的新编号（前缀和），
+// 因此内存只与保留的 cell / 段数成正比（外加每行一个偏移）。
+// 背景网格本身不生成：单元中心、点坐标都由 GridDescriptor 直接算出，
+// 面与点的生成、邻居查询都直接在段上进行。
+
+struct KeepRun
+{
+    int  i0 = 0;          // [i0, i1)
+    int  i1 = 0;
+    label cellStart = 0;  // cell i 的新编号为 cellStart + (i - i0)
+    char region = 1;      // 1..127（普通掩模为 1）
+};
+
+struct SparseKeepMask
+{
+    int Nx = 0;
+    int Ny = 0;
+    int Nz = 0;
+    label cellCount = 0;
+
+    std::vector<std::size_t> rowStart;   // Ny*Nz + 1 项，行 k*Ny + j 的段为 runs[rowStart[r], rowStart[r+1])
+    std::vector<KeepRun>     runs;       // 按行、行内按 i 排列
+
+    std::span<const KeepRun> row(int j, int k) const;
+
+    // 新 cell 编号，被删或越界为 -1（行内二分查找）
+    label cellId(int i, int j, int k) const;
+
+    // 区域编号，被删或越界为 0
+    int region(int i, int j, int k) const;
+};
+
+// 在 GridDescriptor 描述的背景网格单元中心上求值区域掩模（并行），返回保留数。
+// 单元中心与 generateStructuredMesh + evaluateRegions 的结果逐位相同；region 会被多线程调用。
+label evaluateRegionsSparse(const GridDescriptor& grid, const RegionFunc& region, SparseKeepMask& mask);
+
+// 两侧区域不同的内部面（faceZone 的候选）
+struct RegionFace
+{
+    label face      = 0;
+    char owner     = 0;   // owner / neighbour 一侧的区域编号
+    char neighbour = 0;
+};
+
+// 一块背景行生成的网格片段。块内的点、内部面、各 patch 的边界面在最终编号中各自连续，
+// 按块顺序拼接即得到 applySparseKeepMask 的结果。
+struct SparseMeshBlock
+{
+    std::size_t        pointStart = 0;   // points[0] 的编号
+    std::vector<Point> points;
+
+    std::size_t                    faceStart = 0;   // 第一个内部面的编号
+    std::vector<Face> faces;           // 内部面
+    std::vector<label>             owner;
+    std::vector<label>             neighbour;
+
+    std::vector<std::size_t>                    patchFaceStart;   // 按默认 patch：本块第一个面的编号
+    std::vector<std::vector<Face>> patchFaces;
+    std::vector<std::vector<label>>             patchOwner;
+
+    std::vector<RegionFace> regionFaces;   // 只在给了 regionNames 时填写
+};
+
+struct SparsePointRows;
+
+// 按块生成游程 keep 图对应的网格：构造时（并行）算出被使用的点与每块的面数，
+// 之后各块可由任意线程独立生成，整个网格不必同时放在内存里。
+// 块为固定行数的连续背景行（k*Ny + j），点按点行同样分成 nBlocks() 块。
+class SparseMeshEmitter
+{
+public:
+    SparseMeshEmitter(const GridDescriptor& grid, const SparseKeepMask& mask,
+                      const std::vector<std::string>& regionNames = {});
+    ~SparseMeshEmitter();
+
+    SparseMeshEmitter(const SparseMeshEmitter&) = delete;
+    SparseMeshEmitter& operator=(const SparseMeshEmitter&) = delete;
+
+    label       nCells() const         { return mask_.cellCount; }
+    label       nPoints() const        { return nPoints_; }
+    std::size_t nInternalFaces() const { return nInternal_; }
+    std::size_t nFaces() const         { return nFaces_; }
+    std::size_t nBlocks() const        { return nBlocks_; }
+
+    // 默认 patch（back, front, bottom, top, reflector, left），startFace / nFaces 已确定
+    const std::vector<PatchInfo>& patches() const { return patches_; }
+
+    // 生成第 b 块；可并发调用，out 的容量在多次调用间复用
+    void emit(std::size_t b, SparseMeshBlock& out) const;
+
+    // regionNames 对应的 cellZone（区域 r 为 cellZones[r-1]）
+    std::vector<CellZone> cellZones() const;
+
+    // 按面编号递增的顺序（即块顺序）把 regionFaces 追加进 faceZone，
+    // 区域对按首次出现的顺序编号；只能由一个线程依次调用
+    void appendFaceZones(std::span<const RegionFace> faces, std::vector<FaceZone>& zones);
+
+private:
+    const SparseKeepMask&            mask_;
+    GridDescriptor                   grid_;
+    std::vector<std::string>         regionNames_;
+    std::unique_ptr<SparsePointRows> points_;
+    label                            nPoints_ = 0;
+
+    std::size_t rowsPerBlock_ = 1;
+    std::size_t nBlocks_      = 0;
+    std::size_t nInternal_    = 0;
+    std::size_t nFaces_       = 0;
+    std::vector<PatchInfo>    patches_;
+
+    std::vector<std::size_t> blockPointStart_;   // nBlocks + 1
+    std::vector<std::size_t> blockFaceStart_;    // nBlocks + 1，内部面
+    std::vector<std::size_t> blockPatchStart_;   // nBlocks * nPatches
+
+    std::vector<char>                           cellRegion_;   // 只在给了 regionNames 时
+    std::map<std::pair<int,int>, std::size_t>   faceZoneOf_;
+};
+
+// 由游程 keep 图直接生成裁剪后的网格：面、owner / neighbour、patch、zone 与
+// applyKeepMask + removeUnusedPoints 的结果完全一致，但只生成被使用的点，
+// 也不需要 keepCell / cellMap 等背景大小的数组。由 SparseMeshEmitter 按块并行生成后拼接。
+MeshData applySparseKeepMask(const GridDescriptor& grid, const SparseKeepMask& mask,
+                             const std::vector<std::string>& regionNames = {});
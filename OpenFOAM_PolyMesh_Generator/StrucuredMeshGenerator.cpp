@@ -2,20 +2,34 @@
 #include <iostream>
 #include <cstdlib>
 #include <cmath>
+#include <limits>
 #include "StructuredMeshGenerator.h"
+#include "Profiler.h"
 
 MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
                                 double Lx, double Ly, double Lz)
 {
+    ScopedStage stage("generateStructuredMesh");
+
     MeshData m;
     m.Nx = Nx; m.Ny = Ny; m.Nz = Nz;
 
-    const int nPoints = (Nx+1)*(Ny+1)*(Nz+1);
-    m.points.resize(nPoints);
+    // 点数 / 面数按 64 位算，超出 label 范围时报错而不是静默回绕
+    const std::int64_t nPoints = std::int64_t(Nx + 1) * (Ny + 1) * (Nz + 1);
+    const std::int64_t nFaces  = std::int64_t(Nx + 1) * Ny * Nz + std::int64_t(Ny + 1) * Nx * Nz
+                               + std::int64_t(Nz + 1) * Nx * Ny;
+    if (std::max(nPoints, nFaces) > std::numeric_limits<label>::max())
+    {
+        std::cerr << "generateStructuredMesh: " << nPoints << " points / " << nFaces
+                  << " faces exceed the " << 8 * sizeof(label) << "-bit label range"
+                  << " (build with PMG_LABEL_64)\n";
+        std::exit(1);
+    }
+    m.points.resize(static_cast<std::size_t>(nPoints));
 
-    auto pointIndex = [Nx, Ny](int i, int j, int k) -> int
+    auto pointIndex = [Nx, Ny](int i, int j, int k) -> label
     {
-        return k * (Ny + 1) * (Nx + 1) + j * (Nx + 1) + i;
+        return label(k) * (Ny + 1) * (Nx + 1) + label(j) * (Nx + 1) + i;
     };
 
     // 1) 生成点坐标
@@ -29,7 +43,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
         {
             for (int i = 0; i <= Nx; ++i)
             {
-                int p = pointIndex(i,j,k);
+                const label p = pointIndex(i,j,k);
                 m.points[p].x = i * dx;
                 m.points[p].y = j * dy;
                 m.points[p].z = k * dz;
@@ -38,17 +52,18 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     }
 
     // 2) 生成 internal faces
-    std::vector<std::array<int,4>> faces;
-    std::vector<int> owner;
-    std::vector<int> neighbour;
+    FaceList           faces;
+    std::vector<label> owner;
+    std::vector<label> neighbour;
 
-    faces.reserve(3 * Nx * Ny * Nz);  // 粗略预估
-    owner.reserve(3 * Nx * Ny * Nz);
-    neighbour.reserve(3 * Nx * Ny * Nz);
+    const std::size_t nCells = static_cast<std::size_t>(Nx) * Ny * Nz;
+    faces.reserve(static_cast<std::size_t>(nFaces), 4 * static_cast<std::size_t>(nFaces));
+    owner.reserve(static_cast<std::size_t>(nFaces));
+    neighbour.reserve(3 * nCells);  // 粗略预估
 
-    auto cellIndex = [Nx, Ny](int i, int j, int k) -> int
+    auto cellIndex = [Nx, Ny](int i, int j, int k) -> label
     {
-        return k * (Ny * Nx) + j * Nx + i;
+        return label(k) * Ny * Nx + label(j) * Nx + i;
     };
 
     // 2.1 x 方向 internal faces, 法向 ~ +x
@@ -58,8 +73,8 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
         {
             for (int i = 0; i < Nx-1; ++i)
             {
-                int cL = cellIndex(i,   j, k); // owner
-                int cR = cellIndex(i+1, j, k); // neighbour
+                label cL = cellIndex(i,   j, k); // owner
+                label cR = cellIndex(i+1, j, k); // neighbour
 
                 int iFace = i+1;
                 int j0 = j;
@@ -67,7 +82,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
                 int k0 = k;
                 int k1 = k+1;
 
-                std::array<int,4> f;
+                Face f;
                 f[0] = pointIndex(iFace, j0, k0);
                 f[1] = pointIndex(iFace, j1, k0);
                 f[2] = pointIndex(iFace, j1, k1);
@@ -87,8 +102,8 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
         {
             for (int i = 0; i < Nx; ++i)
             {
-                int cD = cellIndex(i, j,   k); // owner (down)
-                int cU = cellIndex(i, j+1, k); // neighbour (up)
+                label cD = cellIndex(i, j,   k); // owner (down)
+                label cU = cellIndex(i, j+1, k); // neighbour (up)
 
                 int jFace = j+1;
                 int i0 = i;
@@ -96,7 +111,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
                 int k0 = k;
                 int k1 = k+1;
 
-                std::array<int,4> f;
+                Face f;
                 f[0] = pointIndex(i0, jFace, k0);
                 f[1] = pointIndex(i1, jFace, k0);
                 f[2] = pointIndex(i1, jFace, k1);
@@ -116,8 +131,8 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
         {
             for (int i = 0; i < Nx; ++i)
             {
-                int cB = cellIndex(i, j, k);   // owner (bottom)
-                int cT = cellIndex(i, j, k+1); // neighbour (top)
+                label cB = cellIndex(i, j, k);   // owner (bottom)
+                label cT = cellIndex(i, j, k+1); // neighbour (top)
 
                 int kFace = k+1;
                 int i0 = i;
@@ -125,7 +140,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
                 int j0 = j;
                 int j1 = j+1;
 
-                std::array<int,4> f;
+                Face f;
                 f[0] = pointIndex(i0, j0, kFace);
                 f[1] = pointIndex(i1, j0, kFace);
                 f[2] = pointIndex(i1, j1, kFace);
@@ -148,7 +163,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int j = 0; j < Ny; ++j)
         {
-            int c = cellIndex(0, j, k); // 最左一列 cell
+            label c = cellIndex(0, j, k); // 最左一列 cell
 
             int iFace = 0;
             int j0 = j;
@@ -156,7 +171,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int k0 = k;
             int k1 = k+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(iFace, j0, k0);
             f[1] = pointIndex(iFace, j0, k1);
             f[2] = pointIndex(iFace, j1, k1);
@@ -173,7 +188,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int j = 0; j < Ny; ++j)
         {
-            int c = cellIndex(Nx-1, j, k); // 最右一列 cell
+            label c = cellIndex(Nx-1, j, k); // 最右一列 cell
 
             int iFace = Nx;
             int j0 = j;
@@ -181,7 +196,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int k0 = k;
             int k1 = k+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(iFace, j0, k0);
             f[1] = pointIndex(iFace, j1, k0);
             f[2] = pointIndex(iFace, j1, k1);
@@ -197,7 +212,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int i = 0; i < Nx; ++i)
         {
-            int c = cellIndex(i, 0, k);
+            label c = cellIndex(i, 0, k);
 
             int jFace = 0;
             int i0 = i;
@@ -205,7 +220,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int k0 = k;
             int k1 = k+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(i0, jFace, k0);
             f[1] = pointIndex(i1, jFace, k0);
             f[2] = pointIndex(i1, jFace, k1);
@@ -221,7 +236,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int i = 0; i < Nx; ++i)
         {
-            int c = cellIndex(i, Ny-1, k);
+            label c = cellIndex(i, Ny-1, k);
 
             int jFace = Ny;
             int i0 = i;
@@ -229,7 +244,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int k0 = k;
             int k1 = k+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(i0, jFace, k0);
             f[1] = pointIndex(i0, jFace, k1);
             f[2] = pointIndex(i1, jFace, k1);
@@ -245,7 +260,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int i = 0; i < Nx; ++i)
         {
-            int c = cellIndex(i, j, 0);
+            label c = cellIndex(i, j, 0);
 
             int kFace = 0;
             int i0 = i;
@@ -253,7 +268,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int j0 = j;
             int j1 = j+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(i0, j0, kFace);
             f[1] = pointIndex(i0, j1, kFace);
             f[2] = pointIndex(i1, j1, kFace);
@@ -269,7 +284,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
     {
         for (int i = 0; i < Nx; ++i)
         {
-            int c = cellIndex(i, j, Nz-1);
+            label c = cellIndex(i, j, Nz-1);
 
             int kFace = Nz;
             int i0 = i;
@@ -277,7 +292,7 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
             int j0 = j;
             int j1 = j+1;
 
-            std::array<int,4> f;
+            Face f;
             f[0] = pointIndex(i0, j0, kFace);
             f[1] = pointIndex(i1, j0, kFace);
             f[2] = pointIndex(i1, j1, kFace);
@@ -288,16 +303,16 @@ MeshData generateStructuredMesh(int Nx, int Ny, int Nz,
         }
     }
 
+    stage.setCells(nCells);
+    stage.setFaces(faces.size());
+
     // ==== 收尾 ====
     m.faces     = std::move(faces);
     m.owner     = std::move(owner);
     m.neighbour = std::move(neighbour);
 
     // patch 起点留空，交给后面的 DomainMask 重新划分
-    m.startFaceFront = m.startFaceBack = m.startFaceTop = m.startFaceBottom =
-    m.startFaceLeft  = m.startFaceRight = 0;
-    m.nFacesFront = m.nFacesBack = m.nFacesTop = m.nFacesBottom =
-    m.nFacesLeft  = m.nFacesRight = 0;
+    m.patches.clear();
 
     return m;
 }
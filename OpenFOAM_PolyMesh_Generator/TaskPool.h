@@ -0,0 +1,94 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 固定线程数的任务池：submit() 投递任务，wait() 等待当前所有任务完成。
+// 每个工作线程有自己的编号（0..size()-1），任务可以据此使用线程私有的缓冲区。
+class TaskPool
+{
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit TaskPool(unsigned nThreads = 0)
+    {
+        if (nThreads == 0)
+        {
+            nThreads = std::thread::hardware_concurrency();
+            if (nThreads == 0) nThreads = 1;
+        }
+        threads_.reserve(nThreads);
+        for (unsigned w = 0; w < nThreads; ++w)
+        {
+            threads_.emplace_back([this, w]() { workerLoop(w); });
+        }
+    }
+
+    ~TaskPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        cvTask_.notify_all();
+        for (auto& t : threads_) t.join();
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+    void submit(Task task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.push_back(std::move(task));
+            ++pending_;
+        }
+        cvTask_.notify_one();
+    }
+
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cvDone_.wait(lock, [this]() { return pending_ == 0; });
+    }
+
+private:
+    void workerLoop(unsigned w)
+    {
+        while (true)
+        {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cvTask_.wait(lock, [this]() { return stop_ || !tasks_.empty(); });
+                if (stop_ && tasks_.empty()) return;
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            task(w);
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --pending_;
+                if (pending_ == 0) cvDone_.notify_all();
+            }
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::deque<Task>         tasks_;
+    std::mutex               mutex_;
+    std::condition_variable  cvTask_;
+    std::condition_variable  cvDone_;
+    std::size_t              pending_ = 0;
+    bool                     stop_    = false;
+};
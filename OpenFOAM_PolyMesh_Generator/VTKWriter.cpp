@@ -1,5 +1,7 @@
 
 #include "VTKWriter.h"
+#include "GzipStream.h"
+#include "Profiler.h"
 
 #include <fstream>
 #include <iomanip>
@@ -7,11 +9,20 @@
 
 void writeVTKSurface(const MeshData& mesh, const std::string& filePath)
 {
+    const bool gzip = filePath.size() > 3 && filePath.compare(filePath.size() - 3, 3, ".gz") == 0;
+    writeVTKSurface(mesh, filePath, gzip);
+}
+
+void writeVTKSurface(const MeshData& mesh, const std::string& filePath, bool gzip)
+{
+    ScopedStage stage("writeVTKSurface");
+
     // 将整个面集合按 VTK POLYDATA 写出，便于在 ParaView 中快速检查拓扑
     const std::size_t nPoints = mesh.points.size();
     const std::size_t nFaces  = mesh.faces.size();
 
-    std::ofstream out(filePath);
+    auto file = openOutputFile(filePath, gzip);
+    std::ostream& out = *file;
     if (!out)
     {
         std::cerr << "Cannot open VTK file for writing: " << filePath << std::endl;
@@ -32,20 +43,26 @@ void writeVTKSurface(const MeshData& mesh, const std::string& filePath)
     }
 
     // 写 faces 作为 POLYGONS
-    // 每个面是四边形：行格式为: 4 idx0 idx1 idx2 idx3
-    const std::size_t vertsPerFace = 4;
-    const std::size_t listSize = nFaces * (1 + vertsPerFace); // 每面行首一个数字 + 4 个顶点索引
+    // 行格式为: n idx0 ... idx(n-1)；list 大小为每面行首一个数字 + n 个顶点索引之和
+    const std::size_t listSize = nFaces + mesh.faces.verts.size();
 
     out << "POLYGONS " << nFaces << " " << listSize << "\n";
-    for (const auto& f : mesh.faces)
+    for (std::size_t f = 0; f < nFaces; ++f)
     {
-        out << vertsPerFace;
-        for (int k = 0; k < 4; ++k)
+        const auto fv = mesh.faces[f];
+        out << fv.size();
+        for (label v : fv)
         {
-            out << " " << f[k];
+            out << " " << v;
         }
         out << "\n";
     }
 
-    out.close();
+    stage.setFaces(nFaces);
+    stage.setBytes(static_cast<std::uint64_t>(out.tellp()));
+
+    if (!closeOutputFile(out))
+    {
+        std::cerr << "Error writing VTK file " << filePath << std::endl;
+    }
 }
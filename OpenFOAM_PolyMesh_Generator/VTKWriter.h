@@ -4,6 +4,8 @@
 #include <string>
 #include "MeshTypes.h"
 
-// 以 VTK legacy POLYDATA 格式写出所有 faces（用于在 ParaView 中快速检查拓扑）
+// 以 VTK legacy POLYDATA 格式写出所有 faces（用于在 ParaView 中快速检查拓扑）。
+// filePath 以 .gz 结尾时并行 gzip 压缩（GzipStream）
 void writeVTKSurface(const MeshData& mesh, const std::string& filePath);
+void writeVTKSurface(const MeshData& mesh, const std::string& filePath, bool gzip);
 
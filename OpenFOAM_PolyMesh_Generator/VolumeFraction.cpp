@@ -0,0 +1,167 @@
+#include "VolumeFraction.h"
+#include "Parallel.h"
+#include "Profiler.h"
+#include "ScratchArena.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <iostream>
+
+std::vector<double> computeVolumeFraction(const MeshData& bgMesh, const std::vector<char>& keepCell,
+                                          const MaskFunc& inDomain, int nSub)
+{
+    ScopedStage stage("volumeFraction");
+
+    const int Nx = bgMesh.Nx;
+    const int Ny = bgMesh.Ny;
+    const int Nz = bgMesh.Nz;
+    const label nCellsOld = label(Nx) * Ny * Nz;
+
+    auto pointIndex = [Nx, Ny](int i, int j, int k) -> label
+    {
+        return label(k) * (Ny + 1) * (Nx + 1) + label(j) * (Nx + 1) + i;
+    };
+
+    if (static_cast<label>(keepCell.size()) != nCellsOld || nCellsOld == 0)
+    {
+        std::cerr << "computeVolumeFraction: keep mask size " << keepCell.size()
+                  << " does not match background cells " << nCellsOld << "\n";
+        std::exit(1);
+    }
+    if (nSub < 1)
+    {
+        std::cerr << "computeVolumeFraction: need at least one sample per direction\n";
+        std::exit(1);
+    }
+
+    // 1) 压缩编号，并找出界面 cell：26 邻域内（不越出背景网格）有被删的 cell
+    ScratchFrame scratch;
+    ScratchVector<label> cellMap(nCellsOld, -1);
+    label nKept = 0;
+    for (label c = 0; c < nCellsOld; ++c)
+    {
+        if (keepCell[c]) cellMap[c] = nKept++;
+    }
+
+    std::vector<std::vector<label>> chunkCells(parallelChunkCount(nCellsOld));
+    parallelFor(static_cast<std::size_t>(nCellsOld), [&](std::size_t b, std::size_t e, unsigned chunk)
+    {
+        std::vector<label>& list = chunkCells[chunk];
+        for (std::size_t c = b; c < e; ++c)
+        {
+            if (!keepCell[c]) continue;
+
+            const int i = static_cast<int>(c % Nx);
+            const int j = static_cast<int>(c / Nx % Ny);
+            const int k = static_cast<int>(c / (static_cast<std::size_t>(Nx) * Ny));
+
+            bool nearInterface = false;
+            for (int dk = std::max(k - 1, 0); dk <= std::min(k + 1, Nz - 1) && !nearInterface; ++dk)
+            {
+                for (int dj = std::max(j - 1, 0); dj <= std::min(j + 1, Ny - 1) && !nearInterface; ++dj)
+                {
+                    for (int di = std::max(i - 1, 0); di <= std::min(i + 1, Nx - 1); ++di)
+                    {
+                        if (!keepCell[label(dk) * Ny * Nx + label(dj) * Nx + di])
+                        {
+                            nearInterface = true;
+                            break;
+                        }
+                    }
+                }
+            }
+            if (nearInterface) list.push_back(static_cast<label>(c));
+        }
+    });
+
+    ScratchVector<label> interfaceCells;
+    for (auto& list : chunkCells)
+    {
+        interfaceCells.insert(interfaceCells.end(), list.begin(), list.end());
+    }
+
+    // 2) 子单元中心的三线性插值权重表，顶点顺序 p000 p100 p010 p110 p001 p101 p011 p111
+    const bool twoD = Nz == 1;
+    const int  nK   = twoD ? 1 : nSub;
+    const int  nSamples = nSub * nSub * nK;
+
+    std::vector<std::array<double,8>> weights;
+    weights.reserve(nSamples);
+    for (int sk = 0; sk < nK; ++sk)
+    {
+        const double w = twoD ? 0.5 : (sk + 0.5) / nSub;
+        for (int sj = 0; sj < nSub; ++sj)
+        {
+            const double v = (sj + 0.5) / nSub;
+            for (int si = 0; si < nSub; ++si)
+            {
+                const double u = (si + 0.5) / nSub;
+                weights.push_back({(1-u)*(1-v)*(1-w), u*(1-v)*(1-w), (1-u)*v*(1-w), u*v*(1-w),
+                                   (1-u)*(1-v)*w,     u*(1-v)*w,     (1-u)*v*w,     u*v*w});
+            }
+        }
+    }
+
+    // 3) 按批生成采样点并求值：每批 kBatch 个 cell 的全部采样点先写入连续缓冲区
+    std::vector<double> alpha(nKept, 1.0);
+    const auto& pts = bgMesh.points;
+    constexpr std::size_t kBatch = 256;
+
+    parallelFor(interfaceCells.size(), [&](std::size_t b, std::size_t e, unsigned)
+    {
+        std::vector<Point> samples(kBatch * nSamples);
+
+        for (std::size_t bb = b; bb < e; bb += kBatch)
+        {
+            const std::size_t be = std::min(e, bb + kBatch);
+
+            for (std::size_t n = bb; n < be; ++n)
+            {
+                const label c = interfaceCells[n];
+                const int i = static_cast<int>(c % Nx);
+                const int j = static_cast<int>(c / Nx % Ny);
+                const int k = static_cast<int>(c / (label(Nx) * Ny));
+
+                const Point* v[8] =
+                {
+                    &pts[pointIndex(i, j,     k    )], &pts[pointIndex(i + 1, j,     k    )],
+                    &pts[pointIndex(i, j + 1, k    )], &pts[pointIndex(i + 1, j + 1, k    )],
+                    &pts[pointIndex(i, j,     k + 1)], &pts[pointIndex(i + 1, j,     k + 1)],
+                    &pts[pointIndex(i, j + 1, k + 1)], &pts[pointIndex(i + 1, j + 1, k + 1)]
+                };
+
+                Point* out = samples.data() + (n - bb) * nSamples;
+                for (int s = 0; s < nSamples; ++s)
+                {
+                    const std::array<double,8>& wt = weights[s];
+                    Point p{};
+                    for (int q = 0; q < 8; ++q)
+                    {
+                        p.x += wt[q] * v[q]->x;
+                        p.y += wt[q] * v[q]->y;
+                        p.z += wt[q] * v[q]->z;
+                    }
+                    out[s] = p;
+                }
+            }
+
+            for (std::size_t n = bb; n < be; ++n)
+            {
+                const Point* in = samples.data() + (n - bb) * nSamples;
+                int nInside = 0;
+                for (int s = 0; s < nSamples; ++s)
+                {
+                    nInside += inDomain(in[s]) ? 1 : 0;
+                }
+                alpha[cellMap[interfaceCells[n]]] = static_cast<double>(nInside) / nSamples;
+            }
+        }
+    }, 64);
+
+    stage.setCells(interfaceCells.size());
+
+    std::cout << "volumeFraction: " << interfaceCells.size() << " interface cells of " << nKept
+              << ", " << nSamples << " samples each\n";
+    return alpha;
+}
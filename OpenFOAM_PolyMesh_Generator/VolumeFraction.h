@@ -0,0 +1,12 @@
+#pragma once
+
+#include <vector>
+#include "DomainMask.h"
+
+// 超采样体积分数（immersed boundary / VOF 初始化用）。
+// 对 keepCell 中保留的每个 cell 给出落在 inDomain 内的体积比例，按压缩后的 cell 编号排列
+// （与 applyKeepMask 的输出一致）。只有界面附近的 cell（26 邻域内有被删 cell）
+// 才在 n^d 个子单元中心上求值掩模（d = Nz == 1 ? 2 : 3），其余取 1。
+// 子采样点由三线性插值权重表批量生成；inDomain 会被多线程调用。
+std::vector<double> computeVolumeFraction(const MeshData& bgMesh, const std::vector<char>& keepCell,
+                                          const MaskFunc& inDomain, int nSub);
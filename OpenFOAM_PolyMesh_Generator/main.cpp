@@ -1,12 +1,47 @@
 #include <string>
+#include <algorithm>
 #include <cmath>
 #include <iostream>
-#include "StructuredMeshGenerator.h"
 #include "PolyMeshWriter.h"
-#include "DomainMask.h"
+#include "PolyMeshGen.h"
+#include "MeshPipeline.h"
 #include "VTKWriter.h"
-#include "MeshCleaner.h"
+#include "MeshChecker.h"
+#include "Profiler.h"
+#include "BatchRunner.h"
+#include "PolyMeshReader.h"
+#include "FieldWriter.h"
+#include "InitialFields.h"
+#include "ScratchArena.h"
 #include <filesystem>
+#include <fstream>
+#include <cstdlib>
+
+namespace
+{
+
+void usage()
+{
+    std::cerr <<
+"usage: OpenFOAM_PolyMesh_Generator [options] [outDir]\n"
+"  outDir                   polyMesh output directory (default polyMesh)\n"
+"  --check                  check mesh quality before writing\n"
+"  --check-report <file>    check, and write the result as JSON\n"
+"  --profile <file>         per-stage time / memory report as JSON\n"
+"  --binary | --gzip        binary polyMesh / gzip-compressed output\n"
+"  --zones | --fields       driver / driven / reflector zones (and 0/p, 0/T, 0/U)\n"
+"  --alpha <n>              write 0/alpha with n samples per direction\n"
+"  --islands report|largest|fail   connectivity analysis after masking\n"
+"  --levels <n> [--coarsen any|all] write n-1 coarser levels with parentCells\n"
+"  --sparse | --pipeline    run-length keep map / streamed writing\n"
+"  --cut [--cut-merge <f>]  cut cells on the reflector wall\n"
+"  --blocks                 two-block tube + reflector mesh\n"
+"  --read <dir>             read an existing polyMesh instead of generating\n"
+"  --case <file> [-j <n>] [--cache <dir>]   batch mode from a case file\n"
+"  --scratch <MiB>          pre-fault per-thread scratch buffers\n";
+}
+
+} // namespace
 
 int main(int argc, char** argv)
 {
@@ -19,58 +54,388 @@ int main(int argc, char** argv)
     const double Lz = 0.01;
 
     std::string outDir = "polyMesh";
-    if (argc > 1)
+    bool runCheck = false;           // --check：写出前先做网格质量检查
+    std::string checkReport;         // --check-report <file>：检查结果 JSON
+    std::string profileReport;       // --profile <file>：各阶段计时 / 内存 JSON
+    PolyMeshFormat format = PolyMeshFormat::ascii;   // --binary：二进制 polyMesh
+    PolyMeshCompression compression = PolyMeshCompression::none;   // --gzip：polyMesh 与 VTK 并行 gzip
+    std::string caseFile;            // --case <file>：按 case 文件批量生成
+    std::string readDir;             // --read <dir>：读入已有 polyMesh 代替生成
+    int alphaSamples = 0;            // --alpha <n>：写 0/alpha 体积分数（每方向 n 个采样点）
+    bool writeZones = false;         // --zones：driver / driven / reflector 写成 cellZones + faceZones
+    bool writeFields = false;        // --fields：按区域写 0/p、0/T、0/U（隐含 --zones）
+    bool checkIslands = false;       // --islands report|largest|fail：裁剪后的连通性分析
+    int nLevels = 1;                 // --levels <n>：另写 n-1 级逐级减半的粗网格及 parentCells
+    CoarsenRule coarsen = CoarsenRule::any;   // --coarsen any|all：粗 cell 的保留规则
+    bool sparse = false;             // --sparse：游程编码 keep 图，不生成背景网格
+    bool pipeline = false;           // --pipeline：sparse 掩模后按块生成 / 格式化 / 写盘重叠进行（不写 mesh.vtk）
+    int scratchMiB = 0;              // --scratch <MiB>：每个线程的临时缓冲区预留并预先缺页（大页）
+    bool cutCells = false;           // --cut：反射器壁面按符号距离切成多面体 cut cell，代替台阶
+    CutCellOptions cut;              // --cut-merge <f>：体积小于 f 倍背景 cell 的碎片并入相邻 cell
+    bool multiBlock = false;         // --blocks：窄激波管与反射腔各一块结构网格，在接口上拼接
+    ConnectivityOptions islands;
+    BatchOptions batch;              // -j <n>：批量模式下并发的 case 数
+                                     // --cache <dir>：批量模式下的中间结果缓存目录
+    for (int a = 1; a < argc; ++a)
+    {
+        std::string arg = argv[a];
+        if (arg == "--check")
+        {
+            runCheck = true;
+        }
+        else if (arg == "--zones")
+        {
+            writeZones = true;
+        }
+        else if (arg == "--islands" && a + 1 < argc)
+        {
+            checkIslands = true;
+            islands.policy = islandPolicyFromString(argv[++a]);
+        }
+        else if (arg == "--levels" && a + 1 < argc)
+        {
+            nLevels = std::atoi(argv[++a]);
+        }
+        else if (arg == "--coarsen" && a + 1 < argc)
+        {
+            coarsen = coarsenRuleFromString(argv[++a]);
+        }
+        else if (arg == "--sparse")
+        {
+            sparse = true;
+        }
+        else if (arg == "--pipeline")
+        {
+            pipeline = true;
+        }
+        else if (arg == "--cut")
+        {
+            cutCells = true;
+        }
+        else if (arg == "--cut-merge" && a + 1 < argc)
+        {
+            cutCells = true;
+            cut.mergeFraction = std::atof(argv[++a]);
+        }
+        else if (arg == "--blocks")
+        {
+            multiBlock = true;
+        }
+        else if (arg == "--fields")
+        {
+            writeZones = true;
+            writeFields = true;
+        }
+        else if (arg == "--binary")
+        {
+            format = PolyMeshFormat::binary;
+        }
+        else if (arg == "--gzip")
+        {
+            compression = PolyMeshCompression::gzip;
+        }
+        else if (arg == "--check-report" && a + 1 < argc)
+        {
+            runCheck = true;
+            checkReport = argv[++a];
+        }
+        else if (arg == "--profile" && a + 1 < argc)
+        {
+            profileReport = argv[++a];
+            enableRssProfiling(true);
+        }
+        else if (arg == "--case" && a + 1 < argc)
+        {
+            caseFile = argv[++a];
+        }
+        else if (arg == "--read" && a + 1 < argc)
+        {
+            readDir = argv[++a];
+        }
+        else if (arg == "--alpha" && a + 1 < argc)
+        {
+            alphaSamples = std::atoi(argv[++a]);
+        }
+        else if (arg == "--cache" && a + 1 < argc)
+        {
+            batch.cacheDir = argv[++a];
+        }
+        else if (arg == "--scratch" && a + 1 < argc)
+        {
+            scratchMiB = std::atoi(argv[++a]);
+        }
+        else if (arg == "-j" && a + 1 < argc)
+        {
+            batch.nJobs = static_cast<unsigned>(std::atoi(argv[++a]));
+        }
+        else if (arg == "--help" || arg == "-h")
+        {
+            usage();
+            return 0;
+        }
+        else if (!arg.empty() && arg[0] == '-')
+        {
+            // 未知选项，或缺少参数值的选项：不能当作输出目录
+            std::cerr << "Unknown option or missing value: " << arg << "\n";
+            usage();
+            return 1;
+        }
+        else
+        {
+            outDir = arg;
+        }
+    }
+
+    if (scratchMiB > 0)
     {
-        outDir = argv[1];
+        configureScratch(static_cast<std::size_t>(scratchMiB) << 20, true);
     }
 
-    // 1) 生成背景结构网格
-    MeshData bg = generateStructuredMesh(Nx, Ny, Nz, Lx, Ly, Lz);
-
-    //------------------------------------------------------------------
-    
-    
-    
-    // 2) 定义“激波管 + 反射器”掩模
-    //    这里只给个示例：左边 0<=x<=0.6, |y|<=0.1 为激波管；
-    //    右边 0.6<x<=1.0 在某个半椭圆下方作为反射器区域，你可以按自己几何改。
-    MaskFunc mask = [Lx, Ly](const Point& c) -> bool
+    // 批量模式：参数与掩模全部来自 case 文件
+    if (!caseFile.empty())
     {
-        // 直段激波管：x <= 0.6*Lx，保留全高 0..Ly
-        const double tubeEnd = 0.5 * Lx;
-        if (c.x <= tubeEnd)
+        int nFailed = runBatch(readCaseFile(caseFile), batch);
+        if (!profileReport.empty() && !writeProfileReport(profileReport))
         {
-            return true;
+            std::cerr << "Cannot write profile report " << profileReport << "\n";
         }
+        return nFailed == 0 ? 0 : 1;
+    }
+
+    MeshLevels mesh;
+    if (!readDir.empty())
+    {
+        if (alphaSamples > 0 || nLevels > 1)
+        {
+            std::cerr << "--alpha / --levels need the structured background, not available with --read\n";
+            return 1;
+        }
+        // 读入已有 polyMesh（校验 / 重新导出 VTK 或二进制），跳过 1) - 4)
+        mesh.levels.push_back(PolyMesh(readPolyMesh(readDir)));
+    }
+    else
+    {
+        // 1) 背景结构网格
+        MeshRequest request;
+        request.grid = {Nx, Ny, Nz, Lx, Ly, Lz};
+
+        //------------------------------------------------------------------
+
+
+
+        // 2) 定义“激波管 + 反射器”掩模
+        //    这里只给个示例：左边 0<=x<=0.6, |y|<=0.1 为激波管；
+        //    右边 0.6<x<=1.0 在某个半椭圆下方作为反射器区域，你可以按自己几何改。
+        request.mask = [Lx, Ly](const Point& c) -> bool
+        {
+            // 直段激波管：x <= 0.6*Lx，保留全高 0..Ly
+            const double tubeEnd = 0.5 * Lx;
+            if (c.x <= tubeEnd)
+            {
+                return true;
+            }
+
+            // 反射器区域：使用一个以 (0.8*Lx, Ly/2) 为中心、
+            // 半轴 a = 0.2*Lx, b = 0.5*Ly 的椭圆，刚好顶到 y=0 和 y=Ly
+            double y0 = c.y - 0.5 * Ly;           // 平移到中轴
+            double xc = (c.x - 0.5 * Lx) / (0.5 * Lx);  // a = 0.5 Lx
+            double yc = y0 / (0.5 * Ly);                // b = 0.5 Ly
+
+            if (c.x > tubeEnd && xc*xc + yc*yc <= Lx)
+            {
+                return true;
+            }
+
+            return false;
+        };
 
-        // 反射器区域：使用一个以 (0.8*Lx, Ly/2) 为中心、
-        // 半轴 a = 0.2*Lx, b = 0.5*Ly 的椭圆，刚好顶到 y=0 和 y=Ly
-        double y0 = c.y - 0.5 * Ly;           // 平移到中轴
-        double xc = (c.x - 0.5 * Lx) / (0.5 * Lx);  // a = 0.5 Lx
-        double yc = y0 / (0.5 * Ly);                // b = 0.5 Ly
 
-        if (c.x > tubeEnd && xc*xc + yc*yc <= Lx)
+        // cut-cell 模式：同一几何的符号距离（直管为 x - tubeEnd，椭圆用归一化半径的水平集
+        // 乘较短半轴近似距离），取并集即取最小值
+        if (cutCells)
         {
-            return true;
+            if (writeZones || checkIslands || alphaSamples > 0 || nLevels > 1 || sparse || pipeline)
+            {
+                std::cerr << "--cut: --zones / --fields / --islands / --alpha / --levels / --sparse / "
+                             "--pipeline are not available\n";
+                return 1;
+            }
+            request.mask = nullptr;
+            request.cutSurface = [Lx, Ly](const Point& c) -> double
+            {
+                const double tubeEnd = 0.5 * Lx;
+                double xc = (c.x - 0.5 * Lx) / (0.5 * Lx);
+                double yc = (c.y - 0.5 * Ly) / (0.5 * Ly);
+                double ellipse = (std::sqrt(xc*xc + yc*yc) - std::sqrt(Lx)) * 0.5 * std::min(Lx, Ly);
+                return std::min(c.x - tubeEnd, ellipse);
+            };
+            request.cut = cut;
         }
 
-        return false;
-    };
+        // 多块模式：激波管只取中间 1/5 高度的窄管，用自己的 Ny，不再继承反射腔的全高；
+        // 两块在 x = tubeEnd 上共用同一组 y 网格线
+        if (multiBlock)
+        {
+            if (cutCells || writeZones || checkIslands || alphaSamples > 0 || nLevels > 1 || sparse || pipeline)
+            {
+                std::cerr << "--blocks: --cut / --zones / --fields / --islands / --alpha / --levels / "
+                             "--sparse / --pipeline are not available\n";
+                return 1;
+            }
+            BlockDescriptor tube;
+            tube.name   = "tube";
+            tube.origin = {0.0, 0.4 * Ly, 0.0};
+            tube.grid   = {Nx / 2, Ny / 5, Nz, 0.5 * Lx, 0.2 * Ly, Lz};
+
+            BlockDescriptor cavity;
+            cavity.name   = "reflector";
+            cavity.origin = {0.5 * Lx, 0.0, 0.0};
+            cavity.grid   = {Nx / 2, Ny, Nz, 0.5 * Lx, Ly, Lz};
+
+            request.blocks = {tube, cavity};
+        }
+
+        //------------------------------------------------------------------
+
+
 
-    
-    //------------------------------------------------------------------
-    
-    
-    
-    // 3) 应用掩模
-    MeshData masked = applyMask(bg, mask);
-    
-    // 4) 清理未用节点
-    removeUnusedPoints(masked);
+        // 3) 掩模 ->（可选）孤岛 / 只在棱角相接的 cell 分析 -> 重建拓扑 -> 清理未用节点
+        if (writeZones)
+        {
+            // 区域：1 driver（膜片左侧）、2 driven（其余直管段）、3 reflector
+            const double diaphragm = 0.25 * Lx;
+            request.regions = [mask = request.mask, Lx, diaphragm](const Point& c) -> int
+            {
+                if (!mask(c)) return 0;
+                if (c.x <= diaphragm) return 1;
+                return c.x <= 0.5 * Lx ? 2 : 3;
+            };
+            request.regionNames = {"driver", "driven", "reflector"};
+        }
+        request.checkIslands = checkIslands;
+        request.islands      = islands;
+        request.alphaSamples = alphaSamples;
+        request.sparse       = sparse;
 
-    // 5) 输出网格
-    writePolyMesh(masked, outDir);
-    writeVTKSurface(masked, "mesh.vtk");
+        // 流水线模式：网格不在内存中拼出，直接写到 outDir
+        if (pipeline)
+        {
+            if (runCheck || writeFields || checkIslands || alphaSamples > 0 || nLevels > 1)
+            {
+                std::cerr << "--pipeline writes the mesh without holding it; "
+                             "--check / --fields / --islands / --alpha / --levels are not available\n";
+                return 1;
+            }
+            try
+            {
+                writeMeshPipelined(request, outDir, format, compression);
+            }
+            catch (const MeshRequestError& e)
+            {
+                std::cerr << e.what() << "\n";
+                return 1;
+            }
+            if (!profileReport.empty() && !writeProfileReport(profileReport))
+            {
+                std::cerr << "Cannot write profile report " << profileReport << "\n";
+            }
+            return 0;
+        }
+
+        ConnectivityReport report;
+        try
+        {
+            mesh = generateMeshLevels(request, nLevels, coarsen, &report);
+        }
+        catch (const MeshRequestError& e)
+        {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        if (checkIslands)
+        {
+            writeConnectivityReport(report, std::cout);
+            if (!report.passed)
+            {
+                std::cerr << "connectivity check failed, nothing written.\n";
+                return 1;
+            }
+        }
+    }
+
+    // 5) 可选：网格质量检查（每一级），失败则不写出
+    if (runCheck)
+    {
+        for (std::size_t level = 0; level < mesh.levels.size(); ++level)
+        {
+            MeshCheckReport report = checkMesh(mesh.levels[level].data());
+            if (level == 0 && !checkReport.empty())
+            {
+                std::ofstream rep(checkReport);
+                writeMeshCheckReport(report, rep);
+            }
+            else if (level == 0 || !report.passed)
+            {
+                writeMeshCheckReport(report, std::cout);
+            }
+            if (!report.passed)
+            {
+                std::cerr << "checkMesh: mesh check failed at level " << level << ", nothing written.\n";
+                return 1;
+            }
+        }
+    }
+
+    // 6) 输出网格：第 l 级写到 levelDirectory(outDir, l)，细一级目录中附 parentCells
+    for (std::size_t level = 0; level < mesh.levels.size(); ++level)
+    {
+        const MeshData& masked = mesh.levels[level].data();
+        const std::string dir  = levelDirectory(outDir, static_cast<int>(level));
+
+        writePolyMesh(masked, dir, format, compression);
+        if (level < mesh.parentCells.size())
+        {
+            writeParentCells(mesh.parentCells[level], dir, format, compression);
+        }
+        if (level == 0)
+        {
+            writeVTKSurface(masked, compression == PolyMeshCompression::gzip ? "mesh.vtk.gz" : "mesh.vtk");
+        }
+        if (!mesh.levels[level].alpha().empty())
+        {
+            writeVolScalarField(masked, timeDirectory(dir), "alpha", mesh.levels[level].alpha());
+        }
+        if (writeFields)
+        {
+            // 激波管初值：driver 高压，其余低压；静止、等温
+            InitialField p;
+            p.name         = "p";
+            p.dimensions   = "[1 -1 -2 0 0 0 0]";
+            p.value        = {1e5, 0.0, 0.0};
+            p.regionValues = {{1, {1e6, 0.0, 0.0}}};
+
+            InitialField T;
+            T.name       = "T";
+            T.dimensions = "[0 0 0 1 0 0 0]";
+            T.value      = {300.0, 0.0, 0.0};
+
+            InitialField U;
+            U.name            = "U";
+            U.dimensions      = "[0 1 -1 0 0 0 0]";
+            U.nComponents     = 3;
+            U.defaultBoundary = "slip";
+
+            for (const InitialField& f : {p, T, U})
+            {
+                writeVolField(masked, timeDirectory(dir), evaluateInitialField(masked, f));
+            }
+        }
+    }
+
+    if (!profileReport.empty() && !writeProfileReport(profileReport))
+    {
+        std::cerr << "Cannot write profile report " << profileReport << "\n";
+    }
 
     return 0;
 }